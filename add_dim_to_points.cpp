@@ -13,6 +13,7 @@ AUTHOR :    A K M Sharif Kaiser(SK)        START DATE : 09 Mar 2021
 CHANGES :
 REF NO  VERSION DATE    WHO     DETAIL
 * 02    25MAR2021       SK      Dimension change from absolute height|width to window relative height|width
+* 03    18OCT2026       AG      Linear time file_content reading, main excluded with ADD_DIM_NO_MAIN (laser_bench.cpp)
 
 *H*/
 
@@ -49,7 +50,8 @@ void process_file(std::string & file_name){
 
         while (std::getline(current_file, line))
         {
-            file_content = file_content + line + "\n";
+            file_content += line;    // append in place, file_content + line copies the whole content for every line
+            file_content += "\n";
 
             if (line.find(",") != std::string::npos)    // npos means not found
             {
@@ -123,6 +125,7 @@ void process_file(std::string & file_name){
     }
 }
 
+#ifndef ADD_DIM_NO_MAIN    // defined by programs that include this file for process_file (laser_bench.cpp)
 int main(int argc, char* argv[])
 {
 
@@ -166,3 +169,4 @@ int main(int argc, char* argv[])
         }
     }
 }
+#endif
@@ -2,14 +2,59 @@
  * Simple sound playback using ALSA API and libasound.
  *
  * Compile:
- * $ cc -o play sound_playback.c -lasound
- * 
+ * $ g++ -O2 -pthread -o alsa-wav alsa-wav.cpp pcm_output.c rt_profile.c wav_reader.c shm_ring.c -lasound
+ *
  * Usage:
- * $ ./play <sample_rate> <channels> <seconds> < <file>
- * 
+ * $ ./alsa-wav <file.wav | playlist.m3u> [device] [auto|mmap|rw] [rt|rt:<cpu>] [options]
+ * $ ./alsa-wav <sample_rate> <channels> <seconds> [device] [auto|mmap|rw] [rt|rt:<cpu>] < <raw file>
+ * $ ./alsa-wav shm:<name> [device] [auto|mmap|rw] [rt|rt:<cpu>]
+ *   options (WAV files, all positions in frames):
+ *     --start=<frame>          first frame played (default 0)
+ *     --end=<frame>            frame after the last one played (default: end of the data chunk)
+ *     --loop=<first>-<last>[x<count>]   loop frames first..last (inclusive, as in smpl) count times
+ *                              (default 0 = forever)
+ *     --smpl-loops             loop the first smpl loop of every file that has one
+ *     --repeat                 start the playlist (or the file) again after the last entry, forever
+ *
  * Examples:
- * $ ./play 44100 2 5 < /dev/urandom
- * $ ./play 22050 1 8 < /path/to/file.wav
+ * $ ./alsa-wav /path/to/file.wav
+ * $ ./alsa-wav batman,10sec,0.10Hz,SR48000.wav hw:0,0 mmap
+ * $ sudo ./alsa-wav batman,10sec,0.10Hz,SR48000.wav hw:0,0 auto rt:3
+ * $ ./alsa-wav batman,10sec,0.10Hz,SR48000.wav hw:0,0 --start=48000 --loop=48000-95999x4
+ * $ ./alsa-wav shapes.m3u hw:0,0 --repeat
+ * $ ./alsa-wav 44100 2 5 < /dev/urandom
+ * $ ./laser_player svg/batman.txt 10 48000 --shm-out=laser & ./alsa-wav shm:laser hw:0,0
+ *
+ * Playlist (.m3u or .txt): one WAV file per line, relative to the playlist, # starts a comment line.
+ * A line can limit the file to a range of frames: <file.wav>|<start>|<end>  (end 0 = end of the data)
+ *
+ * A WAV file is memory mapped and its header read (wav_reader.h): rate and channels come from the fmt
+ * chunk, playback starts at the first sample of the data chunk and plays exactly its frames. Only 16 bit
+ * PCM is played. A device that does not take the rate of the file is an error, not a pitch change
+ * (use a plughw: device to resample). Raw stdin needs rate, channels and seconds on the command line.
+ * The files of a playlist must have the rate and channels of the first one, others are skipped.
+ *
+ * A reader thread keeps READ_AHEAD_MS of the input in a lock-free ring (spsc_ring.hpp) ahead of the
+ * device, the playback loop only copies from the ring into the hardware buffer (mmap access, see
+ * pcm_output.h; rw access with snd_pcm_writei where the device has no mmap). A slow read (SD card,
+ * network) is absorbed by the ring instead of stalling the writer. Playback starts once the ring
+ * holds a full ALSA buffer. The ring fill level, ring underruns and the slowest read are printed at the end.
+ * Start/end points, loops and playlist transitions are done by the reader thread while it fills the
+ * ring: the frame after a loop end or after the last frame of a file is the loop start or the first
+ * frame of the next file, in the same period, so there is no gap. The next file of the playlist is opened
+ * and its first frames prefetched (MADV_WILLNEED) as soon as the current one starts. A jump is only as
+ * smooth as the samples at both sides of it: put loop points and file ends on shape cycle boundaries.
+ * shm:<name> plays from the shared memory ring of a generator in another process (shm_ring.h, e.g.
+ * laser_player --shm-out=<name>): rate and channels come from its header, the frames are copied from the
+ * shared pages straight into the hardware buffer (snd_pcm_writei straight from them in rw access), no
+ * reader thread and no pipe. Playback ends when the generator marks the ring done (or exits) and it is
+ * drained. Empty stretches while the generator runs are ring underruns, also counted in the ring header.
+ * Ctrl-C stops the playback.
+ * Period and buffer size come from alsa.profile (./alsa_tune <device> <rate> <channels>)
+ * if it has the device, else 1024 x 4 frames. Xruns and their recovery time are printed at the end.
+ * rt: real time mode (rt_profile.h), mlockall, SCHED_FIFO, pinned to <cpu> (default the first isolated
+ * cpu), wake-up latency and write duration histograms at the end. Steps without the rights are skipped.
+ * Only the playback thread runs SCHED_FIFO on that cpu, the reader thread keeps the default scheduling.
  *
  * Copyright (C) 2009 Alessandro Ghedini <al3xbio@gmail.com>
  * --------------------------------------------------------------
@@ -21,109 +66,635 @@
  * --------------------------------------------------------------
  */
 
-#include <alsa/asoundlib.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pcm_output.h"
+#include "rt_profile.h"
+#include "shm_ring.h"
+#include "spsc_ring.hpp"
+#include "wav_reader.h"
 
 #define PCM_DEVICE "default"
+#define READ_AHEAD_MS 2000	/* ring between the reader thread and the device, at least 2 ALSA buffers */
+#define READ_CHUNK (64 * 1024)	/* largest single read, smaller reads publish data sooner */
+#define READER_POLL_MS 50	/* reader checks the stop flag this often while stdin has nothing */
+#define PREFETCH_MS 1000	/* of the next playlist file, read in the background while the current one plays */
 
-int main(int argc, char **argv) {
-	unsigned int pcm, tmp, dir;
-	int rate, channels, seconds;
-	snd_pcm_t *pcm_handle;
-	snd_pcm_hw_params_t *params;
-	snd_pcm_uframes_t frames;
-	char *buff;
-	int buff_size, loops;
-
-	if (argc < 4) {
-		printf("Usage: %s <sample_rate> <channels> <seconds>\n",
-								argv[0]);
+/* one playlist entry, frames start..end-1 of the file */
+struct play_item {
+	std::string path;
+	uint64_t start = 0;
+	uint64_t end = 0;		/* 0 = end of the data chunk */
+	mutable bool noted = false;	/* skipped once and said so, quiet on the next --repeat rounds */
+};
+
+/* what the reader thread plays from WAV files */
+struct play_plan {
+	std::vector<play_item> items;
+	unsigned int rate = 0, channels = 0;	/* of the device, other files are skipped */
+	bool repeat = false;
+	bool smpl_loops = false;
+	bool loop_given = false;	/* --loop */
+	uint64_t loop_first = 0, loop_last = 0;
+	uint32_t loop_count = 0;	/* 0 = forever */
+};
+
+/* position of the reader in one open file, byte offsets into its data chunk */
+struct play_cursor {
+	wav_file wav;
+	bool open = false;
+	size_t index = 0;		/* into play_plan.items */
+	uint64_t pos = 0, end = 0;
+	bool looping = false;
+	uint64_t loop_start = 0, loop_end = 0;	/* loop_end exclusive */
+	uint32_t loops_left = 0;	/* further passes unless loop_forever */
+	bool loop_forever = false;
+};
+
+/* input -> ring, filled by the reader thread, drained by the playback loop */
+struct read_ahead {
+	spsc_ring<char> ring;
+	const play_plan *plan = NULL;	/* WAV files, NULL: read stdin */
+	std::atomic<bool> eof{false};	/* end of file or read error, nothing more comes */
+	std::atomic<bool> stop{false};	/* playback ended, reader returns */
+	/* written by the reader, read after join */
+	double slowest_read_ms = 0.0;
+	unsigned long long bytes_read = 0;
+	unsigned long files_started = 0, loop_jumps = 0;
+
+	read_ahead(size_t bytes) : ring(bytes) {}
+};
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_signal(int) {
+	interrupted = 1;
+}
+
+static double now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static bool playable(const wav_file *wav) {
+	return wav->format == WAV_FORMAT_PCM && wav->bits_per_sample == 16 && wav->block_align == wav->channels * 2;
+}
+
+static bool ends_with(const char *text, const char *suffix) {
+	size_t n = strlen(text), m = strlen(suffix);
+	return n >= m && strcmp(text + n - m, suffix) == 0;
+}
+
+/* "<file>|<start>|<end>" lines, # comments, paths relative to the playlist */
+static int load_playlist(const char *file, std::vector<play_item> &items) {
+	std::ifstream in(file);
+	std::string line, dir = file;
+	if (!in)
 		return -1;
+	dir = dir.find('/') == std::string::npos ? "" : dir.substr(0, dir.rfind('/') + 1);
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty() || line[0] == '#')
+			continue;
+		play_item item;
+		size_t bar = line.find('|');
+		item.path = line.substr(0, bar);
+		if (bar != std::string::npos) {
+			char *rest;
+			item.start = strtoull(line.c_str() + bar + 1, &rest, 10);
+			if (*rest == '|')
+				item.end = strtoull(rest + 1, NULL, 10);
+		}
+		if (item.path[0] != '/')
+			item.path = dir + item.path;
+		items.push_back(item);
+	}
+	return 0;
+}
+
+/* opens entry index into cursor: range, loop, prefetch of its first frames. A Note and false if it can't play */
+static bool open_item(const play_plan *plan, size_t index, play_cursor *cursor) {
+	const play_item &item = plan->items[index];
+	int err;
+	uint64_t start, end, first = 0, last = 0;
+	uint32_t count = 0;
+
+	if ((err = wav_open(&cursor->wav, item.path.c_str())) != WAV_OK) {
+		if (!item.noted)
+			printf("Note: %s skipped, %s\n", item.path.c_str(), wav_strerror(err));
+		item.noted = true;
+		return false;
+	}
+	if (!playable(&cursor->wav) || cursor->wav.rate != plan->rate || cursor->wav.channels != plan->channels) {
+		if (!item.noted)
+			printf("Note: %s skipped, not 16 bit PCM with %u Hz and %u channels\n", item.path.c_str(), plan->rate, plan->channels);
+		item.noted = true;
+		wav_close(&cursor->wav);
+		return false;
+	}
+	end = item.end && item.end < cursor->wav.num_frames ? item.end : cursor->wav.num_frames;
+	start = item.start < end ? item.start : end;
+	cursor->open = true;
+	cursor->index = index;
+	cursor->pos = start * cursor->wav.block_align;
+	cursor->end = end * cursor->wav.block_align;
+
+	/* --loop for every file, else the first smpl loop if asked for */
+	cursor->looping = false;
+	if (plan->loop_given) {
+		first = plan->loop_first;
+		last = plan->loop_last;
+		count = plan->loop_count;
+		cursor->looping = true;
+	} else if (plan->smpl_loops && cursor->wav.num_loops > 0) {
+		first = cursor->wav.loops[0].start;
+		last = cursor->wav.loops[0].end;
+		count = cursor->wav.loops[0].play_count;
+		cursor->looping = true;
+	}
+	if (cursor->looping && (first < start || last >= end || first > last)) {
+		if (!item.noted)
+			printf("Note: %s: loop %llu..%llu is outside the played frames, not looped\n", item.path.c_str(),
+		       (unsigned long long)first, (unsigned long long)last);
+		item.noted = true;
+		cursor->looping = false;
 	}
+	if (cursor->looping) {
+		cursor->loop_start = first * cursor->wav.block_align;
+		cursor->loop_end = (last + 1) * cursor->wav.block_align;
+		cursor->loop_forever = count == 0;
+		cursor->loops_left = count ? count - 1 : 0;
+	}
+	wav_prefetch(&cursor->wav, start, (uint64_t)plan->rate * PREFETCH_MS / 1000);
+	return true;
+}
 
-	rate 	 = atoi(argv[1]);
-	channels = atoi(argv[2]);
-	seconds  = atoi(argv[3]);
+/* the first playable entry from index on (after index unless first), wrapping with --repeat.
+   false at the end of the playlist or if nothing in it plays */
+static bool open_next(const play_plan *plan, size_t index, bool first, play_cursor *cursor) {
+	size_t tried;
+	for (tried = 0; tried < plan->items.size(); tried++) {
+		if (!first || tried > 0)
+			index++;
+		if (index == plan->items.size()) {
+			if (!plan->repeat)
+				return false;
+			index = 0;
+		}
+		if (open_item(plan, index, cursor))
+			return true;
+	}
+	return false;
+}
 
-	/* Open the PCM device in playback mode */
-	if (pcm = snd_pcm_open(&pcm_handle, PCM_DEVICE,
-					SND_PCM_STREAM_PLAYBACK, 0) < 0) 
-		printf("ERROR: Can't open \"%s\" PCM device. %s\n",
-					PCM_DEVICE, snd_strerror(pcm));
+/* WAV files into the ring: start/end points, loops and playlist transitions back to back */
+static void fill_from_plan(read_ahead *ahead) {
+	ring_regions<char> regions;
+	play_cursor current, next;
 
-	/* Allocate parameters object and fill it with default values*/
-	snd_pcm_hw_params_alloca(&params);
+	if (!open_next(ahead->plan, 0, true, &current))
+		return;
+	ahead->files_started++;
+	/* the following file is opened and its start prefetched while this one plays */
+	open_next(ahead->plan, current.index, false, &next);
+
+	while (!ahead->stop.load(std::memory_order_relaxed)) {
+		if (ahead->ring.write_regions(regions) == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));	/* full, the ring is seconds long */
+			continue;
+		}
+		uint64_t limit = current.looping ? current.loop_end : current.end;
+		size_t count = regions.first_count < READ_CHUNK ? regions.first_count : READ_CHUNK;
+		if (count > limit - current.pos)
+			count = (size_t)(limit - current.pos);
 
-	snd_pcm_hw_params_any(pcm_handle, params);
+		double start = now_ms();
+		memcpy(regions.first, current.wav.data + current.pos, count);	/* page faults of the mapping happen here */
+		double took = now_ms() - start;
+		if (took > ahead->slowest_read_ms)
+			ahead->slowest_read_ms = took;
+		current.pos += count;
+		ahead->ring.commit_write(count);
+		ahead->bytes_read += count;
 
-	/* Set parameters */
-	if (pcm = snd_pcm_hw_params_set_access(pcm_handle, params,
-					SND_PCM_ACCESS_RW_INTERLEAVED) < 0) 
-		printf("ERROR: Can't set interleaved mode. %s\n", snd_strerror(pcm));
+		if (current.looping && current.pos == current.loop_end) {
+			if (current.loop_forever || current.loops_left > 0) {
+				current.pos = current.loop_start;
+				ahead->loop_jumps++;
+				if (!current.loop_forever)
+					current.loops_left--;
+			} else
+				current.looping = false;	/* last pass done, play on to the end */
+		}
+		if (current.pos == current.end) {
+			wav_close(&current.wav);
+			current.open = false;
+			if (!next.open)
+				break;		/* end of the playlist */
+			current = next;
+			next.open = false;
+			ahead->files_started++;
+			open_next(ahead->plan, current.index, false, &next);
+		}
+	}
+	if (current.open)
+		wav_close(&current.wav);
+	if (next.open)
+		wav_close(&next.wav);
+}
 
-	if (pcm = snd_pcm_hw_params_set_format(pcm_handle, params,
-						SND_PCM_FORMAT_S16_LE) < 0) 
-		printf("ERROR: Can't set format. %s\n", snd_strerror(pcm));
+/* reads stdin (or the WAV files) into the free part of the ring until the end, sleeps while the ring is full */
+static void reader_thread(read_ahead *ahead) {
+	ring_regions<char> regions;
+	struct pollfd pfd = {0, POLLIN, 0};
 
-	if (pcm = snd_pcm_hw_params_set_channels(pcm_handle, params, channels) < 0) 
-		printf("ERROR: Can't set channels number. %s\n", snd_strerror(pcm));
+	if (ahead->plan) {
+		fill_from_plan(ahead);
+		ahead->eof.store(true, std::memory_order_release);
+		return;
+	}
+	while (!ahead->stop.load(std::memory_order_relaxed)) {
+		if (ahead->ring.write_regions(regions) == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));	/* full, the ring is seconds long */
+			continue;
+		}
+		/* a pipe can stay empty: wait with a timeout so the stop flag is seen */
+		if (poll(&pfd, 1, READER_POLL_MS) == 0)
+			continue;
+		size_t wanted = regions.first_count < READ_CHUNK ? regions.first_count : READ_CHUNK;
+		double start = now_ms();
+		ssize_t got = read(0, regions.first, wanted);
+		double took = now_ms() - start;
+		if (took > ahead->slowest_read_ms)
+			ahead->slowest_read_ms = took;
+		if (got <= 0)
+			break;
+		ahead->ring.commit_write((size_t)got);
+		ahead->bytes_read += got;
+	}
+	ahead->eof.store(true, std::memory_order_release);
+}
 
-	if (pcm = snd_pcm_hw_params_set_rate_near(pcm_handle, params, &rate, 0) < 0) 
-		printf("ERROR: Can't set rate. %s\n", snd_strerror(pcm));
+/* shm: the generator's ring is the read-ahead, from its pages straight into the device */
+static int play_shared(pcm_output *out, shm_ring *ring, unsigned long long *played, unsigned long *underruns) {
+	int err = 0;
+	bool alive = true, starving = false;
+	shm_regions regions;
+	snd_pcm_uframes_t count;
+	snd_pcm_sframes_t written;
+	int16_t *frames;
 
-	/* Write parameters */
-	if (pcm = snd_pcm_hw_params(pcm_handle, params) < 0)
-		printf("ERROR: Can't set harware parameters. %s\n", snd_strerror(pcm));
+	/* start with a full ALSA buffer ready, as from the read-ahead */
+	while (!interrupted && shm_ring_read_available(ring) < out->buffer_size && shm_ring_producer_alive(ring))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
-	/* Resume information */
-	printf("PCM name: '%s'\n", snd_pcm_name(pcm_handle));
+	while (!interrupted) {
+		uint64_t buffered = shm_ring_read_regions(ring, &regions);
+		if (buffered < out->period_size) {
+			/* done or gone before the fill level: frames committed before the end are seen */
+			alive = shm_ring_producer_alive(ring);
+			buffered = shm_ring_read_regions(ring, &regions);
+			if (buffered == 0 && !alive)
+				break;
+			if (buffered < out->period_size && alive) {
+				/* generator fell behind, the ALSA buffer is still playing */
+				if (!starving) {
+					(*underruns)++;
+					shm_ring_count_underrun(ring);
+				}
+				starving = true;
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+				continue;
+			}
+		}
+		starving = false;
+		/* the contiguous part, the wrap comes in the next round */
+		count = regions.first_frames < out->period_size ? regions.first_frames : out->period_size;
+		if (out->mmap) {
+			if ((err = pcm_output_begin(out, &frames, &count)) < 0)
+				break;
+			if (count == 0)
+				continue;	// device busy, wait again
+			memcpy(frames, regions.first, count * out->channels * sizeof(int16_t));
+			if ((err = pcm_output_commit(out, count)) < 0)
+				break;
+		} else if ((written = pcm_output_write(out, regions.first, count)) < 0) {
+			err = (int)written;
+			break;
+		}
+		shm_ring_commit_read(ring, count);
+		*played += count;
+	}
+	return err;
+}
 
-	printf("PCM state: %s\n", snd_pcm_state_name(snd_pcm_state(pcm_handle)));
+int main(int argc, char **argv) {
+	int err = 0, access = PCM_ACCESS_AUTO, rt = 0, rt_cpu = -1, i;
+	unsigned int rate, channels, seconds = 0;
+	bool wav_input, shm_input, access_given = false;
+	std::vector<const char *> positional;
+	play_plan plan;
+	play_item single;
+	wav_file wav;
+	const char *device = PCM_DEVICE;
+	pcm_output out;
+	pcm_profile profile;
+	snd_pcm_uframes_t period_size = 1024;
+	unsigned int periods = 4;
+	int16_t *frames;
+	snd_pcm_uframes_t count, frame_bytes, buffered, prefill;
+	unsigned long long total, played = 0, fill_sum = 0, fill_samples = 0;
+	size_t min_fill = (size_t)-1, ring_bytes, arg;
+	unsigned long ring_underruns = 0;
+	bool eof, starving = false;
+	rt_histogram wakeup_hist = RT_HISTOGRAM_INIT, write_hist = RT_HISTOGRAM_INIT;
+	shm_ring shared;
+
+	for (i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "--", 2) != 0)
+			positional.push_back(argv[i]);
+		else if (strncmp(argv[i], "--start=", 8) == 0)
+			single.start = strtoull(argv[i] + 8, NULL, 10);
+		else if (strncmp(argv[i], "--end=", 6) == 0)
+			single.end = strtoull(argv[i] + 6, NULL, 10);
+		else if (strncmp(argv[i], "--loop=", 7) == 0) {
+			char *rest;
+			plan.loop_first = strtoull(argv[i] + 7, &rest, 10);
+			if (*rest != '-') {
+				printf("Invalid argument: --loop=<first>-<last>[x<count>]\n");
+				return -1;
+			}
+			plan.loop_last = strtoull(rest + 1, &rest, 10);
+			if (*rest == 'x')
+				plan.loop_count = (uint32_t)strtoul(rest + 1, NULL, 10);
+			plan.loop_given = true;
+		}
+		else if (strcmp(argv[i], "--smpl-loops") == 0)
+			plan.smpl_loops = true;
+		else if (strcmp(argv[i], "--repeat") == 0)
+			plan.repeat = true;
+		else {
+			printf("Invalid argument: unknown option %s\n", argv[i]);
+			return -1;
+		}
+	}
+
+	/* a number first: raw stdin, shm:<name> a shared ring, else a WAV file or a playlist */
+	shm_input = positional.size() > 0 && strncmp(positional[0], "shm:", 4) == 0;
+	wav_input = positional.size() > 0 && !shm_input && strspn(positional[0], "0123456789") != strlen(positional[0]);
+	if (positional.empty() || (!wav_input && !shm_input && positional.size() < 3)) {
+		printf("Usage: %s <file.wav | playlist.m3u> [device] [auto|mmap|rw] [rt|rt:<cpu>] [--start=<frame>] [--end=<frame>]\n"
+		       "          [--loop=<first>-<last>[x<count>]] [--smpl-loops] [--repeat]\n"
+		       "       %s <sample_rate> <channels> <seconds> [device] [auto|mmap|rw] [rt|rt:<cpu>] < <raw file>\n"
+		       "       %s shm:<name> [device] [auto|mmap|rw] [rt|rt:<cpu>]\n", argv[0], argv[0], argv[0]);
+		return -1;
+	}
+
+	if (wav_input) {
+		if (ends_with(positional[0], ".m3u") || ends_with(positional[0], ".txt")) {
+			if (load_playlist(positional[0], plan.items) != 0 || plan.items.empty()) {
+				printf("Input Error: %s: no playlist entries\n", positional[0]);
+				return -1;
+			}
+		} else {
+			single.path = positional[0];
+			plan.items.push_back(single);
+		}
+		/* the first file configures the device */
+		if ((err = wav_open(&wav, plan.items[0].path.c_str())) != WAV_OK) {
+			printf("Input Error: %s: %s\n", plan.items[0].path.c_str(), wav_strerror(err));
+			return -1;
+		}
+		if (!playable(&wav)) {
+			printf("Input Error: %s: only 16 bit PCM is played (format 0x%04x, %u bit)\n", plan.items[0].path.c_str(),
+			       wav.format, wav.bits_per_sample);
+			wav_close(&wav);
+			return -1;
+		}
+		rate = wav.rate;
+		channels = wav.channels;
+		arg = 1;
+	} else if (shm_input) {
+		if ((err = shm_ring_attach(&shared, positional[0] + 4)) < 0) {
+			printf("Input Error: %s: %s%s\n", positional[0], strerror(-err), err == -ENOENT ? ", start the generator first" : "");
+			return -1;
+		}
+		rate = shared.header->rate;
+		channels = shared.channels;
+		arg = 1;
+	} else {
+		rate 	 = atoi(positional[0]);
+		channels = atoi(positional[1]);
+		seconds  = atoi(positional[2]);
+		arg = 3;
+	}
+	if (positional.size() > arg)
+		device = positional[arg];
+	if (positional.size() > arg + 1) {
+		access_given = true;
+		if ((access = pcm_output_parse_access(positional[arg + 1])) < 0) {
+			printf("ERROR: access must be auto, mmap or rw\n");
+			return -1;
+		}
+	}
+	if (positional.size() > arg + 2) {
+		const char *mode = positional[arg + 2];
+		if (strncmp(mode, "rt", 2) != 0 || (mode[2] != '\0' && mode[2] != ':')) {
+			printf("ERROR: the last argument must be rt or rt:<cpu>\n");
+			return -1;
+		}
+		rt = 1;
+		rt_cpu = mode[2] == ':' ? atoi(mode + 3) : rt_default_cpu();
+	}
+
+	if (rt) {
+		if (rt_lock_memory(stdout) == 0)
+			printf("memory locked\n");
+		if (rt_cpu < 0)
+			printf("Note: no isolated cpu (isolcpus=), not pinned\n");
+	}
 
-	snd_pcm_hw_params_get_channels(params, &tmp);
-	printf("channels: %i ", tmp);
+	/* tuned period and buffer size of this device */
+	if (pcm_profile_load(PCM_PROFILE_FILE, device, rate, channels, &profile) == 0) {
+		period_size = profile.period_size;
+		periods = profile.periods;
+		if (!access_given)
+			access = profile.access;
+	}
+
+	/* Open the PCM device in playback mode, mmap access if the device has it */
+	if ((err = pcm_output_open(&out, device, rate, channels, period_size, periods, access)) < 0) {
+		printf("ERROR: Can't open \"%s\" PCM device. %s\n", device, snd_strerror(err));
+		return -1;
+	}
+	if ((wav_input || shm_input) && out.rate != rate) {
+		printf("ERROR: \"%s\" plays %u Hz, the %s has %u Hz (a plughw: device resamples)\n", device, out.rate,
+		       wav_input ? "file" : "generator", rate);
+		pcm_output_close(&out, 0);
+		return -1;
+	}
+
+	/* Resume information */
+	printf("PCM name: '%s'\n", snd_pcm_name(out.pcm));
+	printf("PCM access: %s\n", pcm_output_access_name(&out));
+	printf("channels: %i ", out.channels);
 
-	if (tmp == 1)
+	if (out.channels == 1)
 		printf("(mono)\n");
-	else if (tmp == 2)
+	else if (out.channels == 2)
 		printf("(stereo)\n");
 
-	snd_pcm_hw_params_get_rate(params, &tmp, 0);
-	printf("rate: %d bps\n", tmp);
+	printf("rate: %d bps\n", out.rate);
+	printf("period: %lu frames, buffer: %lu frames\n", (unsigned long)out.period_size, (unsigned long)out.buffer_size);
+	if (wav_input) {
+		if (plan.items.size() > 1 || plan.repeat)
+			printf("playlist: %zu files%s\n", plan.items.size(), plan.repeat ? ", repeated" : "");
+		printf("file: %s%s, %llu frames = %.3f seconds\n", wav.rf64 ? "RF64" : "RIFF", wav.extensible ? " extensible" : "",
+		       (unsigned long long)wav.num_frames, (double)wav.num_frames / wav.rate);
+		for (unsigned int i = 0; i < wav.num_loops; i++)
+			printf("loop %u: frames %u..%u, %u times\n", i, wav.loops[i].start, wav.loops[i].end, wav.loops[i].play_count);
+		wav_close(&wav);	/* the reader thread opens the files it plays */
+		plan.rate = out.rate;
+		plan.channels = out.channels;
+	} else if (!shm_input)
+		printf("seconds: %d\n", seconds);
+	if (rt) {
+		out.wakeup_hist = &wakeup_hist;
+		out.write_hist = &write_hist;
+	}
 
-	printf("seconds: %d\n", seconds);	
+	if (shm_input) {
+		printf("shared ring: %s, %.0f ms, generator pid %d\n", shared.name, shared.header->capacity * 1000.0 / out.rate,
+		       shared.header->producer_pid);
+		if (rt)
+			rt_prefault(shared.frames, shared.header->capacity * out.channels * sizeof(int16_t));
+		signal(SIGINT, on_signal);
+		signal(SIGTERM, on_signal);
+		if (rt) {
+			rt_enter_thread(RT_DEFAULT_PRIORITY, rt_cpu, stdout);
+			rt_prefault_stack();
+		}
+		if ((err = play_shared(&out, &shared, &played, &ring_underruns)) < 0)
+			printf("ERROR. Can't write to PCM device. %s\n", snd_strerror(err));
+		pcm_output_close(&out, !interrupted);
+		printf("played %llu frames = %.3f seconds, %s\n", played, (double)played / out.rate,
+		       shm_ring_producer_alive(&shared) ? "generator still running" : "generator ended");
+		shm_ring_close(&shared);
+		pcm_output_report(&out, stdout);
+		printf("ring underruns: %lu\n", ring_underruns);
+		if (rt) {
+			rt_histogram_print(&wakeup_hist, "wake-up latency", stdout);
+			rt_histogram_print(&write_hist, out.mmap ? "mmap_commit" : "snd_pcm_writei", stdout);
+		}
+		return 0;
+	}
 
-	/* Allocate buffer to hold single period */
-	snd_pcm_hw_params_get_period_size(params, &frames, 0);
+	frame_bytes = out.channels * sizeof(int16_t);
+	/* in frames, never in time. WAV: until the reader has nothing more (loops and --repeat can be endless) */
+	total = wav_input ? ~0ULL : (unsigned long long)seconds * out.rate;
 
-	buff_size = frames * channels * 2; 			/* 2 -> sample size */
-	buff = (char *) malloc(buff_size);
+	/* read-ahead ring, whole seconds of audio, at least two ALSA buffers */
+	ring_bytes = (size_t)out.rate * READ_AHEAD_MS / 1000;
+	if (ring_bytes < 2 * out.buffer_size)
+		ring_bytes = 2 * out.buffer_size;
+	ring_bytes *= frame_bytes;
+	read_ahead ahead(ring_bytes);
+	if (wav_input)
+		ahead.plan = &plan;
+	if (rt) {
+		ring_regions<char> regions;
+		ahead.ring.write_regions(regions);
+		rt_prefault(regions.first, regions.first_count);
+	}
+	printf("read-ahead: %.0f ms\n", ahead.ring.capacity() / frame_bytes * 1000.0 / out.rate);
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	std::thread reader(reader_thread, &ahead);
+	/* only the playback thread: a reader started after this would inherit SCHED_FIFO and the audio cpu */
+	if (rt) {
+		rt_enter_thread(RT_DEFAULT_PRIORITY, rt_cpu, stdout);
+		rt_prefault_stack();
+	}
 
-	snd_pcm_hw_params_get_period_time(params, &tmp, NULL);
+	/* start with a full ALSA buffer ready (or the whole file if it is shorter) */
+	prefill = out.buffer_size < total ? out.buffer_size : total;
+	while (ahead.ring.read_available() / frame_bytes < prefill && !ahead.eof.load(std::memory_order_acquire))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
-	for (loops = (seconds * 1000000) / tmp; loops > 0; loops--)	// tmp = period duration
+	while (played < total && !interrupted)
 	{
-		if (pcm = read(0, buff, buff_size) == 0)	// stored in buff tmp array
+		eof = ahead.eof.load(std::memory_order_acquire);	/* before reading the fill level */
+		buffered = ahead.ring.read_available() / frame_bytes;
+		if (buffered == 0 && eof)
 		{
-			printf("Early end of file.\n");
-			return 0;
+			if (!wav_input)
+				printf("Early end of file.\n");
+			break;
 		}
-
-		if (pcm = snd_pcm_writei(pcm_handle, buff, frames) == -EPIPE) // underrun: application doesn't pass data into buffer quick enough
-		{
-			printf("XRUN.\n");
-			if (pcm = snd_pcm_prepare(pcm_handle) < 0) //put the stream in the PREPARED state
-				printf("ERROR: Can't prepare. %s\n", snd_strerror(pcm));
+		count = total - played < out.period_size ? total - played : out.period_size;
+		if (buffered < count && !eof)
+		{	/* reader fell behind, the ALSA buffer is still playing */
+			if (!starving)
+				ring_underruns++;
+			starving = true;
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			continue;
 		}
-		else if (pcm < 0)
-		{
-			printf("ERROR. Can't write to PCM device. %s\n", snd_strerror(pcm));
+		starving = false;
+		if (!eof)
+		{	/* the drain at the end of the file is not a low fill */
+			if (buffered < min_fill)
+				min_fill = buffered;
+			fill_sum += buffered;
+			fill_samples++;
 		}
+
+		if (count > buffered)
+			count = buffered;	/* last frames of the file */
+		if ((err = pcm_output_begin(&out, &frames, &count)) < 0)
+			break;
+		if (count == 0)
+			continue;	// device busy, wait again
+
+		ahead.ring.read((char *)frames, count * frame_bytes);	// ring -> hardware buffer
+		if ((err = pcm_output_commit(&out, count)) < 0)
+			break;
+		played += count;
 	}
+	if (err < 0)
+		printf("ERROR. Can't write to PCM device. %s\n", snd_strerror(err));
 
-	snd_pcm_drain(pcm_handle);	//allow any pending sound samples to be transferred
-	snd_pcm_close(pcm_handle);
-	free(buff);
+	ahead.stop.store(true);
+	reader.join();
+	pcm_output_close(&out, !interrupted);	//allow any pending sound samples to be transferred
+	printf("played %llu frames = %.3f seconds\n", played, (double)played / out.rate);
+	if (wav_input)
+		printf("files started: %lu, loop jumps: %lu\n", ahead.files_started, ahead.loop_jumps);
+	pcm_output_report(&out, stdout);	// xrun = underrun: application doesn't pass data into buffer quick enough
+	if (fill_samples)
+		printf("read-ahead fill: min %.1f ms, avg %.1f ms, ", min_fill * 1000.0 / out.rate,
+		       fill_sum * 1000.0 / fill_samples / out.rate);
+	else
+		printf("read-ahead fill: whole input in the ring, ");
+	printf("ring underruns: %lu, slowest read: %.2f ms\n", ring_underruns, ahead.slowest_read_ms);
+	if (rt) {
+		rt_histogram_print(&wakeup_hist, "wake-up latency", stdout);
+		rt_histogram_print(&write_hist, out.mmap ? "mmap_commit" : "snd_pcm_writei", stdout);
+	}
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -1,138 +1,156 @@
 // plays sine wave and cos wave to 2 channels
 // library install from terminal: sudo apt-get install libasound2-dev
 // side note: build and run stderr $ gcc stderr.c -o s && ./s
-// link it with -lasound and -lm (math), i.e. compile like this: gcc -o alsa_sin alsa_sin.c -lasound -lm
-// to run: sudo ./alsa_sin
+// link it with -lasound and -lm (math), i.e. compile like this: gcc -O3 -o alsa_sin alsa_sin.c pcm_output.c -lasound -lm
+//      (32 bit Raspberry Pi OS: add -mfpu=neon-vfpv4 so the period loops are vectorized)
+// to run: sudo ./alsa_sin [freq] [seconds] [sampling_rate] [device]       defaults: 480 20 48000 default
+//
+// Synthesis is done one period at a time, no libm call per sample:
+//  -- rot[k] = (cos k*d, sin k*d), d = 2*pi*freq/sampling_rate, is computed once for k = 0..period
+//  -- every period starts at the phasor (c0, s0) = (cos p, sin p) of its first frame, frame k is the rotation
+//     sin(p + k*d) = s0*cos(k*d) + c0*sin(k*d), cos(p + k*d) = c0*cos(k*d) - s0*sin(k*d)
+//     independent per frame, so the loop (and the S16 conversion) vectorizes
+//  -- after the period the phasor is rotated by rot[n] and renormalized to length 1, the error can not grow
+//  -- frames are rendered straight into the hardware buffer (mmap) or one whole period is handed to
+//     snd_pcm_writei (rw fallback), see pcm_output.h. Period size from alsa.profile (alsa_tune) if present
+// At the end the cpu time used is printed as a percentage of the playing time.
 
-#define ALSA_PCM_NEW_HW_PARAMS_API
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
-
-#include <alsa/asoundlib.h>
-
-int main() {
-    int err;    // error number
-    int num_channels = 2;
-    int sampling_rate = 48000, dir = 0, i, j;
-    char* buffer;  //stores sine wave samples, character is 1 byte
-    double x, sin_val, cos_val, freq = 480.0, seconds = 20;
-    int sample_sin, sample_cos; // each sample of sine, cos wave
-    int amp = 10000;
-
-    // alsa specific structures
-    snd_pcm_t* handle; // reference to the sound card
-    snd_pcm_hw_params_t* params; // Information about hardware params
-
-    snd_pcm_uframes_t frames = 4; // period size, period contains frames
-    //snd_pcm_uframes_t is unsigned long which is  bytes, e.g. long frames = 4  
-
-    // open reference to the sound card
-    err = snd_pcm_open(&handle, "default", SND_PCM_STREAM_PLAYBACK, 0);	// default sound card
-    if (err < 0) {
-        fprintf(stderr, "unable to open defualt device: %s\n", snd_strerror(err));
-        exit(1);
+#include <time.h>
+#include <sys/resource.h>
+
+#include "pcm_output.h"
+
+// one phasor rotation table, rot_cos[k] + i*rot_sin[k] = e^(i*k*d)
+typedef struct quadrature_osc {
+    double c, s;            // phasor of the next frame
+    float* rot_cos;
+    float* rot_sin;
+    snd_pcm_uframes_t size; // entries 0..size
+} quadrature_osc;
+
+static int osc_init(quadrature_osc* osc, double freq, unsigned int sampling_rate, snd_pcm_uframes_t period) {
+    snd_pcm_uframes_t k;
+    double d = 2.0 * M_PI * freq / (double)sampling_rate;
+    osc->c = 1.0;           // cos(0): the cos channel starts at the maximum like before
+    osc->s = 0.0;
+    osc->size = period;
+    osc->rot_cos = (float*)malloc((period + 1) * sizeof(float));
+    osc->rot_sin = (float*)malloc((period + 1) * sizeof(float));
+    if (!osc->rot_cos || !osc->rot_sin)
+        return -1;
+    for (k = 0; k <= period; k++) {
+        osc->rot_cos[k] = (float)cos(k * d);
+        osc->rot_sin[k] = (float)sin(k * d);
     }
+    return 0;
+}
 
-    // Now we allocate memory for the parameters structure on the stack
-    snd_pcm_hw_params_alloca(&params);
-
-    // Next, we're going to set all the parameters for the sound card
-
-    // This sets up the soundcard with some default parameters and we'll 
-    // customize it a bit afterwards
-    err = snd_pcm_hw_params_any(handle, params);
-    if (err < 0) {
-        fprintf(stderr, "Broken configuration for playback: no configurations available: %s\n", snd_strerror(err));
-        exit(1);
+// n <= osc->size interleaved frames, sine left (white channel on the hifiberry), cos right
+static void osc_render(quadrature_osc* osc, int16_t* restrict frames, snd_pcm_uframes_t n, float amp) {
+    snd_pcm_uframes_t k;
+    const float c0 = (float)osc->c, s0 = (float)osc->s;
+    const float* restrict rot_cos = osc->rot_cos;
+    const float* restrict rot_sin = osc->rot_sin;
+    double c, s, norm;
+
+    for (k = 0; k < n; k++) {
+        float sin_val = amp * (s0 * rot_cos[k] + c0 * rot_sin[k]);
+        float cos_val = amp * (c0 * rot_cos[k] - s0 * rot_sin[k]);
+        sin_val = sin_val > 32767.0f ? 32767.0f : sin_val < -32767.0f ? -32767.0f : sin_val;
+        cos_val = cos_val > 32767.0f ? 32767.0f : cos_val < -32767.0f ? -32767.0f : cos_val;
+        frames[2 * k] = (int16_t)(int32_t)sin_val;
+        frames[2 * k + 1] = (int16_t)(int32_t)cos_val;
     }
 
-    // Set the samples for each channel to be interleaved
-    err = snd_pcm_hw_params_set_access(handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
-    if (err < 0) {
-        fprintf(stderr, "Access type not available for playback: %s\n", snd_strerror(err));
-        exit(1);
-    }
+    // advance by n frames, renormalize once per period
+    c = osc->c * osc->rot_cos[n] - osc->s * osc->rot_sin[n];
+    s = osc->s * osc->rot_cos[n] + osc->c * osc->rot_sin[n];
+    norm = 1.0 / sqrt(c * c + s * s);
+    osc->c = c * norm;
+    osc->s = s * norm;
+}
 
-    // This says our samples represented as signed, 16 bit integers in little endian format
-    err = snd_pcm_hw_params_set_format(handle, params, SND_PCM_FORMAT_S16_LE);
-    if (err < 0) {
-        fprintf(stderr, "sample_sin format not available for playback: %s\n", snd_strerror(err));
-        exit(1);
-    }
+static double cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
 
-    // We use 2 channels (left audio and right audio)
-    err = snd_pcm_hw_params_set_channels(handle, params, num_channels);  // we want to write to mono channel, so 1, another channel will be used to write cos
-    if (err < 0) {
-        fprintf(stderr, "Channels count (%d) not available for playbacks: %s\n", num_channels, snd_strerror(err));
+int main(int argc, char* argv[]) {
+    int err = 0;    // error number
+    int num_channels = 2;
+    unsigned int sampling_rate = 48000;
+    double freq = 480.0, seconds = 20;
+    float amp = 10000;
+    const char* device = "default";
+    pcm_output out;
+    pcm_profile profile;
+    snd_pcm_uframes_t period_size = 1024, count;
+    unsigned int periods = 4;
+    uint64_t played = 0, total;
+    int16_t* frames;
+    quadrature_osc osc;
+    struct timespec start, end;
+    double wall, cpu_start;
+
+    if (argc > 1) freq = atof(argv[1]);
+    if (argc > 2) seconds = atof(argv[2]);
+    if (argc > 3) sampling_rate = (unsigned int)atoi(argv[3]);
+    if (argc > 4) device = argv[4];
+    if (freq <= 0 || seconds <= 0 || sampling_rate == 0) {
+        fprintf(stderr, "usage: %s [freq] [seconds] [sampling_rate] [device]\n", argv[0]);
         exit(1);
     }
 
-    // Here we set our sampling rate. 
-    err = snd_pcm_hw_params_set_rate_near(handle, params, &sampling_rate, &dir);
-    if (err < 0) {
-        fprintf(stderr, "Rate %dHz not available for playback: %s\n", sampling_rate, snd_strerror(err));
-        exit(1);
+    // tuned period size of this device (alsa_tune), else 1024 frames x 4
+    if (pcm_profile_load(PCM_PROFILE_FILE, device, sampling_rate, num_channels, &profile) == 0) {
+        period_size = profile.period_size;
+        periods = profile.periods;
     }
 
-    // This sets the period size
-    err = snd_pcm_hw_params_set_period_size_near(handle, params, &frames, &dir);
+    // open reference to the sound card, S16_LE interleaved, mmap if the device has it
+    err = pcm_output_open(&out, device, sampling_rate, num_channels, period_size, periods, PCM_ACCESS_AUTO);
     if (err < 0) {
-        fprintf(stderr, "Set period error: %s\n", snd_strerror(err));
+        fprintf(stderr, "unable to open %s device: %s\n", device, snd_strerror(err));
         exit(1);
     }
+    printf("%s: %u Hz, period %lu frames, buffer %lu frames, %s access\n", device, out.rate,
+           (unsigned long)out.period_size, (unsigned long)out.buffer_size, pcm_output_access_name(&out));
 
-    // Finally, the parameters get written to the sound card
-    err = snd_pcm_hw_params(handle, params);
-    if (err < 0) {
-        fprintf(stderr, "unable to set the hw params: %s\n", snd_strerror(err));
+    if (osc_init(&osc, freq, out.rate, out.period_size) < 0) {
+        fprintf(stderr, "out of memory\n");
         exit(1);
     }
 
-    // This allocates memory to hold our samples
-    // buffer contains 4*4 = array of 16 chars, each chars is a byte
-    buffer = (char*)malloc(frames * 4);   // frame = 4
-
-    j = 0;
-    for (i = 0; i < seconds * sampling_rate; i++) {
-        // Create a sample_sin and convert it back to an integer
-        x = (double)i / (double)sampling_rate;
-        sin_val = sin(2.0 * 3.14159 * freq * x);  // sin_val between -1 and 1, double is 8 bytes
-        // cos_val = sin((2.0 * 3.14159 * freq * x) + (90 * 3.14159 / 180));    // cos is sine with 90 degree positive phase shift
-        cos_val = cos(2.0 * 3.14159 * freq * x);
-        
-        sample_sin = amp * sin_val;   // sample_sin is int, 4 bytes
-        sample_cos = amp * cos_val;
-
-        // Store the sample_sin in our buffer using Little Endian format i.e. filling buffer from LSB to MSB right to left
-        // 0 and 1 are for white channel in hifiberry, probably channel 1
-        buffer[0 + 4 * j] = sample_sin & 0xff;    // 0001, output LSB of sample_sin in LSB of buffer
-        buffer[1 + 4 * j] = (sample_sin & 0xff00) >> 8;   // sample_sin & 1100 and right shift by 8 bits to get bits 8 to 15 (right to left) 
-
-        // following works for red channel, does not work as expected e.g.shows same as sine
-        buffer[2 + 4 * j] = sample_cos & 0xff;
-        buffer[3 + 4 * j] = (sample_cos & 0xff00) >> 8;
-        
-        //test red channel with random instead, it works expected
-        //buffer[2 + 4 * j] = random() & 0xff;
-        //buffer[3 + 4 * j] = (random() & 0xff00) >> 8;
-
-        // If we have a buffer full of samples, write 1 period of samples to the sound card
-        if (++j == frames) {  // true when j == 3
-            j = snd_pcm_writei(handle, buffer, frames);
-
-            // Check for under runs
-            if (j < 0) {
-                snd_pcm_prepare(handle);
-            }
-
-            j = 0;
-        }
+    cpu_start = cpu_seconds();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    total = (uint64_t)(seconds * out.rate);
+    while (played < total) {
+        count = total - played < out.period_size ? total - played : out.period_size;
+        if ((err = pcm_output_begin(&out, &frames, &count)) < 0)
+            break;
+        if (count == 0)
+            continue;   // device busy, wait again
+        osc_render(&osc, frames, count, amp);
+        if ((err = pcm_output_commit(&out, count)) < 0)
+            break;
+        played += count;
     }
+    if (err < 0)
+        fprintf(stderr, "write error: %s\n", snd_strerror(err));
 
     // Play all remaining samples before exitting
-    snd_pcm_drain(handle);
-
-    // Close the sound card handle
-    snd_pcm_close(handle);  return 0;
+    pcm_output_close(&out, 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    wall = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("played %.2f s, cpu %.3f%%, ", played / (double)out.rate, 100.0 * (cpu_seconds() - cpu_start) / wall);
+    pcm_output_report(&out, stdout);
+
+    free(osc.rot_cos);
+    free(osc.rot_sin);
+    return 0;
 }
@@ -0,0 +1,125 @@
+/*H**********************************************************************
+* FILENAME :        alsa_tune.c
+*
+* DESCRIPTION :
+*       Measures the ALSA configuration of a device instead of guessing it: probes the supported period and
+*       buffer sizes, load tests period/buffer candidates from the lowest latency up and saves the first one
+*       without xruns as the profile of the device (pcm_output.h). laser_player and alsa-wav pick the profile up.
+*
+How to build:
+    gcc -O2 alsa_tune.c pcm_output.c -o alsa_tune -lasound -lpthread
+
+How to call:
+    ./alsa_tune <device> [sampling_rate] [channels] [options]       defaults: 48000 2
+    options:
+        --load=<fraction>   cpu time the writer burns per period, as a fraction of the period time (default 0.5)
+        --stress=<n>        n extra threads spinning during the test, the rest of the system (default 0)
+        --ms=<ms>           test time per candidate (default 1000)
+        --profile=<file>    profile file (default alsa.profile)
+        --probe             only print what the device supports
+
+    e.g.  ./alsa_tune hw:0,0 48000 2 --load=0.6 --stress=2
+
+Note:
+    -- run it on the target board with the load it will see, as root (or with rtprio) if the player runs that way.
+       A profile is only as good as the test: a longer --ms and a higher --load give more margin
+    -- plays silence on the device while testing
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcm_output.h"
+
+#define MAX_STRESS_THREADS 64
+
+static volatile int stress_running = 1;
+
+static void *stress_thread(void *arg)
+{
+    volatile unsigned long spin = 0;
+    (void)arg;
+    while (stress_running)
+        spin++;
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, err, positional = 0, probe_only = 0, stress = 0;
+    unsigned int rate = 48000, channels = 2, test_ms = 1000;
+    double load = 0.5;
+    const char *device = NULL, *profile_file = PCM_PROFILE_FILE;
+    pthread_t threads[MAX_STRESS_THREADS];
+    pcm_caps caps;
+    pcm_profile profile;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--load=", 7) == 0)
+            load = atof(argv[i] + 7);
+        else if (strncmp(argv[i], "--stress=", 9) == 0)
+            stress = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--ms=", 5) == 0)
+            test_ms = (unsigned int)atoi(argv[i] + 5);
+        else if (strncmp(argv[i], "--profile=", 10) == 0)
+            profile_file = argv[i] + 10;
+        else if (strcmp(argv[i], "--probe") == 0)
+            probe_only = 1;
+        else if (strncmp(argv[i], "--", 2) == 0)
+        {
+            printf("Invalid argument: unknown option %s\n", argv[i]);
+            return -1;
+        }
+        else if (positional == 0)
+            device = argv[i], positional++;
+        else if (positional == 1)
+            rate = (unsigned int)atoi(argv[i]), positional++;
+        else if (positional == 2)
+            channels = (unsigned int)atoi(argv[i]), positional++;
+    }
+    if (!device || rate == 0 || channels == 0 || load < 0.0 || load >= 1.0 || test_ms == 0 ||
+        stress < 0 || stress > MAX_STRESS_THREADS)
+    {
+        printf("Input Error: usage %s <device> [sampling_rate] [channels] [--load=0..1) [--stress=n] [--ms=ms] "
+               "[--profile=file] [--probe]\n", argv[0]);
+        return -1;
+    }
+
+    if ((err = pcm_output_probe(device, rate, channels, &caps)) < 0)
+    {
+        printf("ERROR: Can't probe \"%s\". %s\n", device, snd_strerror(err));
+        return -2;
+    }
+    printf("device: %s, rate: %u, channels: %u, mmap: %s\n", device, caps.rate, channels, caps.mmap ? "yes" : "no");
+    printf("period: %lu..%lu frames, buffer: %lu..%lu frames\n", (unsigned long)caps.period_min,
+           (unsigned long)caps.period_max, (unsigned long)caps.buffer_min, (unsigned long)caps.buffer_max);
+    if (probe_only)
+        return 0;
+
+    printf("load test: %.0f%% of every period busy, %d stress threads, %u ms per candidate\n", load * 100, stress, test_ms);
+    for (i = 0; i < stress; i++)
+        pthread_create(&threads[i], NULL, stress_thread, NULL);
+    err = pcm_output_autotune(device, rate, channels, load, test_ms, &profile, stdout);
+    stress_running = 0;
+    for (i = 0; i < stress; i++)
+        pthread_join(threads[i], NULL);
+    if (err < 0)
+    {
+        printf("ERROR: no configuration of \"%s\" could be tested. %s\n", device, snd_strerror(err));
+        return -3;
+    }
+
+    printf("profile: period %lu x %u = %.2f ms, %s\n", (unsigned long)profile.period_size, profile.periods,
+           profile.period_size * profile.periods * 1000.0 / profile.rate, profile.access == PCM_ACCESS_MMAP ? "mmap" : "rw");
+    if ((err = pcm_profile_save(profile_file, &profile)) < 0)
+    {
+        printf("ERROR: Can't write %s. %s\n", profile_file, strerror(-err));
+        return -4;
+    }
+    printf("saved to %s\n", profile_file);
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*H**********************************************************************
+* FILENAME :        control_socket.c
+*
+* DESCRIPTION :
+*       Non blocking Unix domain socket command server and client connect, see control_socket.h.
+*       C, compiles as C++ too.
+*
+How to build:
+    gcc -O2 -c control_socket.c -o control_socket.o     (or list control_socket.c in the compile line)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /* accept4 */
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "control_socket.h"
+
+static int set_address(struct sockaddr_un *address, const char *path)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path))
+        return -ENAMETOOLONG;
+    strcpy(address->sun_path, path);
+    return 0;
+}
+
+static void drop_client(ctl_server *server, int client)
+{
+    close(server->clients[client].fd);
+    server->clients[client].fd = -1;
+    server->clients[client].used = 0;
+}
+
+int ctl_server_open(ctl_server *server, const char *path)
+{
+    int i, err;
+    struct sockaddr_un address;
+
+    memset(server, 0, sizeof(*server));
+    server->listen_fd = -1;
+    for (i = 0; i < CTL_MAX_CLIENTS; i++)
+        server->clients[i].fd = -1;
+    if ((err = set_address(&address, path)) < 0)
+        return err;
+    strcpy(server->path, path);
+
+    unlink(path);   /* stale socket of a player that did not exit cleanly */
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(server->listen_fd, CTL_MAX_CLIENTS) != 0)
+    {
+        err = -errno;
+        if (server->listen_fd >= 0)
+            close(server->listen_fd);
+        server->listen_fd = -1;
+        return err;
+    }
+    return 0;
+}
+
+int ctl_server_fds(const ctl_server *server, struct pollfd *pfds, int space)
+{
+    int i, count = 0;
+    if (server->listen_fd < 0 || space < 1)
+        return 0;
+    /* the listen socket first, then the clients in slot order (ctl_server_handle walks them the same way) */
+    pfds[count].fd = server->listen_fd;
+    pfds[count].events = POLLIN;
+    pfds[count++].revents = 0;
+    for (i = 0; i < CTL_MAX_CLIENTS && count < space; i++)
+    {
+        if (server->clients[i].fd < 0)
+            continue;
+        pfds[count].fd = server->clients[i].fd;
+        pfds[count].events = POLLIN;
+        pfds[count++].revents = 0;
+    }
+    return count;
+}
+
+static void accept_clients(ctl_server *server)
+{
+    int fd, i;
+    while ((fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        for (i = 0; i < CTL_MAX_CLIENTS && server->clients[i].fd >= 0; i++)
+            ;
+        if (i == CTL_MAX_CLIENTS)
+        {
+            send(fd, "error too many clients\n", 23, MSG_DONTWAIT | MSG_NOSIGNAL);
+            close(fd);
+            continue;
+        }
+        server->clients[i].fd = fd;
+        server->clients[i].used = 0;
+        server->clients[i].generation = ++server->next_generation;
+    }
+}
+
+/* reads what is there, calls the handler for every complete line */
+static void read_client(ctl_server *server, int client, ctl_handler handler, void *user)
+{
+    ctl_client *c = &server->clients[client];
+    ssize_t got;
+    char *newline;
+
+    for (;;)
+    {
+        got = recv(c->fd, c->line + c->used, CTL_LINE_MAX - c->used, MSG_DONTWAIT);
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            return;
+        if (got <= 0)
+        {   /* closed by the client or an error */
+            drop_client(server, client);
+            return;
+        }
+        c->used += (int)got;
+        while ((newline = (char *)memchr(c->line, '\n', c->used)) != NULL)
+        {
+            int length = (int)(newline - c->line);
+            *newline = '\0';
+            if (length > 0 && c->line[length - 1] == '\r')
+                c->line[length - 1] = '\0';
+            handler(server, client, c->line, user);
+            if (c->fd < 0)
+                return;     /* the handler closed it */
+            c->used -= length + 1;
+            memmove(c->line, newline + 1, c->used);
+        }
+        if (c->used == CTL_LINE_MAX)
+        {
+            send(c->fd, "error line too long\n", 20, MSG_DONTWAIT | MSG_NOSIGNAL);
+            drop_client(server, client);
+            return;
+        }
+    }
+}
+
+void ctl_server_handle(ctl_server *server, const struct pollfd *pfds, int count, ctl_handler handler, void *user)
+{
+    int i, client;
+    if (count <= 0)
+        return;
+    for (i = 1; i < count; i++)
+    {
+        if (!pfds[i].revents)
+            continue;
+        for (client = 0; client < CTL_MAX_CLIENTS && server->clients[client].fd != pfds[i].fd; client++)
+            ;
+        if (client < CTL_MAX_CLIENTS)
+            read_client(server, client, handler, user);
+    }
+    if (pfds[0].revents & POLLIN)
+        accept_clients(server);    /* after the clients: the new ones are not in pfds yet */
+}
+
+int ctl_server_reply(ctl_server *server, int client, unsigned int generation, const char *text)
+{
+    char line[CTL_LINE_MAX];
+    int length;
+    ctl_client *c;
+
+    if (client < 0 || client >= CTL_MAX_CLIENTS)
+        return -EINVAL;
+    c = &server->clients[client];
+    if (c->fd < 0 || c->generation != generation)
+        return -ENOTCONN;
+    length = (int)strlen(text);
+    if (length > CTL_LINE_MAX - 2)
+        length = CTL_LINE_MAX - 2;
+    memcpy(line, text, length);
+    line[length++] = '\n';
+    if (send(c->fd, line, length, MSG_DONTWAIT | MSG_NOSIGNAL) != length)
+        return errno ? -errno : -EAGAIN;
+    return 0;
+}
+
+unsigned int ctl_server_generation(const ctl_server *server, int client)
+{
+    return client >= 0 && client < CTL_MAX_CLIENTS ? server->clients[client].generation : 0;
+}
+
+void ctl_server_close(ctl_server *server)
+{
+    int i;
+    for (i = 0; i < CTL_MAX_CLIENTS; i++)
+        if (server->clients[i].fd >= 0)
+            drop_client(server, i);
+    if (server->listen_fd >= 0)
+    {
+        close(server->listen_fd);
+        unlink(server->path);
+    }
+    server->listen_fd = -1;
+}
+
+int ctl_connect(const char *path)
+{
+    int fd, err;
+    struct sockaddr_un address;
+
+    if ((err = set_address(&address, path)) < 0)
+        return err;
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        return -errno;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        err = -errno;
+        close(fd);
+        return err;
+    }
+    return fd;
+}
@@ -0,0 +1,90 @@
+/*H**********************************************************************
+* FILENAME :        control_socket.h
+*
+* DESCRIPTION :
+*       Local control of a running player: a Unix domain stream socket, one text command per line, one reply
+*       line per command. The server never blocks: it hands its descriptors to the poll() loop of the caller
+*       (next to the ALSA descriptors) and only reads, accepts and sends when poll says so. No allocation after
+*       ctl_server_open, fixed number of clients and line length.
+*
+* PUBLIC FUNCTIONS :
+*   int ctl_server_open(ctl_server *server, const char *path)
+*   int ctl_server_fds(const ctl_server *server, struct pollfd *pfds, int space)
+*   void ctl_server_handle(ctl_server *server, const struct pollfd *pfds, int count, ctl_handler handler, void *user)
+*   int ctl_server_reply(ctl_server *server, int client, unsigned int generation, const char *text)
+*   unsigned int ctl_server_generation(const ctl_server *server, int client)
+*   void ctl_server_close(ctl_server *server)
+*   int ctl_connect(const char *path)
+*
+How to use:
+    ctl_server server;
+    ctl_server_open(&server, "/tmp/laser.sock");
+    for (;;) {
+        struct pollfd pfds[16];
+        int n = pcm_output_poll_descriptors(&out, pfds, 8);
+        int m = ctl_server_fds(&server, pfds + n, 16 - n);
+        poll(pfds, n + m, timeout);
+        ctl_server_handle(&server, pfds + n, m, on_command, &state);     // on_command(server, client, line, user)
+        ...
+    }
+
+Protocol:
+    request:  <command> [arguments]\n
+    reply:    ok [text]\n   or   error <reason>\n
+    e.g.  echo "stats" | socat - UNIX-CONNECT:/tmp/laser.sock      or  ./laser_ctl /tmp/laser.sock stats
+
+Note:
+    -- a reply that does not fit into the socket buffer is dropped (the client reads too slowly), never waited for
+    -- a reply can come later from another thread's work: keep client and ctl_server_generation(client) with the
+       request, ctl_server_reply drops the reply if the client left (the slot got a new generation) meanwhile
+    -- a line longer than CTL_LINE_MAX closes the client, more than CTL_MAX_CLIENTS clients are refused
+    -- the socket file is removed by open (a stale one from a crash) and by close
+
+How to build: add control_socket.c to the compile line
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef CONTROL_SOCKET_H
+#define CONTROL_SOCKET_H
+
+#include <poll.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CTL_MAX_CLIENTS 8
+#define CTL_LINE_MAX 512
+#define CTL_PATH_MAX 108        /* sun_path */
+
+typedef struct ctl_client{
+    int fd;                             /* -1 = free slot */
+    unsigned int generation;
+    char line[CTL_LINE_MAX];
+    int used;
+} ctl_client;
+
+typedef struct ctl_server{
+    int listen_fd;
+    char path[CTL_PATH_MAX];
+    unsigned int next_generation;
+    ctl_client clients[CTL_MAX_CLIENTS];
+} ctl_server;
+
+/* one complete line without the newline */
+typedef void (*ctl_handler)(ctl_server *server, int client, const char *line, void *user);
+
+int ctl_server_open(ctl_server *server, const char *path);     /* 0 or -errno */
+int ctl_server_fds(const ctl_server *server, struct pollfd *pfds, int space);
+void ctl_server_handle(ctl_server *server, const struct pollfd *pfds, int count, ctl_handler handler, void *user);
+int ctl_server_reply(ctl_server *server, int client, unsigned int generation, const char *text);   /* 0 or -errno */
+unsigned int ctl_server_generation(const ctl_server *server, int client);
+void ctl_server_close(ctl_server *server);
+int ctl_connect(const char *path);     /* connected fd or -errno */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
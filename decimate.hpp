@@ -0,0 +1,199 @@
+/*H**********************************************************************
+* FILENAME :        decimate.hpp
+*
+* DESCRIPTION :
+*       Drops points of a trace that do not change its shape, so that long PathToPoints traces fit into the
+*       lookup table without growing it (a longer table means a longer cycle and a lower refresh rate)
+*
+* PUBLIC FUNCTIONS :
+*   decimation_report decimate_tolerance(std::vector<PointT> &points, double tolerance)
+*   decimation_report decimate_budget(std::vector<PointT> &points, std::size_t budget)
+*
+Note:
+    -- decimate_tolerance: Ramer-Douglas-Peucker. Keeps few points so that no dropped point lies further than
+       tolerance from the simplified trace. Uses an explicit stack instead of recursion. Plain RDP is O(n^2) when
+       the farthest point keeps landing next to an end of the range (a zigzag of growing amplitude, dense arcs):
+       a range of more than DECIMATE_BALANCE_MIN points whose farthest point lies in its outer
+       1/DECIMATE_BALANCE is split at its middle instead. The middle point is kept, the tolerance still holds,
+       every range shrinks to at most 7/8 per level, O(n log n) worst case at the price of a few extra points.
+    -- decimate_budget: Visvalingam-Whyatt. Repeatedly drops the point whose triangle with its two neighbours has
+       the smallest area until budget points are left, i.e. keeps the budget most significant points.
+       Min-heap with lazy deletion, O(n log n).
+    The first and the last point are always kept. Both report the largest distance between a dropped point and
+    the segment that replaced it, in the unit of the point coordinates.
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef DECIMATE_HPP
+#define DECIMATE_HPP
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+const std::size_t DECIMATE_BALANCE = 8;         // farthest point in the outer 1/8 of a range: split it in the middle
+const std::size_t DECIMATE_BALANCE_MIN = 64;    // smaller ranges are split at the farthest point only
+
+struct decimation_report{
+    std::size_t points_before = 0;
+    std::size_t points_after = 0;
+    double max_deviation = 0.0;     // largest distance of a dropped point to the simplified trace
+};
+
+// distance of point p to segment a-b
+inline double segment_distance(double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx - ax, dy = by - ay;
+    double len2 = dx * dx + dy * dy;
+    double t = len2 > 0.0 ? ((px - ax) * dx + (py - ay) * dy) / len2 : 0.0;
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    return std::hypot(px - (ax + t * dx), py - (ay + t * dy));
+}
+
+// removes every point not flagged in keep and fills in the report, O(n)
+template <typename PointT>
+decimation_report apply_decimation(std::vector<PointT> &points, const std::vector<char> &keep)
+{
+    decimation_report report;
+    report.points_before = points.size();
+
+    std::size_t previous = 0;
+    for (std::size_t i = 1; i < points.size(); i++)
+    {
+        if (!keep[i])
+            continue;
+        for (std::size_t j = previous + 1; j < i; j++)  // dropped points between two kept ones
+        {
+            double d = segment_distance(points[j].get_x(), points[j].get_y(),
+                                        points[previous].get_x(), points[previous].get_y(),
+                                        points[i].get_x(), points[i].get_y());
+            if (d > report.max_deviation)
+                report.max_deviation = d;
+        }
+        previous = i;
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < points.size(); i++)
+        if (keep[i])
+            points[kept++] = points[i];
+    points.resize(kept);
+    report.points_after = kept;
+    return report;
+}
+
+template <typename PointT>
+decimation_report decimate_tolerance(std::vector<PointT> &points, double tolerance)
+{
+    std::size_t n = points.size();
+    std::vector<char> keep(n, 0);
+    if (n < 3)
+    {
+        keep.assign(n, 1);
+        return apply_decimation(points, keep);
+    }
+    keep[0] = keep[n - 1] = 1;
+
+    std::vector<std::pair<std::size_t, std::size_t>> stack;     // segments still to be checked
+    stack.push_back(std::make_pair((std::size_t)0, n - 1));
+    while (!stack.empty())
+    {
+        std::size_t a = stack.back().first, b = stack.back().second;
+        stack.pop_back();
+        if (b - a < 2)
+            continue;
+
+        double farthest = -1.0;
+        std::size_t index = a;
+        for (std::size_t i = a + 1; i < b; i++)
+        {
+            double d = segment_distance(points[i].get_x(), points[i].get_y(),
+                                        points[a].get_x(), points[a].get_y(),
+                                        points[b].get_x(), points[b].get_y());
+            if (d > farthest)
+            {
+                farthest = d;
+                index = i;
+            }
+        }
+        if (farthest > tolerance)
+        {
+            std::size_t margin = (b - a) / DECIMATE_BALANCE;
+            if (b - a > DECIMATE_BALANCE_MIN && (index - a < margin || b - index < margin))
+                index = a + (b - a) / 2;    // bounded depth, the farthest point is found again in its half
+            keep[index] = 1;
+            stack.push_back(std::make_pair(a, index));
+            stack.push_back(std::make_pair(index, b));
+        }
+    }
+    return apply_decimation(points, keep);
+}
+
+template <typename PointT>
+decimation_report decimate_budget(std::vector<PointT> &points, std::size_t budget)
+{
+    std::size_t n = points.size();
+    std::vector<char> keep(n, 1);
+    if (budget < 2)
+        budget = 2;
+    if (n <= budget)
+        return apply_decimation(points, keep);
+
+    // doubly linked list over the points that are still kept
+    std::vector<std::size_t> prev(n), next(n);
+    std::vector<double> area(n, 0.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        prev[i] = i - 1;    // wraps for i == 0, never used
+        next[i] = i + 1;
+    }
+    auto triangle_area = [&points](std::size_t a, std::size_t b, std::size_t c){
+        return 0.5 * std::abs((points[b].get_x() - points[a].get_x()) * (points[c].get_y() - points[a].get_y()) -
+                              (points[c].get_x() - points[a].get_x()) * (points[b].get_y() - points[a].get_y()));
+    };
+
+    typedef std::pair<double, std::size_t> heap_entry;
+    std::vector<heap_entry> entries;
+    entries.reserve(n);
+    for (std::size_t i = 1; i + 1 < n; i++)
+    {
+        area[i] = triangle_area(i - 1, i, i + 1);
+        entries.push_back(std::make_pair(area[i], i));
+    }
+    // heapify once in O(n) instead of n pushes
+    std::priority_queue<heap_entry, std::vector<heap_entry>, std::greater<heap_entry>> heap(std::greater<heap_entry>(), std::move(entries));
+
+    std::size_t remaining = n;
+    while (remaining > budget && !heap.empty())
+    {
+        heap_entry top = heap.top();
+        heap.pop();
+        std::size_t i = top.second;
+        if (!keep[i] || top.first != area[i])   // stale entry, point was dropped or its area changed
+            continue;
+
+        keep[i] = 0;
+        remaining--;
+        std::size_t p = prev[i], q = next[i];
+        next[p] = q;
+        prev[q] = p;
+
+        // neighbours get a new triangle, never smaller than the one just dropped so the order stays monotonic
+        if (p > 0)
+        {
+            area[p] = std::max(triangle_area(prev[p], p, q), top.first);
+            heap.push(std::make_pair(area[p], p));
+        }
+        if (q + 1 < n)
+        {
+            area[q] = std::max(triangle_area(p, q, next[q]), top.first);
+            heap.push(std::make_pair(area[q], q));
+        }
+    }
+    return apply_decimation(points, keep);
+}
+
+#endif
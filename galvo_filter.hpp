@@ -0,0 +1,241 @@
+/*H**********************************************************************
+* FILENAME :        galvo_filter.hpp
+*
+* DESCRIPTION :
+*       Pre-emphasis (inverse response) filter for the galvo scanners. The scanners behave like a second order
+*       low pass, at higher scan frequencies the drawn image lags and shrinks. The filter applies a configurable
+*       inverse model to the x and y samples after synthesis so the mirrors follow the lookup table more closely.
+*
+* PUBLIC FUNCTIONS :
+*   bool load_galvo_calibration(std::string file, galvo_calibration &calibration, int sampling_rate)
+*   galvo_filter(const galvo_calibration &calibration)
+*   void galvo_filter::reset(std::int16_t x0, std::int16_t y0)       steady state for a constant input x0, y0
+*   void galvo_filter::process(std::int16_t x_buff[], std::int16_t y_buff[], std::size_t num_samples)
+*
+Calibration file (see galvo.cal):
+-- one biquad section per line, prefixed with the axis it belongs to (x or y). Sections of an axis are
+   applied in the order of the file (cascade). Two kinds of sections:
+        x|galvo:<f0>,<q0>,<f_target>,<q_target>
+            inverse of the galvo model: cancels the second order low pass with resonance f0 (Hz) and quality q0
+            and replaces it with a faster one at f_target, q_target. DC gain is 1. Converted for the sampling
+            rate of the output with the bilinear transform, prewarped at f0.
+        y|biquad:<b0>,<b1>,<b2>,<a1>,<a2>
+            raw coefficients (a0 = 1), used as they are, so they only fit the sampling rate they were made for
+-- empty lines and lines starting with // are ignored, the last line of the file is # [end of file]
+
+Note:
+    Both axes run in the two lanes of one vector (gcc/clang vector extension, SSE2 on x86, NEON on aarch64),
+    transposed direct form II. Samples are filtered in blocks of GALVO_BLOCK, the section states are carried
+    from block to block so the output does not depend on the block boundaries. Output is clamped to int16.
+    Floating point contraction is off in this header: with fused multiply-add (aarch64, x86 with -mfma) the
+    recursion rounds differently and the output, and the regression golden, would depend on the target.
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef GALVO_FILTER_HPP
+#define GALVO_FILTER_HPP
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+const std::size_t GALVO_BLOCK = 256;    // samples per block
+
+typedef double v2df __attribute__((vector_size(16)));  // lane 0 = x, lane 1 = y
+
+struct biquad{
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;    // identity
+};
+
+struct galvo_calibration{
+    std::vector<biquad> x, y;   // cascade per axis
+};
+
+// inverse galvo model (s^2 + s*w0/q0 + w0^2) / (s^2 + s*w1/q1 + w1^2) * w1^2/w0^2, bilinear transform prewarped at f0
+inline bool galvo_inverse_section(double f0, double q0, double f_target, double q_target, int sampling_rate, biquad &section)
+{
+    if (f0 <= 0.0 || q0 <= 0.0 || f_target <= 0.0 || q_target <= 0.0 ||
+        f0 >= sampling_rate / 2.0 || f_target >= sampling_rate / 2.0)
+        return false;
+
+    double w0 = 2.0 * M_PI * f0, w1 = 2.0 * M_PI * f_target;
+    double k = w0 / std::tan(w0 / (2.0 * sampling_rate));
+    double gain = (w1 * w1) / (w0 * w0);
+    double n2 = gain, n1 = gain * w0 / q0, n0 = gain * w0 * w0;    // numerator of H(s)
+    double d2 = 1.0, d1 = w1 / q_target, d0 = w1 * w1;              // denominator of H(s)
+
+    double a0 = d2 * k * k + d1 * k + d0;
+    section.b0 = (n2 * k * k + n1 * k + n0) / a0;
+    section.b1 = 2.0 * (n0 - n2 * k * k) / a0;
+    section.b2 = (n2 * k * k - n1 * k + n0) / a0;
+    section.a1 = 2.0 * (d0 - d2 * k * k) / a0;
+    section.a2 = (d2 * k * k - d1 * k + d0) / a0;
+    return true;
+}
+
+inline bool load_galvo_calibration(std::string file, galvo_calibration &calibration, int sampling_rate)
+{
+    std::ifstream file_calibration(file);
+    std::string line;
+    int line_number = 0;
+
+    if (!file_calibration.is_open())
+    {
+        std::cout << "Input Error: galvo calibration file " << file << " can not be opened" << std::endl;
+        return false;
+    }
+
+    while (std::getline(file_calibration, line))
+    {
+        line_number++;
+        if (line.length() && line[line.length() - 1] == '\r')  // file saved on windows
+            line.erase(line.length() - 1);
+        if (line.length() == 0 || line.rfind("//", 0) == 0)
+            continue;
+        if (line.compare("#") == 0)     // end of file
+            break;
+
+        std::size_t bar = line.find("|"), colon = line.find(":");
+        if (bar == std::string::npos || colon == std::string::npos || colon < bar)
+        {
+            std::cout << "Input Error: invalid line " << line_number << " in galvo calibration file " << file << std::endl;
+            return false;
+        }
+        std::string axis = line.substr(0, bar), kind = line.substr(bar + 1, colon - bar - 1);
+
+        std::vector<double> values;
+        const char *cursor = line.c_str() + colon + 1;
+        char *endptr = NULL;
+        while (*cursor)
+        {
+            values.push_back(std::strtod(cursor, &endptr));
+            if (endptr == cursor)
+                break;
+            cursor = (*endptr == ',') ? endptr + 1 : endptr;
+        }
+
+        biquad section;
+        bool valid = false;
+        if (kind.compare("galvo") == 0 && values.size() == 4)
+            valid = galvo_inverse_section(values[0], values[1], values[2], values[3], sampling_rate, section);
+        else if (kind.compare("biquad") == 0 && values.size() == 5)
+        {
+            section.b0 = values[0];
+            section.b1 = values[1];
+            section.b2 = values[2];
+            section.a1 = values[3];
+            section.a2 = values[4];
+            valid = true;
+        }
+
+        if (!valid || (axis.compare("x") != 0 && axis.compare("y") != 0))
+        {
+            std::cout << "Input Error: invalid section in line " << line_number << " of galvo calibration file " << file
+                      << " (frequencies must be below sampling_rate/2)" << std::endl;
+            return false;
+        }
+        (axis.compare("x") == 0 ? calibration.x : calibration.y).push_back(section);
+    }
+    return true;
+}
+
+class galvo_filter{
+    public:
+        galvo_filter(const galvo_calibration &calibration);
+        void reset(std::int16_t x0, std::int16_t y0);
+        void process(std::int16_t x_buff[], std::int16_t y_buff[], std::size_t num_samples);
+    private:
+        struct section_state{
+            v2df b0, b1, b2, a1, a2;    // coefficients, x and y lane
+            v2df s1, s2;                // transposed direct form II state
+        };
+        std::vector<section_state> sections;
+};
+
+inline galvo_filter::galvo_filter(const galvo_calibration &calibration)
+{
+    std::size_t count = std::max(calibration.x.size(), calibration.y.size());
+    for (std::size_t i = 0; i < count; i++)
+    {   // the shorter cascade is padded with identity sections
+        biquad x = i < calibration.x.size() ? calibration.x[i] : biquad();
+        biquad y = i < calibration.y.size() ? calibration.y[i] : biquad();
+        section_state state;
+        state.b0 = (v2df){x.b0, y.b0};
+        state.b1 = (v2df){x.b1, y.b1};
+        state.b2 = (v2df){x.b2, y.b2};
+        state.a1 = (v2df){x.a1, y.a1};
+        state.a2 = (v2df){x.a2, y.a2};
+        sections.push_back(state);
+    }
+    reset(0, 0);
+}
+
+inline void galvo_filter::reset(std::int16_t x0, std::int16_t y0)
+{
+    v2df in = {(double)x0, (double)y0};
+    for (section_state &section: sections)
+    {   // state of a section that has seen the constant input for ever, output = dc gain * input
+        v2df dc_gain = (section.b0 + section.b1 + section.b2) / ((v2df){1.0, 1.0} + section.a1 + section.a2);
+        v2df out = dc_gain * in;
+        section.s1 = out - section.b0 * in;
+        section.s2 = section.b2 * in - section.a2 * out;
+        in = out;
+    }
+}
+
+inline void galvo_filter::process(std::int16_t x_buff[], std::int16_t y_buff[], std::size_t num_samples)
+{
+    v2df block[GALVO_BLOCK];
+
+    for (std::size_t start = 0; start < num_samples; start += GALVO_BLOCK)
+    {
+        std::size_t count = std::min(GALVO_BLOCK, num_samples - start);
+        for (std::size_t i = 0; i < count; i++)
+            block[i] = (v2df){(double)x_buff[start + i], (double)y_buff[start + i]};
+
+        for (section_state &section: sections)
+        {   // keep coefficients and state in registers for the whole block
+            v2df b0 = section.b0, b1 = section.b1, b2 = section.b2, a1 = section.a1, a2 = section.a2;
+            v2df s1 = section.s1, s2 = section.s2;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                v2df in = block[i];
+                v2df out = b0 * in + s1;
+                s1 = b1 * in - a1 * out + s2;
+                s2 = b2 * in - a2 * out;
+                block[i] = out;
+            }
+            section.s1 = s1;
+            section.s2 = s2;
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            double x = std::min(std::max(block[i][0], -32768.0), 32767.0);    // pre-emphasis overshoots, clamp
+            double y = std::min(std::max(block[i][1], -32768.0), 32767.0);
+            x_buff[start + i] = (std::int16_t)std::lround(x);
+            y_buff[start + i] = (std::int16_t)std::lround(y);
+        }
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -1,160 +1,83 @@
 // plays two waves to 2 channels
 // library install from terminal: sudo apt-get install libasound2-dev
-// side note: build and run stderr $ gcc stderr.c -o s && ./s
-// link it with -lasound and -lm (math), i.e. compile like this: gcc -o alsa_two_vals alsa_two_vals.c -lasound -lm
-// to run: sudo ./alsa_two_vals
+// output goes through the shared pcm module (../pcm_output.h): mmap interleaved, rw where the device has no mmap
+// link it with -lasound and -lm (math), i.e. compile like this: gcc -o alsa_two_vals alsa_two_vals.c ../pcm_output.c -lasound -lm
+// to run: sudo ./alsa_two_vals [device] [mmap|rw|auto]
+// the period size of the device is read from alsa.profile in the working directory, written by ../alsa_tune
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <alsa/asoundlib.h>
+#include "../pcm_output.h"
 
-/* code from http://www.suse.de/~mana/alsa090_howto.html */
+#define PERIODS_TO_PLAY 100	// the howto wrote 100 periods
 
-int main(int argc, char *argv[])
-{	
-	/* Handle for the PCM device */ 
-	snd_pcm_t *pcm_handle;          
-
-	/* Playback stream */
-	snd_pcm_stream_t stream = SND_PCM_STREAM_PLAYBACK;
-
-	/* This structure contains information about    */
-	/* the hardware and can be used to specify the  */      
-	/* configuration to be used for the PCM stream. */ 
-	snd_pcm_hw_params_t *hwparams;
-
-	/* Name of the PCM device, like plughw:0,0          */
-	/* The first number is the number of the soundcard, */
-	/* the second number is the number of the device.   */
-	char *pcm_name;
-
-	pcm_name = argv[1];
-	/* pcm_name = strdup("hw:0.0");  */
-
-	/* Allocate the snd_pcm_hw_params_t structure on the stack. */
-	snd_pcm_hw_params_alloca(&hwparams);
-
-	/* Open PCM. The last parameter of this function is the mode. */
-	/* If this is set to 0, the standard mode is used. Possible   */
-	/* other values are SND_PCM_NONBLOCK and SND_PCM_ASYNC.       */ 
-	/* If SND_PCM_NONBLOCK is used, read / write access to the    */
-	/* PCM device will return immediately. If SND_PCM_ASYNC is    */
-	/* specified, SIGIO will be emitted whenever a period has     */
-	/* been completely processed by the soundcard.                */
-	if (snd_pcm_open(&pcm_handle, pcm_name, stream, 0) < 0) {
-	  fprintf(stderr, "Error opening PCM device %s\n", pcm_name);
-	  return(-1);
-	}
-
-	/* Init hwparams with full configuration space */
-	if (snd_pcm_hw_params_any(pcm_handle, hwparams) < 0) {
-	  fprintf(stderr, "Can not configure this PCM device.\n");
-	  return(-1);
-	}
-
-	int rate = 44100;
-	int exact_rate;   /* Sample rate returned by */
-				  /* snd_pcm_hw_params_set_rate_near */ 
-
-	int dir;          /* exact_rate == rate --> dir = 0 */
-				  /* exact_rate < rate  --> dir = -1 */
-				  /* exact_rate > rate  --> dir = 1 */
-	int periods = 2;       /* Number of periods */
-	snd_pcm_uframes_t periodsize = 8192; /* Periodsize (bytes) */
-
-	int num_frames;
-
-	/* Set access type. This can be either    */
-	/* SND_PCM_ACCESS_RW_INTERLEAVED or       */
-	/* SND_PCM_ACCESS_RW_NONINTERLEAVED.      */
-	/* There are also access types for MMAPed */
-	/* access, but this is beyond the scope   */
-	/* of this introduction.                  */
-	if (snd_pcm_hw_params_set_access(pcm_handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED) < 0) {
-	  fprintf(stderr, "Error setting access.\n");
-	  return(-1);
-	}
-	  
-	/* Set sample format */
-	if (snd_pcm_hw_params_set_format(pcm_handle, hwparams, SND_PCM_FORMAT_S16_LE) < 0) {
-	  fprintf(stderr, "Error setting format.\n");
-	  return(-1);
+// sawtooth of 128 frames on the left channel and of 256 frames on the right one
+static void render_saw(int16_t *frames, snd_pcm_uframes_t count, unsigned long *position)
+{
+	snd_pcm_uframes_t i;
+	for (i = 0; i < count; i++, (*position)++) {
+		frames[2*i] = (int16_t)((*position % 128) * 100 - 5000);
+		frames[2*i+1] = (int16_t)((*position % 256) * 100 - 5000);
 	}
+}
 
-	/* Set sample rate. If the exact rate is not supported */
-	/* by the hardware, use nearest possible rate.         */ 
-	exact_rate = rate;
-	if (snd_pcm_hw_params_set_rate_near(pcm_handle, hwparams, &exact_rate, 0) < 0) {
-	  fprintf(stderr, "Error setting rate.\n");
-	  return(-1);
-	}
-	if (rate != exact_rate) {
-	  fprintf(stderr, "The rate %d Hz is not supported by your hardware.\n ==> Using %d Hz instead.\n", rate, exact_rate);
+int main(int argc, char *argv[])
+{
+	const char *device = "default";	// like plughw:0,0: number of the soundcard, number of the device
+	unsigned int rate = 44100;
+	snd_pcm_uframes_t period_size = 1024, count;
+	unsigned int periods = 4;
+	int access = PCM_ACCESS_AUTO;
+	int err = 0, period;
+	unsigned long position = 0;	// frames rendered, keeps the saws continuous over the periods
+	int16_t *frames;
+	pcm_output out;
+	pcm_profile profile;
+
+	if (argc > 1)
+		device = argv[1];
+	if (argc > 2 && (access = pcm_output_parse_access(argv[2])) < 0) {
+		fprintf(stderr, "usage: %s [device] [mmap|rw|auto]\n", argv[0]);
+		return -1;
 	}
 
-	/* Set number of channels */
-	if (snd_pcm_hw_params_set_channels(pcm_handle, hwparams, 2) < 0) {
-	  fprintf(stderr, "Error setting channels.\n");
-	  return(-1);
+	// tuned period size of this device (../alsa_tune), else 1024 frames x 4. An access mode given on the command
+	// line wins over the profile
+	if (pcm_profile_load(PCM_PROFILE_FILE, device, rate, 2, &profile) == 0) {
+		period_size = profile.period_size;
+		periods = profile.periods;
+		if (argc <= 2)
+			access = profile.access;
 	}
 
-	/* Set number of periods. Periods used to be called fragments. */ 
-	if (snd_pcm_hw_params_set_periods(pcm_handle, hwparams, periods, 0) < 0) {
-	  fprintf(stderr, "Error setting periods.\n");
-	  return(-1);
-	}
-	  
-	/* Set buffer size (in frames). The resulting latency is given by */
-	/* latency = periodsize * periods / (rate * bytes_per_frame)     */
-	if (snd_pcm_hw_params_set_buffer_size(pcm_handle, hwparams, (periodsize * periods)>>2) < 0) {
-	  fprintf(stderr, "Error setting buffersize.\n");
-	  return(-1);
+	// S16_LE, 2 channels interleaved, rate and period size are near values
+	if ((err = pcm_output_open(&out, device, rate, 2, period_size, periods, access)) < 0) {
+		fprintf(stderr, "Error opening PCM device %s: %s\n", device, snd_strerror(err));
+		return -1;
 	}
-	  
-	/* Apply HW parameter settings to */
-	/* PCM device and prepare device  */
-	if (snd_pcm_hw_params(pcm_handle, hwparams) < 0) {
-	  fprintf(stderr, "Error setting HW params.\n");
-	  return(-1);
+	if (out.rate != rate)
+		fprintf(stderr, "The rate %u Hz is not supported by your hardware.\n ==> Using %u Hz instead.\n", rate, out.rate);
+	printf("%s: %u Hz, period %lu frames, buffer %lu frames, %s access\n", device, out.rate,
+	       (unsigned long)out.period_size, (unsigned long)out.buffer_size, pcm_output_access_name(&out));
+
+	for (period = 0; period < PERIODS_TO_PLAY; period++) {
+		count = out.period_size;
+		if ((err = pcm_output_begin(&out, &frames, &count)) < 0)
+			break;
+		if (count == 0) {	// device busy, wait again
+			period--;
+			continue;
+		}
+		render_saw(frames, count, &position);	// straight into the hardware buffer (mmap) or the staging one (rw)
+		if ((err = pcm_output_commit(&out, count)) < 0)
+			break;
 	}
-	  
-	/* Write num_frames frames from buffer data to    */ 
-	/* the PCM device pointed to by pcm_handle.       */
-	/* Returns the number of frames actually written. */
-	snd_pcm_sframes_t snd_pcm_writei(pcm_handle, data, num_frames);
-	  
-	/* Write num_frames frames from buffer data to    */ 
-	/* the PCM device pointed to by pcm_handle.       */ 
-	/* Returns the number of frames actually written. */
-	snd_pcm_sframes_t snd_pcm_writen(pcm_handle, data, num_frames);
-	  
-	unsigned char *data;
-	int pcmreturn, l1, l2;
-	short s1, s2;
-	int frames;
-
-	data = (unsigned char *)malloc(periodsize);
-	frames = periodsize >> 2;
-	for(l1 = 0; l1 < 100; l1++) {
-	  for(l2 = 0; l2 < num_frames; l2++) {
-		s1 = (l2 % 128) * 100 - 5000;  
-		s2 = (l2 % 256) * 100 - 5000;  
-		data[4*l2] = (unsigned char)s1;
-		data[4*l2+1] = s1 >> 8;
-		data[4*l2+2] = (unsigned char)s2;
-		data[4*l2+3] = s2 >> 8;
-	  }
-	  while ((pcmreturn = snd_pcm_writei(pcm_handle, data, frames)) < 0) {
-		snd_pcm_prepare(pcm_handle);
-		fprintf(stderr, "<<<<<<<<<<<<<<< Buffer Underrun >>>>>>>>>>>>>>>\n");
-	  }
-	}
-	  
-	/* Stop PCM device and drop pending frames */
-	snd_pcm_drop(pcm_handle);
-
-	/* Stop PCM device after pending frames have been played */ 
-	snd_pcm_drain(pcm_handle);
+	if (err < 0)
+		fprintf(stderr, "write error: %s\n", snd_strerror(err));
 
+	// Stop PCM device after pending frames have been played, underruns are recovered inside pcm_output
+	pcm_output_close(&out, 1);
+	pcm_output_report(&out, stdout);	// xruns and their recovery time
+	return 0;
 }
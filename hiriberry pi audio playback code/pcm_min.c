@@ -1,50 +1,40 @@
 /*
  *  This extra small demo sends a random samples to your speakers.
+ *  Output goes through the shared pcm module (../pcm_output.h): mmap interleaved, rw where the device has no mmap.
+ *  pcm_output plays S16_LE, so the random bytes of the original U8 demo are random 16 bit samples now.
  */
-// link it with -lasound and -lm (math), i.e. compile like this: gcc -o pcm_min pcm_min.c -lasound
+// link it with -lasound, i.e. compile like this: gcc -o pcm_min pcm_min.c ../pcm_output.c -lasound
 
-#include <alsa/asoundlib.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include "../pcm_output.h"
 static char *device = "default";            /* playback device */
-unsigned char buffer[16*1024];              /* some random data */
+int16_t buffer[16*1024];                    /* some random data, mono frames */
 int main(void)
 {
     int err;
     unsigned int i;
-    snd_pcm_t *handle;
+    pcm_output out;
     snd_pcm_sframes_t frames;
-    printf("sizeof(buffer): %d", sizeof(buffer));
-    for (i = 0; i < sizeof(buffer); i++)
-        buffer[i] = random() & 0xff;
-    if ((err = snd_pcm_open(&handle, device, SND_PCM_STREAM_PLAYBACK, 0)) < 0) {
+    printf("sizeof(buffer): %zu\n", sizeof(buffer));
+    for (i = 0; i < sizeof(buffer) / sizeof(buffer[0]); i++)
+        buffer[i] = (int16_t)(random() & 0xffff);
+    /* 1 channel, 48 kHz, 6000 frames x 4 periods = 0.5 sec buffer like snd_pcm_set_params(..., 500000) */
+    if ((err = pcm_output_open(&out, device, 48000, 1, 6000, 4, PCM_ACCESS_AUTO)) < 0) {
         printf("Playback open error: %s\n", snd_strerror(err));
         exit(EXIT_FAILURE);
     }
-    if ((err = snd_pcm_set_params(handle,
-                      SND_PCM_FORMAT_U8,
-                      SND_PCM_ACCESS_RW_INTERLEAVED,
-                      1,
-                      48000,
-                      1,
-                      500000)) < 0) {   /* 0.5sec */
-        printf("Playback open error: %s\n", snd_strerror(err));
-        exit(EXIT_FAILURE);
-    }
-        for (i = 0; i < 16; i++) {
-        frames = snd_pcm_writei(handle, buffer, sizeof(buffer));
-        if (frames < 0)
-            frames = snd_pcm_recover(handle, frames, 0);
+    printf("%s access\n", pcm_output_access_name(&out));
+    for (i = 0; i < 16; i++) {
+        /* underruns are recovered inside pcm_output_write (snd_pcm_recover) */
+        frames = pcm_output_write(&out, buffer, sizeof(buffer) / sizeof(buffer[0]));
         if (frames < 0) {
-            printf("snd_pcm_writei failed: %s\n", snd_strerror(frames));
+            printf("pcm_output_write failed: %s\n", snd_strerror(frames));
             break;
         }
-        if (frames > 0 && frames < (long)sizeof(buffer))
-            printf("Short write (expected %li, wrote %li)\n", (long)sizeof(buffer), frames);
     }
     /* pass the remaining samples, otherwise they're dropped in close */
-    err = snd_pcm_drain(handle);
-    if (err < 0)
-        printf("snd_pcm_drain failed: %s\n", snd_strerror(err));
-    snd_pcm_close(handle);
+    pcm_output_close(&out, 1);
+    pcm_output_report(&out, stdout);
     return 0;
 }
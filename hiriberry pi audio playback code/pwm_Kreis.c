@@ -1,18 +1,55 @@
 //
 //
+// Draws a circle with the laser: x and y galvo on the two PWM channels, one point per deadline.
+// With --shape it draws any svg/ shape instead: the lookup table of liblaser (laser.h, the one svg_to_wav builds)
+// rendered at the PWM update rate and mapped onto the galvo window of the PWM range.
+//
 // After installing bcm2835, you can build this
 // with something like:
-// gcc -o pwm_Kreis pwm_Kreis.c -l bcm2835 -l m				/* output in pwm_Kreis file, using library bcm2835 and m for math */
+// g++ -O2 --std=c++17 -o pwm_Kreis -x c++ pwm_Kreis.c pwm_backend_bcm2835.c pwm_backend_mock.c ../rt_profile.c ../liblaser.cpp -I.. -l bcm2835 -pthread
 // sudo ./pwm_Kreis
+// Without the Pi (mock backend only, e.g. to test and benchmark the timing on a PC):
+// g++ -O2 --std=c++17 -DPWM_NO_BCM2835 -o pwm_Kreis -x c++ pwm_Kreis.c pwm_backend_mock.c ../rt_profile.c ../liblaser.cpp -I.. -pthread
+// ./pwm_Kreis --mock --seconds=10
+// ./pwm_Kreis --mock --shape=../svg/batman.txt --freq=2 --rate=2000 --seconds=5 --verify
 // link for gcc arguments https://gcc.gnu.org/onlinedocs/gcc/Overall-Options.html#Overall-Options
-// run or to see output: ./pwm_Kreis
-
+// run or to see output: ./pwm_Kreis [pwm_val] [options]
+//   --mock[=<file.csv>]   mock backend (pwm_backend.h) instead of the hardware, optionally logs every write
+//   --write-cost=<ns>     mock: time one write takes (default 0)
+//   --verify              mock: record every point and compare it with the expected stream at the end
+//   --rate=<Hz>           points per second (default 1000, the old usleep(1000) loop)
+//   --steps=<n>           circle: points per circle (default 1000, the old counter += 0.00628 up to 2*pi)
+//   --shape=<file>        points file (svg/*.txt), sine or rect instead of the circle
+//   --freq=<Hz>           shape: drawings per second (default 1)
+//   --full-range          shape: map onto 0 ... RANGE-1 instead of the calibrated RANGE_PWM*_START ... END window
+//   --seconds=<s>         stop after s seconds (default: until Ctrl-C)
+//   --rt[=<cpu>]          lock memory, SCHED_FIFO, pinned to <cpu> (default the first isolated cpu), see rt_profile.h
+//
+// Timing: every point has an absolute deadline, start + point * period on CLOCK_MONOTONIC, and the loop sleeps
+// until it with clock_nanosleep(TIMER_ABSTIME). Computation time and a late wake-up do not move the later
+// deadlines, so the rate does not drift (usleep(1000) after the work added both to every step). The points
+// come in blocks of SCAN_BLOCK: the circle from tables computed once (no sin/cos in the loop), a shape rendered
+// by liblaser a block at a time right after a write, in the slack before the next deadline. A point is one
+// batched update of both PWM data registers (set_pair).
+// When a point (with a block refill) ends after the next deadline, the deadlines that passed are overruns: their
+// points are skipped so the drawing keeps its speed.
+// Maximum point rate: the PWM outputs a new value once per PWM cycle, 19.2 MHz / 8 / RANGE = 2344 per second on
+// the Pi (pwm_backend.h, max_update_rate). A higher --rate is accepted with a Note, the extra points are lost in
+// the hardware. A shape needs about 1000 points per drawing for fine detail, so 2 drawings/s on the Pi.
+// At the end (Ctrl-C or --seconds): points, overruns, the rate reached and histograms of the wake-up lateness
+// (after the deadline) and of the duration of a point (write, and refill when one is due).
+
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <signal.h>
-#include <bcm2835.h>
+#include <time.h>
 #include <unistd.h>
+#include "laser.h"
+#include "pwm_backend.h"
+#include "rt_profile.h"
 
 #define RANGE 1024		// 10bit
 
@@ -33,6 +70,10 @@
 #define RANGE_PWM1_START	400
 #define RANGE_PWM1_END		900
 
+#define DEFAULT_RATE	1000	// steps per second
+#define DEFAULT_STEPS	1000	// steps per circle
+#define SCAN_BLOCK		256		// points per refill
+#define LASER_FULL_SCALE	(LASER_AMP_MULTIPLYER / 2)	// liblaser samples are within +-30000
 
 /*
 			 pi@raspberrypi:~ $ gpio readall
@@ -66,157 +107,348 @@
 
 int pwm_val;
 
+// where the points come from, a block at a time
+typedef struct scan_source
+{
+	void (*next)(struct scan_source *source, uint32_t *x, uint32_t *y, uint32_t count);
+	// circle
+	const uint32_t *table_x, *table_y;
+	uint32_t steps, index;
+	// shape
+	laser_renderer *renderer;
+	int16_t samples_x[SCAN_BLOCK], samples_y[SCAN_BLOCK];
+	uint32_t x_start, x_span, y_start, y_span;	// PWM window
+} scan_source;
+
+typedef struct scan_stats
+{
+	rt_histogram lateness;		// wake-up after the deadline
+	rt_histogram writes;		// a point: its write and the refill when one is due
+	uint64_t points;
+	uint64_t overruns;			// deadlines skipped
+	double seconds;
+} scan_stats;
+
+static volatile sig_atomic_t stop = 0;
 
 // to exit the program ctrl-c need to be pushed
-// this is the ctrl-c handler to clean up and 
-// close the bcm2835 library
+// the loop ends at its next wake-up, then the laser is turned off and the backend closed
 //
 void Ctrl_c_handler(int signo)
 {
-    //System Exit
-    printf("\r\nEntering Ctrl_c_handler() ...\r\n");
-
-	printf("1. Turn Laser OFF\n");
-	bcm2835_gpio_clr(23);
-	printf("2. Close  bcm2835 \n");
-	bcm2835_close();
-    exit(0);
+	(void)signo;
+	stop = 1;
 }
 
-
-
-void my_bcm2835_pwm_set_data(uint8_t channel, uint32_t data)
+static uint64_t now_ns(void)
 {
-	bcm2835_pwm_set_data(channel, data);
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-
-int main(int argc, char** argv)
+// one circle, the PWM values of every step
+static void build_tables(uint32_t *table_x, uint32_t *table_y, uint32_t steps)
 {
-	// route ctrl-c handling to our 
-	// Ctrl_c_handler()
-	//
-    signal(SIGINT, Ctrl_c_handler);
-
-	// startup the bcm2835 library
-	// check: file:///d:/daten/10_Projekte_Idee/Lasergravur/src/bcm2835-1.59/doc/html/index.html
-	//
-	if (!bcm2835_init()) return 1;
-	//printf("bcm init= %d", bcm2835_init());
-
-
-	printf("argc=%i\n",argc);
-	// printf("argv=%s\n",argv[1]);	// 0th argument ./pwm_Kreis
-
-	if(argc>1)
+	int x_range = RANGE_PWM0_END - RANGE_PWM0_START;
+	int y_range = RANGE_PWM1_END - RANGE_PWM1_START;
+	for (uint32_t i = 0; i < steps; i++)
 	{
-		// the first parameter is for the start value of the
-		// second PWM1 signal 0...1024
-		//
-		pwm_val = atoi(argv[1]);
-		printf("valstr=%s\n",argv[1]);
-		printf("val   =%d\n",pwm_val);
+		double counter = 2 * M_PI * i / steps;
+		table_x[i] = (uint32_t)((RANGE_PWM0_START + (x_range/2)) + ((x_range/2) * sin(counter)));
+		table_y[i] = (uint32_t)((RANGE_PWM1_START + (y_range/2)) + ((y_range/2) * cos(counter)));
 	}
-	else
+}
+
+static void next_circle(scan_source *source, uint32_t *x, uint32_t *y, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
 	{
-		pwm_val=300;
+		x[i] = source->table_x[source->index];
+		y[i] = source->table_y[source->index];
+		if (++source->index == source->steps)
+			source->index = 0;
 	}
+}
 
-	// turn laser on
-	//
-	printf("Turn Laser ON\n");
-	bcm2835_gpio_fsel(23,BCM2835_GPIO_FSEL_OUTP);	//BCM23==phy 16
-	usleep(100);
-	bcm2835_gpio_set(23);
-
-	// *****************************************************************
-	// PWM configuration
-	// see: file:///D:/daten/10_Projekte_Idee/Lasergravur/src/bcm2835-1.59/doc/html/group__pwm.html
-	// *****************************************************************
-	
-	// === configure PWM0 on port BCM 18 (see fig above) == phy 12
-	bcm2835_gpio_fsel(18,BCM2835_GPIO_FSEL_INPT);
-	usleep(100);
-	bcm2835_gpio_fsel(18,BCM2835_GPIO_FSEL_ALT5);
-	// ====================================================
-
-	// === configure PWM1 on port BCM 19 (see fig above) == phy 35
-	bcm2835_gpio_fsel(19,BCM2835_GPIO_FSEL_INPT);
-	usleep(100);
-	bcm2835_gpio_fsel(19,BCM2835_GPIO_FSEL_ALT5);
-	// ====================================================
-
-
-	// check: file:///D:/daten/10_Projekte_Idee/Lasergravur/src/bcm2835-1.59/doc/html/group__pwm.html#ga4487f4e26e57ea3697a57cf52b8de35b
-	// see: bcm2835.h
-	// possible value range from 1 ... 2048
-	// measured:
-	//  BCM2835_PWM_CLOCK_DIVIDER_2    9.375kHz  --> PWM_Clock = 18.75kHz
-	//  BCM2835_PWM_CLOCK_DIVIDER_4	   4.688kHz  --> PWM_Clock = 18.75kHz
-	//  BCM2835_PWM_CLOCK_DIVIDER_8	   2.344kHz  --> PWM_Clock = 18.75kHz  <== selected!
-	// BCM2835_PWM_CLOCK_DIVIDER_16	   1.171kHz  --> PWM_Clock = 18.75kHz
-	// BCM2835_PWM_CLOCK_DIVIDER_32      586 Hz  --> PWM_Clock = 18.75kHz
-	//
-	bcm2835_pwm_set_clock(BCM2835_PWM_CLOCK_DIVIDER_8);
+// -LASER_FULL_SCALE ... LASER_FULL_SCALE onto start ... start + span, rounded
+static uint32_t map_sample(int16_t sample, uint32_t start, uint32_t span)
+{
+	int32_t value = sample < -LASER_FULL_SCALE ? -LASER_FULL_SCALE : sample > LASER_FULL_SCALE ? LASER_FULL_SCALE : sample;
+	return start + (uint32_t)(((int64_t)(value + LASER_FULL_SCALE) * span + LASER_FULL_SCALE) / (2 * LASER_FULL_SCALE));
+}
 
+static void next_shape(scan_source *source, uint32_t *x, uint32_t *y, uint32_t count)
+{
+	laser_render_planar(source->renderer, source->samples_x, source->samples_y, count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		x[i] = map_sample(source->samples_x[i], source->x_start, source->x_span);
+		y[i] = map_sample(source->samples_y[i], source->y_start, source->y_span);
+	}
+}
 
-	bcm2835_pwm_set_mode(0, 1, 1);
-	bcm2835_pwm_set_range(0,RANGE);
-	bcm2835_pwm_set_data(0,512);
+// writes point n at start + n * period_ns until stop or total_points (0 = endless)
+static void scan(pwm_backend *backend, scan_source *source, uint64_t period_ns, uint64_t total_points, scan_stats *stats)
+{
+	uint32_t block_x[SCAN_BLOCK], block_y[SCAN_BLOCK], pos = 0;
+	uint64_t start, point = 0;
 
-	bcm2835_pwm_set_mode(1, 1, 1);
-	bcm2835_pwm_set_range(1,RANGE);
-	bcm2835_pwm_set_data(1,512);
-	// *****************************************************************
-	// *****************************************************************
+	source->next(source, block_x, block_y, SCAN_BLOCK);
+	start = now_ns() + period_ns;	// one period to settle before the first deadline
+	while (!stop && (total_points == 0 || point < total_points))
+	{
+		uint64_t deadline = start + point * period_ns;
+		struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL)};
+		if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+			continue;	// EINTR: Ctrl-C, or sleep again
+		uint64_t woke = now_ns();
+		rt_histogram_add(&stats->lateness, woke - deadline);
+
+		backend->set_pair(backend, block_x[pos], block_y[pos]);
+		stats->points++;
+		point++;
+		if (++pos == SCAN_BLOCK)
+		{
+			source->next(source, block_x, block_y, SCAN_BLOCK);
+			pos = 0;
+		}
+		uint64_t done = now_ns();
+		rt_histogram_add(&stats->writes, done - woke);
 
+		// deadlines that passed during this point are not caught up, their points are dropped
+		if (done > start + point * period_ns)
+		{
+			uint64_t passed = (done - start) / period_ns + 1 - point;
+			stats->overruns += passed;
+			point += passed;
+			for (; passed > 0; passed--)
+				if (++pos == SCAN_BLOCK)
+				{
+					source->next(source, block_x, block_y, SCAN_BLOCK);
+					pos = 0;
+				}
+		}
+	}
+	stats->seconds = (now_ns() - start) / 1e9;
+}
 
-	int direction_0=1, direction_1 = 1; // 1 is increase, -1 is decrease
-	// int data_0=128, data_1 = pwm_val;
-	int x_range = RANGE_PWM0_END - RANGE_PWM0_START;
-	int y_range = RANGE_PWM1_END - RANGE_PWM1_START;
+// the recorded points must be the expected stream with the overrun points left out
+static int verify(pwm_backend *backend, scan_source *expected, uint64_t overruns)
+{
+	const uint32_t *x, *y;
+	size_t count = pwm_mock_recorded(backend, &x, &y), i;
+	uint32_t want_x[SCAN_BLOCK], want_y[SCAN_BLOCK], pos = SCAN_BLOCK;
+	uint64_t skipped = 0;
 
-	double counter = 0.0;
-	double counter_end = 2*M_PI;
-	double pwm0, pwm1;
-	
-	// execute 10 full sine waves
-	//
-	int sin_count=10;
-	
-	//while (sin_count>0)
-	while(1)
+	for (i = 0; i < count; i++)
 	{
-		pwm0 = (RANGE_PWM0_START + (x_range/2)) + ((x_range/2) * sin(counter));
-		pwm1 = (RANGE_PWM1_START + (y_range/2)) + ((y_range/2) * cos(counter));
-
+		for (;;)
+		{
+			if (pos == SCAN_BLOCK)
+			{
+				expected->next(expected, want_x, want_y, SCAN_BLOCK);
+				pos = 0;
+			}
+			if (want_x[pos] == x[i] && want_y[pos] == y[i])
+				break;
+			if (++skipped > overruns)
+			{
+				printf("verify: FAILED at point %zu, got %u,%u, expected %u,%u\n", i, x[i], y[i], want_x[pos], want_y[pos]);
+				return -1;
+			}
+			pos++;
+		}
+		pos++;
+	}
+	printf("verify: %zu points as expected, %llu skipped\n", count, (unsigned long long)skipped);
+	return 0;
+}
 
-		//
-		// PWM 0
-		//
-		my_bcm2835_pwm_set_data(0, pwm0);
+int main(int argc, char** argv)
+{
+	pwm_backend backend;
+	scan_stats stats = {RT_HISTOGRAM_INIT, RT_HISTOGRAM_INIT, 0, 0, 0.0};
+	scan_source source, expected;
+	int mock = 0, rt = 0, rt_cpu = -1, check = 0, full_range = 0, retval;
+	const char *mock_log = NULL, *shape_name = NULL;
+	uint32_t write_cost_ns = 0, steps = DEFAULT_STEPS;
+	double rate = DEFAULT_RATE, seconds = 0.0, freq = 1.0;
+	laser_shape *shape = NULL;
+	laser_lut *lut = NULL;
+	uint32_t *table_x = NULL, *table_y = NULL;
+
+	// route ctrl-c handling to our
+	// Ctrl_c_handler()
+	//
+	signal(SIGINT, Ctrl_c_handler);
+	signal(SIGTERM, Ctrl_c_handler);
 
-		//
-		// PWM 1
-		//
-		my_bcm2835_pwm_set_data(1, pwm1);
+	printf("argc=%i\n",argc);
+	pwm_val = 300;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--mock", 6) == 0)
+		{
+			mock = 1;
+			mock_log = argv[i][6] == '=' ? argv[i] + 7 : NULL;
+		}
+		else if (strncmp(argv[i], "--write-cost=", 13) == 0)
+			write_cost_ns = (uint32_t)strtoul(argv[i] + 13, NULL, 10);
+		else if (strcmp(argv[i], "--verify") == 0)
+			check = 1;
+		else if (strncmp(argv[i], "--rate=", 7) == 0)
+			rate = atof(argv[i] + 7);
+		else if (strncmp(argv[i], "--steps=", 8) == 0)
+			steps = (uint32_t)strtoul(argv[i] + 8, NULL, 10);
+		else if (strncmp(argv[i], "--shape=", 8) == 0)
+			shape_name = argv[i] + 8;
+		else if (strncmp(argv[i], "--freq=", 7) == 0)
+			freq = atof(argv[i] + 7);
+		else if (strcmp(argv[i], "--full-range") == 0)
+			full_range = 1;
+		else if (strncmp(argv[i], "--seconds=", 10) == 0)
+			seconds = atof(argv[i] + 10);
+		else if (strncmp(argv[i], "--rt", 4) == 0)
+		{
+			rt = 1;
+			rt_cpu = argv[i][4] == '=' ? atoi(argv[i] + 5) : rt_default_cpu();
+		}
+		else if (strncmp(argv[i], "--", 2) == 0)
+		{
+			printf("Invalid argument: unknown option %s\n", argv[i]);
+			return 1;
+		}
+		else
+		{
+			// the first parameter is for the start value of the
+			// second PWM1 signal 0...1024
+			//
+			pwm_val = atoi(argv[i]);
+			printf("valstr=%s\n",argv[i]);
+			printf("val   =%d\n",pwm_val);
+		}
+	}
+	if (!(rate > 0.0) || steps == 0 || !(freq > 0.0) || seconds < 0.0)
+	{
+		printf("Invalid argument: --rate, --steps and --freq must be larger than 0\n");
+		return 1;
+	}
 
+#ifdef PWM_NO_BCM2835
+	if (!mock)
+		printf("Note: built without bcm2835, using the mock backend\n");
+	mock = 1;
+#endif
+	if (check && !mock)
+	{
+		printf("Invalid argument: --verify needs the mock backend\n");
+		return 1;
+	}
+	if (mock)
+		pwm_backend_mock(&backend, mock_log, write_cost_ns);
+#ifndef PWM_NO_BCM2835
+	else
+		pwm_backend_bcm2835(&backend);
+#endif
 
-		counter += 0.00628;
-		
-		if(counter > counter_end)
+	// the points: circle tables computed once (no sin/cos in the loop), or the lookup table of a shape
+	memset(&source, 0, sizeof(source));
+	if (shape_name)
+	{
+		int wave = strcmp(shape_name, "sine") == 0 ? LASER_WAVE_SINE : strcmp(shape_name, "rect") == 0 ? LASER_WAVE_RECTANGLE : LASER_WAVE_INPUT;
+		if ((wave == LASER_WAVE_INPUT && (retval = laser_shape_load(shape_name, &shape)) != LASER_OK) ||
+			(retval = laser_lut_build(shape, wave, 0, &lut)) != LASER_OK ||
+			(retval = laser_renderer_create(lut, (float)freq, (int)(rate + 0.5), 0, &source.renderer)) != LASER_OK)
+		{
+			printf("Input Error: %s: %s\n", shape_name, laser_strerror(retval));
+			return 1;
+		}
+		source.next = next_shape;
+		source.x_start = full_range ? 0 : RANGE_PWM0_START;
+		source.x_span = full_range ? RANGE - 1 : RANGE_PWM0_END - RANGE_PWM0_START;
+		source.y_start = full_range ? 0 : RANGE_PWM1_START;
+		source.y_span = full_range ? RANGE - 1 : RANGE_PWM1_END - RANGE_PWM1_START;
+		printf("shape: %s, lut size %u, %.1f points per drawing\n", shape_name, laser_lut_size(lut), rate / freq);
+	}
+	else
+	{
+		table_x = (uint32_t *)malloc(steps * sizeof(uint32_t));
+		table_y = (uint32_t *)malloc(steps * sizeof(uint32_t));
+		if (!table_x || !table_y)
+		{
+			printf("ERROR: no memory for %u steps\n", steps);
+			return 1;
+		}
+		build_tables(table_x, table_y, steps);
+		source.next = next_circle;
+		source.table_x = table_x;
+		source.table_y = table_y;
+		source.steps = steps;
+	}
+	expected = source;
+	if (check)
+	{
+		// a second renderer from the same lut gives the stream again
+		if (shape_name && laser_renderer_create(lut, (float)freq, (int)(rate + 0.5), 0, &expected.renderer) != LASER_OK)
+			return 1;
+		if (pwm_mock_record(&backend, seconds > 0.0 ? (size_t)(seconds * rate + 0.5) : (size_t)(600 * rate)) != 0)
 		{
-			counter=0;
-			sin_count--;
+			printf("ERROR: no memory to record the points\n");
+			return 1;
 		}
+	}
 
-		// suspend for x microseconds  1 microsec = 10^-6 -> 0,000001 sec
-		// 1000 -> 1ms
-		usleep(1000); 
+	if (rt)
+	{
+		if (rt_lock_memory(stdout) == 0)
+			printf("memory locked\n");
+		if (table_x)
+		{
+			rt_prefault(table_x, steps * sizeof(uint32_t));
+			rt_prefault(table_y, steps * sizeof(uint32_t));
+		}
+		if (rt_cpu < 0)
+			printf("Note: no isolated cpu (isolcpus=), not pinned\n");
+		rt_enter_thread(RT_DEFAULT_PRIORITY, rt_cpu, stdout);
+		rt_prefault_stack();
 	}
 
+	if (backend.init(&backend, RANGE) != 0)
+		return 1;
+	if (backend.max_update_rate > 0.0 && rate > backend.max_update_rate)
+		printf("Note: %.0f points/s, the PWM outputs at most %.0f, the rest is lost\n", rate, backend.max_update_rate);
 
-	bcm2835_gpio_clr(23);
-	bcm2835_close();
-	return (EXIT_SUCCESS);
+	// turn laser on
+	//
+	printf("Turn Laser ON\n");
+	backend.laser(&backend, 1);
+
+	uint64_t period_ns = (uint64_t)(1e9 / rate + 0.5);
+	printf("backend: %s, %.1f points/s (%llu ns)", backend.name, rate, (unsigned long long)period_ns);
+	if (shape_name)
+		printf(", %.3f drawings/s\n", freq);
+	else
+		printf(", %u steps per circle, %.3f circles/s\n", steps, rate / steps);
+	scan(&backend, &source, period_ns, (uint64_t)(seconds * rate + 0.5), &stats);
+
+	printf("\r\npoints: %llu in %.3f s = %.1f points/s, overruns: %llu\n", (unsigned long long)stats.points, stats.seconds,
+		   stats.seconds > 0 ? stats.points / stats.seconds : 0.0, (unsigned long long)stats.overruns);
+	rt_histogram_print(&stats.lateness, "wake-up lateness", stdout);
+	rt_histogram_print(&stats.writes, "point (write + refill)", stdout);
+	if (mock)
+		printf("mock writes: %llu, last x %u, y %u\n", (unsigned long long)pwm_mock_writes(&backend),
+			   pwm_mock_last(&backend, 0), pwm_mock_last(&backend, 1));
+	retval = check ? verify(&backend, &expected, stats.overruns) : 0;
+
+	printf("Turn Laser OFF, close %s\n", backend.name);
+	backend.close(&backend);
+	if (expected.renderer != source.renderer)
+		laser_renderer_free(expected.renderer);
+	laser_renderer_free(source.renderer);
+	laser_lut_free(lut);
+	laser_shape_free(shape);
+	free(table_x);
+	free(table_y);
+	return retval == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,56 @@
+// Hardware interface of the PWM scanner (pwm_Kreis.c): the two PWM channels (x, y galvo) and the laser GPIO.
+// The timing engine only calls through this struct, so it runs unchanged on the Pi (bcm2835 backend) and on any
+// Linux box (mock backend) for testing and benchmarking.
+//
+// backends:
+//   pwm_backend_bcm2835   registers through the bcm2835 library, needs root, link with -l bcm2835
+//                         (pwm_backend_bcm2835.c, left out of the build with -DPWM_NO_BCM2835)
+//   pwm_backend_mock      no hardware: counts the writes, keeps the last value per channel, optionally logs every
+//                         write as "<ns since init>,<channel>,<value>" to a csv file, records the emitted x,y pairs
+//                         in memory for verification (pwm_mock_record) and burns a given time per write to stand
+//                         in for the register/bus access (pwm_backend_mock.c)
+//
+// use:
+//   pwm_backend backend;
+//   pwm_backend_mock(&backend, "writes.csv", 0);       // or pwm_backend_bcm2835(&backend)
+//   if (backend.init(&backend, 1024) != 0) ...          // range: PWM counts per cycle
+//   backend.laser(&backend, 1);
+//   backend.set_data(&backend, 0, 512);                 // channel 0 = x, 1 = y
+//   backend.set_pair(&backend, 512, 512);               // both channels in one batched update, one point
+//   backend.close(&backend);                            // laser off, hardware released
+//
+// max_update_rate (set by init): PWM cycles per second, a new value is only output at the next cycle, so more
+// points per second than this are lost in the hardware. bcm2835: 19.2 MHz / clock divider / range,
+// 2344 Hz with divider 8 and range 1024. 0 = no limit (mock)
+
+#ifndef PWM_BACKEND_H
+#define PWM_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PWM_CHANNELS 2
+
+typedef struct pwm_backend
+{
+	const char *name;
+	int  (*init)(struct pwm_backend *backend, uint32_t range);		// 0 or -1
+	void (*set_data)(struct pwm_backend *backend, uint8_t channel, uint32_t data);
+	void (*set_pair)(struct pwm_backend *backend, uint32_t x, uint32_t y);		// channel 0 and 1
+	void (*laser)(struct pwm_backend *backend, int on);
+	void (*close)(struct pwm_backend *backend);
+	double max_update_rate;											// points/s, 0 = no limit
+	void *state;													// of the backend
+} pwm_backend;
+
+void pwm_backend_bcm2835(pwm_backend *backend);
+// log_file NULL: no log, write_cost_ns: busy time per set_data
+void pwm_backend_mock(pwm_backend *backend, const char *log_file, uint32_t write_cost_ns);
+// mock only: writes so far and the last value of a channel
+uint64_t pwm_mock_writes(const pwm_backend *backend);
+uint32_t pwm_mock_last(const pwm_backend *backend, uint8_t channel);
+// mock only: keep the first capacity set_pair points (before init), then read them back
+int pwm_mock_record(pwm_backend *backend, size_t capacity);
+size_t pwm_mock_recorded(const pwm_backend *backend, const uint32_t **x, const uint32_t **y);
+
+#endif
@@ -0,0 +1,105 @@
+// bcm2835 PWM backend, see pwm_backend.h. The register access of pwm_Kreis.c:
+// PWM0 on BCM 18 (phy 12) = x-axis, PWM1 on BCM 19 (phy 35) = y-axis, laser ON/OFF on BCM 23 (phy 16).
+// After installing bcm2835: gcc -O2 -c pwm_backend_bcm2835.c, link with -l bcm2835, run as root
+
+#include <stdio.h>
+#include <unistd.h>
+#include <bcm2835.h>
+#include "pwm_backend.h"
+
+#define PIN_PWM0	18
+#define PIN_PWM1	19
+#define PIN_LASER	23
+#define PWM_CLOCK_HZ	19200000.0	// oscillator in front of the PWM clock divider
+#define PWM_DIVIDER		BCM2835_PWM_CLOCK_DIVIDER_8
+
+static int bcm_init(pwm_backend *backend, uint32_t range)
+{
+	// startup the bcm2835 library
+	// check: file:///d:/daten/10_Projekte_Idee/Lasergravur/src/bcm2835-1.59/doc/html/index.html
+	//
+	if (!bcm2835_init())
+	{
+		printf("ERROR: bcm2835_init failed (run as root)\n");
+		return -1;
+	}
+	bcm2835_gpio_fsel(PIN_LASER, BCM2835_GPIO_FSEL_OUTP);	//BCM23==phy 16
+
+	// *****************************************************************
+	// PWM configuration
+	// see: file:///D:/daten/10_Projekte_Idee/Lasergravur/src/bcm2835-1.59/doc/html/group__pwm.html
+	// *****************************************************************
+
+	// === configure PWM0 on port BCM 18 == phy 12
+	bcm2835_gpio_fsel(PIN_PWM0, BCM2835_GPIO_FSEL_INPT);
+	usleep(100);
+	bcm2835_gpio_fsel(PIN_PWM0, BCM2835_GPIO_FSEL_ALT5);
+
+	// === configure PWM1 on port BCM 19 == phy 35
+	bcm2835_gpio_fsel(PIN_PWM1, BCM2835_GPIO_FSEL_INPT);
+	usleep(100);
+	bcm2835_gpio_fsel(PIN_PWM1, BCM2835_GPIO_FSEL_ALT5);
+
+	// possible value range from 1 ... 2048
+	// measured:
+	//  BCM2835_PWM_CLOCK_DIVIDER_2    9.375kHz  --> PWM_Clock = 18.75kHz
+	//  BCM2835_PWM_CLOCK_DIVIDER_4	   4.688kHz  --> PWM_Clock = 18.75kHz
+	//  BCM2835_PWM_CLOCK_DIVIDER_8	   2.344kHz  --> PWM_Clock = 18.75kHz  <== selected!
+	// BCM2835_PWM_CLOCK_DIVIDER_16	   1.171kHz  --> PWM_Clock = 18.75kHz
+	// BCM2835_PWM_CLOCK_DIVIDER_32      586 Hz  --> PWM_Clock = 18.75kHz
+	//
+	bcm2835_pwm_set_clock(PWM_DIVIDER);
+	backend->max_update_rate = PWM_CLOCK_HZ / PWM_DIVIDER / range;
+
+	bcm2835_pwm_set_mode(0, 1, 1);
+	bcm2835_pwm_set_range(0, range);
+	bcm2835_pwm_set_data(0, range / 2);
+
+	bcm2835_pwm_set_mode(1, 1, 1);
+	bcm2835_pwm_set_range(1, range);
+	bcm2835_pwm_set_data(1, range / 2);
+	return 0;
+}
+
+static void bcm_set_data(pwm_backend *backend, uint8_t channel, uint32_t data)
+{
+	(void)backend;
+	bcm2835_pwm_set_data(channel, data);
+}
+
+// both data registers back to back, one memory barrier before and after instead of one around each write
+static void bcm_set_pair(pwm_backend *backend, uint32_t x, uint32_t y)
+{
+	(void)backend;
+	__sync_synchronize();
+	bcm2835_peri_write_nb(bcm2835_pwm + BCM2835_PWM0_DATA, x);
+	bcm2835_peri_write_nb(bcm2835_pwm + BCM2835_PWM1_DATA, y);
+	__sync_synchronize();
+}
+
+static void bcm_laser(pwm_backend *backend, int on)
+{
+	(void)backend;
+	if (on)
+		bcm2835_gpio_set(PIN_LASER);
+	else
+		bcm2835_gpio_clr(PIN_LASER);
+}
+
+static void bcm_close(pwm_backend *backend)
+{
+	bcm_laser(backend, 0);
+	bcm2835_close();
+}
+
+void pwm_backend_bcm2835(pwm_backend *backend)
+{
+	backend->name = "bcm2835";
+	backend->init = bcm_init;
+	backend->set_data = bcm_set_data;
+	backend->set_pair = bcm_set_pair;
+	backend->laser = bcm_laser;
+	backend->close = bcm_close;
+	backend->max_update_rate = 0.0;	// known after init
+	backend->state = NULL;
+}
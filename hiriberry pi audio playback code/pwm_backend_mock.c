@@ -0,0 +1,128 @@
+// Mock PWM backend, see pwm_backend.h. No hardware, builds on any Linux box:
+// gcc -O2 -c pwm_backend_mock.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pwm_backend.h"
+
+typedef struct mock_state
+{
+	const char *log_file;
+	FILE *log;
+	uint32_t write_cost_ns;
+	uint64_t writes;
+	uint32_t last[PWM_CHANNELS];
+	uint64_t start_ns;
+	uint32_t *record_x, *record_y;		// set_pair points
+	size_t record_capacity, recorded;
+} mock_state;
+
+static uint64_t mock_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int mock_init(pwm_backend *backend, uint32_t range)
+{
+	mock_state *state = (mock_state *)backend->state;
+	if (state->log_file && !(state->log = fopen(state->log_file, "w")))
+	{
+		printf("ERROR: Can't open %s\n", state->log_file);
+		return -1;
+	}
+	state->start_ns = mock_now_ns();
+	backend->max_update_rate = 0.0;
+	printf("mock PWM: range %u%s%s\n", range, state->log ? ", log " : "", state->log ? state->log_file : "");
+	return 0;
+}
+
+static void mock_set_data(pwm_backend *backend, uint8_t channel, uint32_t data)
+{
+	mock_state *state = (mock_state *)backend->state;
+	uint64_t now = mock_now_ns();
+
+	state->writes++;
+	if (channel < PWM_CHANNELS)
+		state->last[channel] = data;
+	if (state->log)
+		fprintf(state->log, "%llu,%u,%u\n", (unsigned long long)(now - state->start_ns), channel, data);
+	// stand in for the register write
+	while (state->write_cost_ns && mock_now_ns() - now < state->write_cost_ns)
+		;
+}
+
+static void mock_set_pair(pwm_backend *backend, uint32_t x, uint32_t y)
+{
+	mock_state *state = (mock_state *)backend->state;
+	if (state->recorded < state->record_capacity)
+	{
+		state->record_x[state->recorded] = x;
+		state->record_y[state->recorded++] = y;
+	}
+	mock_set_data(backend, 0, x);
+	mock_set_data(backend, 1, y);
+}
+
+static void mock_laser(pwm_backend *backend, int on)
+{
+	(void)backend;
+	printf("mock laser %s\n", on ? "ON" : "OFF");
+}
+
+static void mock_close(pwm_backend *backend)
+{
+	mock_state *state = (mock_state *)backend->state;
+	if (state->log)
+		fclose(state->log);
+	free(state->record_x);
+	free(state->record_y);
+	free(state);
+	backend->state = NULL;
+}
+
+void pwm_backend_mock(pwm_backend *backend, const char *log_file, uint32_t write_cost_ns)
+{
+	mock_state *state = (mock_state *)calloc(1, sizeof(mock_state));
+	state->log_file = log_file;
+	state->write_cost_ns = write_cost_ns;
+	backend->name = "mock";
+	backend->init = mock_init;
+	backend->set_data = mock_set_data;
+	backend->set_pair = mock_set_pair;
+	backend->laser = mock_laser;
+	backend->close = mock_close;
+	backend->max_update_rate = 0.0;
+	backend->state = state;
+}
+
+uint64_t pwm_mock_writes(const pwm_backend *backend)
+{
+	return ((const mock_state *)backend->state)->writes;
+}
+
+uint32_t pwm_mock_last(const pwm_backend *backend, uint8_t channel)
+{
+	return channel < PWM_CHANNELS ? ((const mock_state *)backend->state)->last[channel] : 0;
+}
+
+int pwm_mock_record(pwm_backend *backend, size_t capacity)
+{
+	mock_state *state = (mock_state *)backend->state;
+	state->record_x = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+	state->record_y = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+	if (!state->record_x || !state->record_y)
+		return -1;
+	state->record_capacity = capacity;
+	return 0;
+}
+
+size_t pwm_mock_recorded(const pwm_backend *backend, const uint32_t **x, const uint32_t **y)
+{
+	const mock_state *state = (const mock_state *)backend->state;
+	*x = state->record_x;
+	*y = state->record_y;
+	return state->recorded;
+}
@@ -0,0 +1,190 @@
+/*H**********************************************************************
+* FILENAME :        kd_tree.hpp
+*
+* DESCRIPTION :
+*       Static 2-d tree over a set of (x, y) coordinates. Used for nearest neighbour
+*       queries on stroke endpoints and shape points
+*
+* PUBLIC FUNCTIONS :
+*   kd_tree(const std::vector<double> &xs, const std::vector<double> &ys)
+*   int nearest(double qx, double qy)                              nearest point that was not removed, -1 if none left
+*   void k_nearest(double qx, double qy, int k, std::vector<int> &result)   k nearest points, closest first
+*   void remove(int id)                                             exclude point id from nearest()
+*
+Note:
+    The tree is stored implicitly in one index array. The subtree of the index range [lo, hi) has its root at
+    mid = (lo + hi) / 2 and splits on x for even depth and on y for odd depth, so no node structs are needed.
+    The number of points still alive in each subtree is kept at the root index of that subtree, this lets
+    nearest() skip subtrees whose points were all removed (greedy nearest neighbour walks stay O(n log n)).
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef KD_TREE_HPP
+#define KD_TREE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+class kd_tree{
+    public:
+        kd_tree(const std::vector<double> &xs, const std::vector<double> &ys);
+        int nearest(double qx, double qy);
+        void k_nearest(double qx, double qy, int k, std::vector<int> &result);
+        void remove(int id);
+        int size(){ return (int)order.size(); }
+    private:
+        void build(int lo, int hi, int depth);
+        void search_nearest(int lo, int hi, int depth, double qx, double qy, int &best, double &best_dist);
+        void search_k(int lo, int hi, int depth, double qx, double qy, int k,
+                      std::vector<std::pair<double, int>> &heap);
+        void remove_from(int id);
+        double coordinate(int id, int depth){ return (depth & 1) ? y[id] : x[id]; }
+        double dist2(int id, double qx, double qy){
+            double dx = x[id] - qx, dy = y[id] - qy;
+            return dx * dx + dy * dy;
+        }
+
+        const std::vector<double> &x, &y;
+        std::vector<int> order;     // point ids in tree order
+        std::vector<int> alive;     // alive points in the subtree rooted at this slot of order
+        std::vector<int> slot;      // position of each point id in order
+        std::vector<char> removed;
+};
+
+inline kd_tree::kd_tree(const std::vector<double> &xs, const std::vector<double> &ys) : x(xs), y(ys)
+{
+    int n = (int)xs.size();
+    order.resize(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    alive.assign(n, 0);
+    slot.assign(n, 0);
+    removed.assign(n, 0);
+    build(0, n, 0);
+}
+
+inline void kd_tree::build(int lo, int hi, int depth)
+{
+    if (lo >= hi)
+        return;
+    int mid = (lo + hi) / 2;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [this, depth](int a, int b){ return coordinate(a, depth) < coordinate(b, depth); });
+    alive[mid] = hi - lo;
+    slot[order[mid]] = mid;
+    build(lo, mid, depth + 1);
+    build(mid + 1, hi, depth + 1);
+}
+
+inline int kd_tree::nearest(double qx, double qy)
+{
+    int best = -1;
+    double best_dist = std::numeric_limits<double>::max();
+    search_nearest(0, (int)order.size(), 0, qx, qy, best, best_dist);
+    return best;
+}
+
+inline void kd_tree::search_nearest(int lo, int hi, int depth, double qx, double qy, int &best, double &best_dist)
+{
+    if (lo >= hi)
+        return;
+    int mid = (lo + hi) / 2;
+    if (alive[mid] == 0)    // every point below was removed
+        return;
+
+    int id = order[mid];
+    if (!removed[id])
+    {
+        double d = dist2(id, qx, qy);
+        if (d < best_dist)
+        {
+            best_dist = d;
+            best = id;
+        }
+    }
+
+    double diff = ((depth & 1) ? qy : qx) - coordinate(id, depth);
+    if (diff < 0)   // query lies on the low side, search it first
+    {
+        search_nearest(lo, mid, depth + 1, qx, qy, best, best_dist);
+        if (diff * diff < best_dist)
+            search_nearest(mid + 1, hi, depth + 1, qx, qy, best, best_dist);
+    }
+    else
+    {
+        search_nearest(mid + 1, hi, depth + 1, qx, qy, best, best_dist);
+        if (diff * diff < best_dist)
+            search_nearest(lo, mid, depth + 1, qx, qy, best, best_dist);
+    }
+}
+
+inline void kd_tree::k_nearest(double qx, double qy, int k, std::vector<int> &result)
+{
+    std::vector<std::pair<double, int>> heap;   // max heap on distance, holds the best k found so far
+    heap.reserve(k + 1);
+    result.clear();
+    if (k <= 0)
+        return;
+    search_k(0, (int)order.size(), 0, qx, qy, k, heap);
+    std::sort_heap(heap.begin(), heap.end());
+    for (auto &element: heap)
+        result.push_back(element.second);
+}
+
+inline void kd_tree::search_k(int lo, int hi, int depth, double qx, double qy, int k,
+                              std::vector<std::pair<double, int>> &heap)
+{
+    if (lo >= hi)
+        return;
+    int mid = (lo + hi) / 2;
+    int id = order[mid];
+    double d = dist2(id, qx, qy);
+    if ((int)heap.size() < k)
+    {
+        heap.push_back(std::make_pair(d, id));
+        std::push_heap(heap.begin(), heap.end());
+    }
+    else if (d < heap.front().first)
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = std::make_pair(d, id);
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    double diff = ((depth & 1) ? qy : qx) - coordinate(id, depth);
+    int near_lo = diff < 0 ? lo : mid + 1, near_hi = diff < 0 ? mid : hi;
+    int far_lo = diff < 0 ? mid + 1 : lo, far_hi = diff < 0 ? hi : mid;
+    search_k(near_lo, near_hi, depth + 1, qx, qy, k, heap);
+    if ((int)heap.size() < k || diff * diff < heap.front().first)
+        search_k(far_lo, far_hi, depth + 1, qx, qy, k, heap);
+}
+
+inline void kd_tree::remove(int id)
+{
+    if (id < 0 || id >= (int)order.size() || removed[id])
+        return;
+    removed[id] = 1;
+    remove_from(id);
+}
+
+// walks from the root down to the slot of id and decrements the alive count of every subtree on the way
+inline void kd_tree::remove_from(int id)
+{
+    int lo = 0, hi = (int)order.size(), target = slot[id];
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        alive[mid]--;
+        if (target == mid)
+            break;
+        if (target < mid)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+}
+
+#endif
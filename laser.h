@@ -0,0 +1,117 @@
+/*H**********************************************************************
+* FILENAME :        laser.h
+*
+* DESCRIPTION :
+*       C interface of liblaser: load a points file, build the lookup table and render frames of the laser
+*       signal into a caller buffer or a wav file in process, the same signal svg_to_wav writes. Usable from C
+*       (the ALSA players) and C++.
+*
+* PUBLIC FUNCTIONS :
+*   int laser_shape_load(const char *points_file, laser_shape **shape)
+*   int laser_shape_from_points(const double *xy, size_t num_points, int canvas_height, int canvas_width, laser_shape **shape)
+*   size_t laser_shape_points(const laser_shape *shape)
+*   void laser_shape_free(laser_shape *shape)
+*   int laser_lut_build(const laser_shape *shape, int wave, uint32_t max_lut_size, laser_lut **lut)
+*   uint32_t laser_lut_size(const laser_lut *lut)
+*   void laser_lut_free(laser_lut *lut)
+*   int laser_renderer_create(const laser_lut *lut, float freq, int sampling_rate, unsigned flags, laser_renderer **renderer)
+*   int laser_render(laser_renderer *renderer, int16_t *frames, size_t num_frames)
+*   int laser_render_planar(laser_renderer *renderer, int16_t *x, int16_t *y, size_t num_frames)
+*   int laser_render_to_cycle_end(laser_renderer *renderer, int16_t *frames, size_t num_frames, size_t *rendered, int *cycle_end)
+*   int laser_renderer_set_freq(laser_renderer *renderer, float freq)
+*   void laser_renderer_reset(laser_renderer *renderer)
+*   int laser_renderer_rewind(laser_renderer *renderer, size_t num_frames)
+*   void laser_renderer_free(laser_renderer *renderer)
+*   int laser_write_wav(laser_renderer *renderer, const char *wav_file, size_t num_frames)
+*   const char *laser_strerror(int error)
+*
+How to use:
+    laser_shape *shape;  laser_lut *lut;  laser_renderer *renderer;
+    laser_shape_load("svg/batman.txt", &shape);                     // points rescaled to the output range
+    laser_lut_build(shape, LASER_WAVE_INPUT, 0, &lut);              // 0 = LASER_DEFAULT_LUT_SIZE
+    laser_renderer_create(lut, 0.1f, 48000, LASER_RENDER_TRIGGER, &renderer);
+    laser_render(renderer, buffer, 4096);                           // 4096 interleaved x,y frames, call again for the next
+    laser_write_wav(renderer, "batman.wav", 10 * 48000);            // or render straight into a wav file
+    laser_renderer_free(renderer);  laser_lut_free(lut);  laser_shape_free(shape);
+
+Note:
+    -- every int returning function gives LASER_OK (0) or a negative LASER_ERR_* code, see laser_strerror
+    -- a frame is one sample per channel, x left and y right. laser_render writes interleaved x,y
+    -- a lut is read only after laser_lut_build: several renderers (threads) may share one. A renderer keeps a
+       pointer to its lut, free the lut after the renderers. A renderer must only be used by one thread at a time.
+    -- renderers continue the phase across calls, so a stream of short laser_render calls gives exactly the
+       samples of one long call (and of svg_to_wav with the same arguments)
+    -- laser_render_to_cycle_end renders like laser_render but stops after the last frame of the current cycle
+       (*cycle_end = 1), the point where a player can switch to another renderer without cutting a trace
+    -- laser_renderer_set_freq changes the speed from the next rendered frame on, the phase continues (no jump)
+    -- laser_renderer_rewind steps the phase back by num_frames at the current speed, for a player that drops the
+       frames it rendered ahead and renders them again (other freq). Equal to the rendered phase up to float rounding
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef LASER_H
+#define LASER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LASER_DEFAULT_LUT_SIZE 480000   /* lookup table size svg_to_wav starts with */
+#define LASER_AMP_MULTIPLYER 60000      /* rescaled points are in [-30000, 30000] */
+
+/* error codes */
+#define LASER_OK 0
+#define LASER_ERR_ARG -1        /* invalid argument */
+#define LASER_ERR_OPEN -2       /* file can not be opened */
+#define LASER_ERR_FORMAT -3     /* invalid points file */
+#define LASER_ERR_MEMORY -4     /* out of memory */
+#define LASER_ERR_WRITE -5      /* writing the wav file failed */
+
+/* waves, same values as svg_to_wav */
+#define LASER_WAVE_RECTANGLE 0
+#define LASER_WAVE_SINE 1
+#define LASER_WAVE_INPUT 3      /* shape from a points file */
+
+/* renderer flags */
+#define LASER_RENDER_TRIGGER 1  /* first 100 frames of an input shape are the oscilloscope trigger pulse */
+
+typedef struct laser_shape laser_shape;
+typedef struct laser_lut laser_lut;
+typedef struct laser_renderer laser_renderer;
+
+/* shape: points rescaled with the canvas size of the file (height|width line, 400|400 if missing) */
+int laser_shape_load(const char *points_file, laser_shape **shape);
+int laser_shape_from_points(const double *xy, size_t num_points, int canvas_height, int canvas_width, laser_shape **shape);
+size_t laser_shape_points(const laser_shape *shape);
+void laser_shape_free(laser_shape *shape);
+
+/* lookup table: LASER_WAVE_INPUT needs a shape, sine/rectangle take their size from the shape if given,
+   else max_lut_size. max_lut_size 0 = LASER_DEFAULT_LUT_SIZE, the table grows if the shape needs more */
+int laser_lut_build(const laser_shape *shape, int wave, uint32_t max_lut_size, laser_lut **lut);
+uint32_t laser_lut_size(const laser_lut *lut);
+void laser_lut_free(laser_lut *lut);
+
+/* renderer: freq cycles of the lut per second */
+int laser_renderer_create(const laser_lut *lut, float freq, int sampling_rate, unsigned flags, laser_renderer **renderer);
+int laser_render(laser_renderer *renderer, int16_t *frames, size_t num_frames);
+int laser_render_planar(laser_renderer *renderer, int16_t *x, int16_t *y, size_t num_frames);
+int laser_render_to_cycle_end(laser_renderer *renderer, int16_t *frames, size_t num_frames, size_t *rendered, int *cycle_end);
+int laser_renderer_set_freq(laser_renderer *renderer, float freq);
+void laser_renderer_reset(laser_renderer *renderer);
+int laser_renderer_rewind(laser_renderer *renderer, size_t num_frames);
+void laser_renderer_free(laser_renderer *renderer);
+
+/* 16 bit stereo wav with the next num_frames frames of the renderer */
+int laser_write_wav(laser_renderer *renderer, const char *wav_file, size_t num_frames);
+
+const char *laser_strerror(int error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,369 @@
+/*H**********************************************************************
+* FILENAME :        laser_bench.cpp
+*
+* DESCRIPTION :
+*       Benchmarks every stage of the svg_to_wav pipeline and add_dim_to_points on synthetic point files of
+*       1k up to 10M points and writes the results as json, so that regressions can be tracked across builds
+*
+* PUBLIC FUNCTIONS :
+*   void generate_fixture(std::string file, long num_points, bool with_dimensions, bool short_strokes = false)
+*   bench_result run_stage(std::string stage, long points, long items, Setup setup, Run run)
+*
+Stages (in pipeline order):
+    load_image_params, rescale_point, optimize_stroke_order, optimize_stroke_short (optimize_stroke_order on a
+    fixture of dashes of 2 to 4 points, a third as many strokes as points: 333k strokes at 1M points), decimate_tolerance, decimate_budget,
+    decimate_zigzag (decimate_tolerance on BENCH_ZIGZAG_POINTS points of a zigzag of growing amplitude, the
+    input that makes plain Ramer-Douglas-Peucker quadratic, run once independent of --sizes),
+    create_lut (lut build of create_sample_buffer), build_trajectory, synthesize_samples, galvo_filter,
+    write_wav (wav serialization to a file), process_file (add_dim_to_points)
+
+How to build:
+    g++ -O2 --std=c++17 laser_bench.cpp -o laser_bench
+    (svg_to_wav.cpp and add_dim_to_points.cpp are included, their main functions are left out)
+
+How to call:
+    1  ./laser_bench                        all stages for 1k, 10k, 100k and 1M points, json to stdout
+    2  ./laser_bench --sizes=1000,10000000 --stages=create_lut,synthesize_samples --out=bench.json
+    3  ./laser_bench --gen=<points> <file>  only write a fixture file with <points> points
+    options:
+        --sizes=<n,n,..>        number of points of the fixtures, 1000 ... 10000000
+        --stages=<name,..>      run only these stages
+        --out=<file>            write json to file instead of stdout
+        --dir=<path>            directory for fixtures and the wav output (default bench_fixtures)
+        --min-time=<seconds>    repeat every stage at least this long (default 0.2)
+
+Fixtures have the format of svg/batman.txt: height|width in the first line, x,y points, # in the last line.
+The points form arcs of 250 points each at random (fixed seed) places on a 10000|10000 canvas, i.e. many
+disjoint strokes like PathToPoints output of a font. The short stroke fixture (fixture_<n>_short.txt) has dashes
+of 2 to 4 points 0.5 apart instead, the scale the k-d tree stroke ordering is meant for.
+
+Json output:
+    {"benchmark": "laser_bench", "compiler": ..., "optimized": true, "timestamp": ..., "results": [
+        {"stage": "load_image_params", "points": 1000, "items": 1000, "reps": 120, "min_ns": ..., "mean_ns": ...,
+         "items_per_sec": ...}, ...]}
+    items are points for the point stages, lut entries for create_lut/build_trajectory, samples for
+    synthesize_samples/galvo_filter/write_wav. items_per_sec is computed from the fastest rep.
+
+START DATE : 18 Oct 2026
+
+*H*/
+#define SVG_TO_WAV_NO_MAIN
+#include "svg_to_wav.cpp"
+#define ADD_DIM_NO_MAIN
+#include "add_dim_to_points.cpp"
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <random>
+
+const int BENCH_STROKE_POINTS = 250;    // points per arc in a fixture
+const int BENCH_SHORT_STROKE_MIN = 2;   // points per dash in a short stroke fixture, uniform in min ... max
+const int BENCH_SHORT_STROKE_MAX = 4;
+const int BENCH_SECONDS = 10;           // length of the synthesized signal
+const int BENCH_SAMPLING_RATE = 48000;
+const float BENCH_FREQ = 100.0f;
+const long BENCH_ZIGZAG_POINTS = 4000000;
+
+struct bench_result{
+    std::string stage;
+    long points;        // size of the fixture
+    long items;         // work items per rep
+    int reps;
+    double min_ns;
+    double mean_ns;
+};
+
+std::vector<bench_result> results;
+std::vector<std::string> selected_stages;   // empty = all
+double min_time = 0.2;
+
+void generate_fixture(std::string file, long num_points, bool with_dimensions, bool short_strokes = false)
+{
+    const double canvas = 10000.0;
+    std::mt19937 rng(20210301);
+    auto uniform = [&rng](double low, double high){ return low + (high - low) * (rng() / 4294967296.0); };
+
+    std::ofstream fixture(file, std::ios::out);
+    fixture.precision(17);
+    if (with_dimensions)
+        fixture << (int)canvas << "|" << (int)canvas << "\n";
+
+    long written = 0;
+    while (short_strokes && written < num_points)
+    {   // one dash, the steps inside it are far below the jumps between dashes
+        int length = BENCH_SHORT_STROKE_MIN + (int)(rng() % (BENCH_SHORT_STROKE_MAX - BENCH_SHORT_STROKE_MIN + 1));
+        double x = uniform(0.0, canvas - 2.0), y = uniform(0.0, canvas), angle = uniform(0.0, 2.0 * M_PI);
+        for (int i = 0; i < length && written < num_points; i++, written++)
+            fixture << x + 0.5 * i * std::cos(angle) << "," << y + 0.5 * i * std::sin(angle) << "\n";
+    }
+    while (written < num_points)
+    {   // one arc i.e. one stroke
+        double radius = uniform(50.0, 500.0);
+        double cx = uniform(radius, canvas - radius), cy = uniform(radius, canvas - radius);
+        double start = uniform(0.0, 2.0 * M_PI), span = uniform(0.5 * M_PI, 1.5 * M_PI);
+        for (int i = 0; i < BENCH_STROKE_POINTS && written < num_points; i++, written++)
+        {
+            double angle = start + span * i / (BENCH_STROKE_POINTS - 1);
+            fixture << cx + radius * std::cos(angle) << "," << cy + radius * std::sin(angle) << "\n";
+        }
+    }
+    fixture << "#\n";
+}
+
+bool stage_selected(std::string stage)
+{
+    if (selected_stages.empty())
+        return true;
+    return std::find(selected_stages.begin(), selected_stages.end(), stage) != selected_stages.end();
+}
+
+// runs setup (not timed) and run (timed) until min_time is spent, at least once
+template <typename Setup, typename Run>
+void run_stage(std::string stage, long points, long items, Setup setup, Run run)
+{
+    if (!stage_selected(stage))
+        return;
+
+    bench_result result = {stage, points, items, 0, 0.0, 0.0};
+    double total_ns = 0.0;
+    std::cout.setstate(std::ios::badbit);  // the pipeline functions print progress, keep it out of the measurement
+    while (result.reps == 0 || (total_ns < min_time * 1e9 && result.reps < 1000))
+    {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.min_ns = result.reps == 0 ? ns : std::min(result.min_ns, ns);
+        total_ns += ns;
+        result.reps++;
+    }
+    std::cout.clear();
+    result.mean_ns = total_ns / result.reps;
+    results.push_back(result);
+    std::cerr << std::setw(22) << std::left << stage << std::setw(10) << points << std::setw(6) << result.reps
+              << std::fixed << std::setprecision(3) << result.min_ns / 1e6 << " ms" << std::endl;
+}
+
+// the farthest point from every chord is the one before its end: plain RDP splits off one point per level
+void bench_zigzag()
+{
+    if (!stage_selected("decimate_zigzag"))
+        return;     // the fixture alone takes seconds and hundreds of MB
+    std::vector<Point> zigzag, work;
+    for (long i = 0; i < BENCH_ZIGZAG_POINTS; i++)
+        zigzag.push_back(Point(i * 0.01, (i % 2 ? -1.0 : 1.0) * (2.0 + i * 0.01)));
+    run_stage("decimate_zigzag", BENCH_ZIGZAG_POINTS, BENCH_ZIGZAG_POINTS,
+              [&](){ work = zigzag; },
+              [&](){ decimate_tolerance(work, 1.0); });
+}
+
+void bench_size(long num_points, std::string dir)
+{
+    std::string fixture_file = dir + "/fixture_" + std::to_string(num_points) + ".txt";
+    std::string nodim_file = dir + "/fixture_" + std::to_string(num_points) + "_nodim.txt";
+    std::string work_file = dir + "/fixture_" + std::to_string(num_points) + "_work.txt";
+    std::string wav_file = dir + "/bench.wav";
+    if (!fs::exists(fixture_file))
+        generate_fixture(fixture_file, num_points, true);
+
+    // ---------------- point stages ----------------
+    std::vector<Point> points, scaled, work;
+    run_stage("load_image_params", num_points, num_points,
+              [&](){ points.clear(); },
+              [&](){ load_image_params(fixture_file, points, &canvas_h, &canvas_w); });
+    if (points.empty())
+        load_image_params(fixture_file, points, &canvas_h, &canvas_w);
+
+    run_stage("rescale_point", num_points, num_points,
+              [&](){ work = points; },
+              [&](){ for (Point &element: work) element.rescale_point(&element); });
+    scaled = points;
+    for (Point &element: scaled)
+        element.rescale_point(&element);
+
+    run_stage("optimize_stroke_order", num_points, num_points,
+              [&](){ work = scaled; },
+              [&](){ optimize_stroke_order(work); });
+    if (stage_selected("optimize_stroke_short"))
+    {
+        std::string short_file = dir + "/fixture_" + std::to_string(num_points) + "_short.txt";
+        std::vector<Point> dashes;
+        if (!fs::exists(short_file))
+            generate_fixture(short_file, num_points, true, true);
+        load_image_params(short_file, dashes, &canvas_h, &canvas_w);
+        for (Point &element: dashes)
+            element.rescale_point(&element);
+        run_stage("optimize_stroke_short", num_points, num_points,
+                  [&](){ work = dashes; },
+                  [&](){ optimize_stroke_order(work); });
+    }
+    run_stage("decimate_tolerance", num_points, num_points,
+              [&](){ work = scaled; },
+              [&](){ decimate_tolerance(work, 1.0); });
+    run_stage("decimate_budget", num_points, num_points,
+              [&](){ work = scaled; },
+              [&](){ decimate_budget(work, std::max((std::size_t)2, scaled.size() / 4)); });
+
+    // ---------------- lut and synthesis ----------------
+    lut_size = 480000;  // default of svg_to_wav
+    int interpolation_factor = set_lut_size(scaled.size());
+    std::vector<std::int16_t> lut(lut_size), lut_x(lut_size), lut_y(lut_size);
+    float phase_y = 0.0f;
+    run_stage("create_lut", num_points, lut_size,
+              [](){},
+              [&](){ create_lut(lut.data(), lut_x.data(), lut_y.data(), wave_type::input, scaled, interpolation_factor, &phase_y); });
+    create_lut(lut.data(), lut_x.data(), lut_y.data(), wave_type::input, scaled, interpolation_factor, &phase_y);
+
+    std::vector<Point> trajectory;
+    run_stage("build_trajectory", num_points, lut_size / 2,
+              [](){},
+              [&](){ build_trajectory(scaled, lut_size / 2, 4.0, 30.0, trajectory); });
+
+    int num_samples = BENCH_SECONDS * BENCH_SAMPLING_RATE;
+    std::vector<std::int16_t> x_buff(num_samples), y_buff(num_samples);
+    run_stage("synthesize_samples", num_points, num_samples,
+              [](){},
+              [&](){ synthesize_samples(x_buff.data(), y_buff.data(), BENCH_FREQ, BENCH_SAMPLING_RATE, num_samples,
+                                        wave_type::input, lut.data(), lut_x.data(), lut_y.data(), phase_y); });
+
+    galvo_calibration calibration;
+    biquad section;
+    galvo_inverse_section(1200.0, 0.7, 3000.0, 0.7, BENCH_SAMPLING_RATE, section);
+    calibration.x.push_back(section);
+    calibration.y.push_back(section);
+    galvo_filter filter(calibration);
+    std::vector<std::int16_t> x_filtered, y_filtered;
+    run_stage("galvo_filter", num_points, num_samples,
+              [&](){ x_filtered = x_buff; y_filtered = y_buff; filter.reset(x_buff[0], y_buff[0]); },
+              [&](){ filter.process(x_filtered.data(), y_filtered.data(), num_samples); });
+
+    run_stage("write_wav", num_points, num_samples,
+              [](){},
+              [&](){
+                  std::ofstream file_wav(wav_file, std::ios::binary);
+                  write_wav_header(file_wav, BENCH_SAMPLING_RATE, num_samples);
+                  write_wav_samples(file_wav, x_buff.data(), y_buff.data(), num_samples);
+              });
+
+    // ---------------- add_dim_to_points ----------------
+    if (stage_selected("process_file"))
+    {
+        if (!fs::exists(nodim_file))
+            generate_fixture(nodim_file, num_points, false);
+        run_stage("process_file", num_points, num_points,
+                  [&](){    // process_file rewrites the file in place, start every rep from the file without dimensions
+                      fs::copy_file(nodim_file, work_file, fs::copy_options::overwrite_existing);
+                      x_coordinates.clear();
+                      y_coordinates.clear();
+                      file_content = "";
+                      first_line = "";
+                      is_processing_reqd = true;
+                  },
+                  [&](){ process_file(work_file); });
+        fs::remove(work_file);
+    }
+}
+
+void write_json(std::ostream &out)
+{
+    std::time_t now = std::time(NULL);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef __OPTIMIZE__
+    const char *optimized = "true";
+#else
+    const char *optimized = "false";
+#endif
+
+    out << "{\n  \"benchmark\": \"laser_bench\",\n  \"compiler\": \"" << __VERSION__ << "\",\n"
+        << "  \"optimized\": " << optimized << ",\n  \"timestamp\": \"" << timestamp << "\",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        bench_result &r = results[i];
+        out << std::fixed << std::setprecision(1)
+            << "    {\"stage\": \"" << r.stage << "\", \"points\": " << r.points << ", \"items\": " << r.items
+            << ", \"reps\": " << r.reps << ", \"min_ns\": " << r.min_ns << ", \"mean_ns\": " << r.mean_ns
+            << ", \"items_per_sec\": " << (r.min_ns > 0.0 ? r.items * 1e9 / r.min_ns : 0.0) << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+// splits a comma separated list
+std::vector<std::string> split_list(std::string list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (item.length())
+            items.push_back(item);
+    return items;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<long> sizes = {1000, 10000, 100000, 1000000};
+    std::string out_file = "", dir = "bench_fixtures";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.rfind("--gen=", 0) == 0)
+        {
+            if (i + 1 >= argc)
+            {
+                std::cout << "Invalid argument: --gen=<points> needs an output file name" << std::endl;
+                return -1;
+            }
+            generate_fixture(argv[i + 1], std::strtol(value.c_str(), NULL, 10), true);
+            return 0;
+        }
+        else if (arg.rfind("--sizes=", 0) == 0)
+        {
+            sizes.clear();
+            for (std::string &size: split_list(value))
+            {
+                long n = std::strtol(size.c_str(), NULL, 10);
+                if (n < 2 || n > 10000000)
+                {
+                    std::cout << "Invalid argument: fixture sizes must be between 2 and 10000000 points" << std::endl;
+                    return -1;
+                }
+                sizes.push_back(n);
+            }
+        }
+        else if (arg.rfind("--stages=", 0) == 0)
+            selected_stages = split_list(value);
+        else if (arg.rfind("--out=", 0) == 0)
+            out_file = value;
+        else if (arg.rfind("--dir=", 0) == 0)
+            dir = value;
+        else if (arg.rfind("--min-time=", 0) == 0)
+            min_time = std::strtod(value.c_str(), NULL);
+        else
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    fs::create_directories(dir);
+    for (long n: sizes)
+        bench_size(n, dir);
+    bench_zigzag();
+
+    if (out_file.length())
+    {
+        std::ofstream out(out_file);
+        write_json(out);
+    }
+    else
+        write_json(std::cout);
+    return 0;
+}
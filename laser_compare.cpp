@@ -0,0 +1,600 @@
+/*H**********************************************************************
+* FILENAME :        laser_compare.cpp
+*
+* DESCRIPTION :
+*       Compares a loopback recording of the DAC output (e.g. rec-100-100-4096-0(LUT128).wav) with the wav
+*       svg_to_wav rendered, to diagnose the playback chain: latency, channel skew, gain, residual error,
+*       clock drift and dropouts.
+*         -- the capture is resampled to the rate of the reference when the rates differ (windowed sinc)
+*         -- the start of the reference (the trigger pulse and the first 65536 frames) is found in the first
+*            --search seconds of the capture by FFT cross-correlation, per channel: the latency is the lag of x,
+*            the skew the lag of y minus the lag of x, both to a fraction of a frame (parabolic peak)
+*         -- then block by block: the lag is followed by a local correlation of +-8 frames around it, gain and
+*            residual per channel come out of the same sums. The lock is lost when the correlation is below 0.8,
+*            the residual above -10 dB of the reference or the best lag at the edge of the +-8 frames, unless the
+*            residual is within the noise of the tracked blocks. The next block is then searched again by FFT
+*            cross-correlation over +-8 blocks
+*         -- dropouts: jumps of the lag by more than a frame (frames lost or inserted by an xrun) and stretches
+*            of silence in the capture where the reference is not silent
+*         -- drift: least squares slope of the fractional lag over the blocks, jumps taken out, in ppm
+*
+* PUBLIC FUNCTIONS :
+*   wav_source(const wav_file &wav, unsigned int out_rate, bool loop)
+*   void wav_source::read(std::int64_t first, std::size_t count, float* x, float* y) const
+*   void correlate(const fft_plan &plan, const float* ref_x, const float* ref_y, std::size_t ref_len, const float* cap_x,
+*                  const float* cap_y, std::size_t cap_len, std::vector<float> &score_x, std::vector<float> &score_y)
+*   double find_peak(const std::vector<float> &score, float* peak, double center = -1, float tolerance = 0)
+*
+How to build:
+    g++ -O2 --std=c++17 laser_compare.cpp wav_reader.c -o laser_compare
+
+How to call:
+    ./laser_compare <reference.wav> <capture.wav> [options]
+    options:
+        --search=<s>            the reference starts within the first s seconds of the capture (default 2)
+        --block=<frames>        tracking block (default 4096)
+        --loop                  the reference was played in a loop (alsa-wav --loop), compare until the capture ends
+        --max-residual=<dB>     exit code 1 when the residual is above, e.g. -30 (default off)
+        --csv=<file>            per block: time, lag, score, gain and residual per channel, event
+    e.g. ./laser_compare "svg/batman,10sec,0.10Hz,SR48000.wav" "rec-100-100-4096-0(LUT128).wav" --csv=blocks.csv
+
+Note:
+    -- pcm 16, 24, 32 bit or 32 bit float wavs of at least 2 channels, x is the first channel, y the second
+    -- start the recording before the playback: the latency is >= 0
+    -- residual: energy of capture - gain * reference relative to gain * reference, in dB, with the gain of the
+       whole file (and the worst block with its own gain). Gain and residual are taken over the tracked blocks only
+    -- a periodic reference (a shape played many cycles per file) can not tell a dropout of whole cycles from none,
+       jumps are found modulo the cycle (the smallest one is reported)
+    -- a block must hold some detail of the shape: drawn slower than a few Hz a block is a ramp, which matches
+       itself at any lag, use a larger --block there
+    -- silence is reported in whole blocks, the block holding a dropout is neither tracked nor counted
+    -- every dot product and the FFT (fft.hpp) run 4 floats at a time, an hour at 48 kHz compares in seconds
+    -- exit code 0 when no dropout was found (and the residual is under --max-residual), 1 otherwise, negative
+       on an error
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "fft.hpp"
+#include "wav_reader.h"
+
+const std::size_t COMPARE_WINDOW = 65536;       // frames of the reference searched for at the start
+const int COMPARE_LOCAL = 8;                    // +- frames of the local search per block
+const int COMPARE_RESYNC_BLOCKS = 8;            // +- blocks of the FFT search after the lock was lost
+const float COMPARE_LOCK = 0.8f;                // normalized correlation of a locked block, a block a cycle off scores ~0.6
+const double COMPARE_LOST = 0.1;                // residual above gain^2 * reference energy * this: lock lost (-10 dB)
+const double COMPARE_NOISE = 4.0;               // residual below the mean of the tracked blocks * this: noise, still locked
+const float COMPARE_PEAK_TOLERANCE = 0.02f;     // correlation peaks this close count as equal, the nearest wins
+const double COMPARE_SILENCE = 1e-4;            // capture energy below gain^2 * reference energy * this: silent (-40 dB)
+const int RESAMPLE_HALF = 16;                   // taps on each side of the windowed sinc
+const int RESAMPLE_PHASES = 256;                // fractional positions of the kernel table
+
+// frames of a wav as float in -1 ... 1 at out_rate, zeros outside the file or the file repeated (loop)
+class wav_source{
+    public:
+        wav_source(const wav_file &wav, unsigned int out_rate, bool loop);
+        std::int64_t frames() const { return out_frames; }
+        void read(std::int64_t first, std::size_t count, float* x, float* y) const;
+    private:
+        float sample(std::int64_t frame, int channel) const;
+
+        const wav_file &wav;
+        bool loop;
+        double ratio;                   // input frames per output frame
+        std::int64_t out_frames;
+        std::vector<float> kernel;      // (RESAMPLE_PHASES + 1) * 2 * RESAMPLE_HALF taps, empty without resampling
+};
+
+wav_source::wav_source(const wav_file &wav_in, unsigned int out_rate, bool loop_in) : wav(wav_in), loop(loop_in)
+{
+    ratio = (double)wav.rate / out_rate;
+    out_frames = (std::int64_t)std::floor(wav.num_frames / ratio);
+    if (wav.rate == out_rate)
+        return;
+    double cutoff = std::min(1.0, 1.0 / ratio) * 0.95;     // below the lower Nyquist frequency
+    kernel.resize((RESAMPLE_PHASES + 1) * 2 * RESAMPLE_HALF);
+    for (int phase = 0; phase <= RESAMPLE_PHASES; phase++)
+    {
+        double sum = 0.0, fraction = (double)phase / RESAMPLE_PHASES;
+        for (int tap = 0; tap < 2 * RESAMPLE_HALF; tap++)
+        {
+            double d = tap - (RESAMPLE_HALF - 1) - fraction;   // distance of the input frame from the output position
+            double sinc = d == 0.0 ? 1.0 : std::sin(M_PI * cutoff * d) / (M_PI * cutoff * d);
+            double window = 0.5 + 0.5 * std::cos(M_PI * d / RESAMPLE_HALF);
+            kernel[phase * 2 * RESAMPLE_HALF + tap] = (float)(sinc * window);
+            sum += sinc * window;
+        }
+        for (int tap = 0; tap < 2 * RESAMPLE_HALF; tap++)      // unity gain at DC
+            kernel[phase * 2 * RESAMPLE_HALF + tap] /= (float)sum;
+    }
+}
+
+float wav_source::sample(std::int64_t frame, int channel) const
+{
+    std::int64_t total = (std::int64_t)wav.num_frames;
+    if (loop)
+        frame = ((frame % total) + total) % total;
+    else if (frame < 0 || frame >= total)
+        return 0.0f;
+    const std::uint8_t* p = wav.data + frame * wav.block_align + channel * (wav.bits_per_sample / 8);
+    if (wav.format == WAV_FORMAT_FLOAT)
+    {
+        float value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    switch (wav.bits_per_sample)
+    {
+        case 16: return (std::int16_t)(p[0] | (p[1] << 8)) / 32768.0f;
+        case 24: return (std::int32_t)((std::uint32_t)p[0] << 8 | (std::uint32_t)p[1] << 16 | (std::uint32_t)p[2] << 24) / 2147483648.0f;
+        default: return (std::int32_t)((std::uint32_t)p[0] | (std::uint32_t)p[1] << 8 | (std::uint32_t)p[2] << 16 | (std::uint32_t)p[3] << 24) / 2147483648.0f;
+    }
+}
+
+void wav_source::read(std::int64_t first, std::size_t count, float* x, float* y) const
+{
+    if (kernel.empty())
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            x[i] = sample(first + (std::int64_t)i, 0);
+            y[i] = sample(first + (std::int64_t)i, 1);
+        }
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double position = (double)(first + (std::int64_t)i) * ratio;
+        std::int64_t base = (std::int64_t)std::floor(position);
+        const float* taps = kernel.data() + (int)((position - base) * RESAMPLE_PHASES + 0.5) * 2 * RESAMPLE_HALF;
+        float sum_x = 0.0f, sum_y = 0.0f;
+        for (int tap = 0; tap < 2 * RESAMPLE_HALF; tap++)
+        {
+            std::int64_t frame = base + tap - (RESAMPLE_HALF - 1);
+            sum_x += taps[tap] * sample(frame, 0);
+            sum_y += taps[tap] * sample(frame, 1);
+        }
+        x[i] = sum_x;
+        y[i] = sum_y;
+    }
+}
+
+// subtracts the mean, a loopback capture is AC coupled
+void remove_mean(float* v, std::size_t n)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+        sum += v[i];
+    float mean = (float)(sum / n);
+    for (std::size_t i = 0; i < n; i++)
+        v[i] -= mean;
+}
+
+// correlation of the reference with the capture at lags 0 ... cap_len - ref_len, per channel, with the means
+// removed and normalized to -1 ... 1 by the energy of both under the window (Pearson). Both channels go through one complex FFT each (x real, y
+// imaginary), the spectra are separated by symmetry, the two cross spectra go back through one inverse FFT
+void correlate(const fft_plan &plan, const float* ref_x, const float* ref_y, std::size_t ref_len, const float* cap_x,
+               const float* cap_y, std::size_t cap_len, std::vector<float> &score_x, std::vector<float> &score_y)
+{
+    std::size_t n = plan.size(), lags = cap_len - ref_len + 1;
+    std::vector<float> r_re(n, 0.0f), r_im(n, 0.0f), c_re(n, 0.0f), c_im(n, 0.0f), w_re(n), w_im(n);
+    std::copy(ref_x, ref_x + ref_len, r_re.begin());
+    std::copy(ref_y, ref_y + ref_len, r_im.begin());
+    remove_mean(r_re.data(), ref_len);      // then the cross sums do not depend on the capture mean
+    remove_mean(r_im.data(), ref_len);
+    double energy_rx = dot(r_re.data(), r_re.data(), ref_len), energy_ry = dot(r_im.data(), r_im.data(), ref_len);
+    std::copy(cap_x, cap_x + cap_len, c_re.begin());
+    std::copy(cap_y, cap_y + cap_len, c_im.begin());
+    plan.forward(r_re.data(), r_im.data());
+    plan.forward(c_re.data(), c_im.data());
+
+    for (std::size_t k = 0; k < n; k++)
+    {
+        std::size_t m = (n - k) & (n - 1);
+        // X = (Z[k] + conj(Z[m])) / 2, Y = (Z[k] - conj(Z[m])) / 2i
+        float rx_re = 0.5f * (r_re[k] + r_re[m]), rx_im = 0.5f * (r_im[k] - r_im[m]);
+        float ry_re = 0.5f * (r_im[k] + r_im[m]), ry_im = -0.5f * (r_re[k] - r_re[m]);
+        float cx_re = 0.5f * (c_re[k] + c_re[m]), cx_im = 0.5f * (c_im[k] - c_im[m]);
+        float cy_re = 0.5f * (c_im[k] + c_im[m]), cy_im = -0.5f * (c_re[k] - c_re[m]);
+        // conj(R) * C per channel, x + i y
+        float px_re = rx_re * cx_re + rx_im * cx_im, px_im = rx_re * cx_im - rx_im * cx_re;
+        float py_re = ry_re * cy_re + ry_im * cy_im, py_im = ry_re * cy_im - ry_im * cy_re;
+        w_re[k] = px_re - py_im;
+        w_im[k] = px_im + py_re;
+    }
+    plan.inverse(w_re.data(), w_im.data());
+
+    // capture energy under the window around its own mean, from prefix sums
+    std::vector<double> sum_x(cap_len + 1, 0.0), sum_y(cap_len + 1, 0.0), square_x(cap_len + 1, 0.0), square_y(cap_len + 1, 0.0);
+    for (std::size_t i = 0; i < cap_len; i++)
+    {
+        sum_x[i + 1] = sum_x[i] + cap_x[i];
+        sum_y[i + 1] = sum_y[i] + cap_y[i];
+        square_x[i + 1] = square_x[i] + (double)cap_x[i] * cap_x[i];
+        square_y[i + 1] = square_y[i] + (double)cap_y[i] * cap_y[i];
+    }
+    score_x.resize(lags);
+    score_y.resize(lags);
+    for (std::size_t lag = 0; lag < lags; lag++)
+    {
+        double mean_x = (sum_x[lag + ref_len] - sum_x[lag]) / ref_len, mean_y = (sum_y[lag + ref_len] - sum_y[lag]) / ref_len;
+        double energy_cx = square_x[lag + ref_len] - square_x[lag] - ref_len * mean_x * mean_x;
+        double energy_cy = square_y[lag + ref_len] - square_y[lag] - ref_len * mean_y * mean_y;
+        score_x[lag] = energy_rx * energy_cx > 0 ? (float)(w_re[lag] / std::sqrt(energy_rx * energy_cx)) : 0.0f;
+        score_y[lag] = energy_ry * energy_cy > 0 ? (float)(w_im[lag] / std::sqrt(energy_ry * energy_cy)) : 0.0f;
+    }
+}
+
+// index of the largest |score| with the parabola through its neighbours, *peak: the score there (sign = polarity).
+// With center >= 0 the local maximum nearest to center within tolerance of the largest wins: a periodic signal
+// has a peak every cycle, the nearest one is the smallest jump
+double find_peak(const std::vector<float> &score, float* peak, double center, float tolerance)
+{
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < score.size(); i++)
+        if (std::fabs(score[i]) > std::fabs(score[best]))
+            best = i;
+    if (center >= 0 && !score.empty())
+    {
+        float floor = std::fabs(score[best]) - tolerance;
+        for (std::size_t i = 1; i + 1 < score.size(); i++)
+        {
+            float a = std::fabs(score[i]);
+            if (a >= floor && a >= std::fabs(score[i - 1]) && a >= std::fabs(score[i + 1]) &&
+                std::fabs((double)i - center) < std::fabs((double)best - center))
+                best = i;
+        }
+    }
+    *peak = score.empty() ? 0.0f : score[best];
+    if (best == 0 || best + 1 >= score.size())
+        return (double)best;
+    double left = score[best - 1], middle = score[best], right = score[best + 1];
+    double curvature = left - 2 * middle + right;
+    return best + (curvature != 0.0 ? 0.5 * (left - right) / curvature : 0.0);
+}
+
+std::size_t next_power_of_2(std::size_t n)
+{
+    std::size_t size = 1;
+    while (size < n)
+        size *= 2;
+    return size;
+}
+
+// per channel sums of the tracked blocks
+struct channel_sums{
+    double cr = 0.0, rr = 0.0, cc = 0.0;
+    void add(double c_r, double r_r, double c_c) { cr += c_r; rr += r_r; cc += c_c; }
+    double gain() const { return rr > 0 ? cr / rr : 0.0; }
+    // capture - gain * reference relative to gain * reference, dB
+    double residual_db() const
+    {
+        double signal = cr * cr / std::max(rr, 1e-30), residual = std::max(cc - signal, 1e-30);
+        return 10.0 * std::log10(residual / std::max(signal, 1e-30));
+    }
+};
+
+struct compare_event{
+    double time;            // reference seconds
+    std::int64_t jump;      // frames, 0 for silence
+    double silent;          // seconds of silence
+};
+
+int main(int argc, char* argv[])
+{
+    std::string reference_name, capture_name, csv_name;
+    double search_seconds = 2.0, max_residual = 0.0;
+    bool loop = false, check_residual = false;
+    std::size_t block = 4096;
+    int retval;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.rfind("--search=", 0) == 0)
+            search_seconds = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--block=", 0) == 0)
+            block = (std::size_t)std::strtoul(value.c_str(), NULL, 10);
+        else if (arg.compare("--loop") == 0)
+            loop = true;
+        else if (arg.rfind("--max-residual=", 0) == 0)
+        {
+            max_residual = std::strtod(value.c_str(), NULL);
+            check_residual = true;
+        }
+        else if (arg.rfind("--csv=", 0) == 0)
+            csv_name = value;
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+        else if (reference_name.empty())
+            reference_name = arg;
+        else if (capture_name.empty())
+            capture_name = arg;
+        else
+        {
+            std::cout << "Invalid argument: " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (reference_name.empty() || capture_name.empty())
+    {
+        std::cout << "Input Error: usage: laser_compare <reference.wav> <capture.wav> [options], see laser_compare.cpp" << std::endl;
+        return -1;
+    }
+    if (block < 256 || block > 1048576 || !(search_seconds > 0))
+    {
+        std::cout << "Invalid argument: --block 256 ... 1048576 frames, --search > 0" << std::endl;
+        return -1;
+    }
+
+    wav_file reference_wav, capture_wav;
+    if ((retval = wav_open(&reference_wav, reference_name.c_str())) != WAV_OK)
+    {
+        std::cout << "Input Error: " << reference_name << ": " << wav_strerror(retval) << std::endl;
+        return -2;
+    }
+    if ((retval = wav_open(&capture_wav, capture_name.c_str())) != WAV_OK)
+    {
+        std::cout << "Input Error: " << capture_name << ": " << wav_strerror(retval) << std::endl;
+        wav_close(&reference_wav);
+        return -2;
+    }
+    for (const wav_file* wav : {&reference_wav, &capture_wav})
+    {
+        bool pcm = wav->format == WAV_FORMAT_PCM && (wav->bits_per_sample == 16 || wav->bits_per_sample == 24 || wav->bits_per_sample == 32);
+        bool pcm_float = wav->format == WAV_FORMAT_FLOAT && wav->bits_per_sample == 32;
+        if ((!pcm && !pcm_float) || wav->channels < 2 || wav->num_frames < 2 * block)
+        {
+            std::cout << "Input Error: " << (wav == &reference_wav ? reference_name : capture_name)
+                      << ": needs 16/24/32 bit pcm or 32 bit float, 2 channels and at least 2 blocks of frames" << std::endl;
+            wav_close(&reference_wav);
+            wav_close(&capture_wav);
+            return -2;
+        }
+    }
+
+    unsigned int rate = reference_wav.rate;
+    wav_source reference(reference_wav, rate, loop), capture(capture_wav, rate, false);
+    auto start_time = std::chrono::steady_clock::now();
+
+    // latency and skew: the start of the reference in the first search_seconds of the capture
+    std::size_t window = (std::size_t)std::min<std::int64_t>(COMPARE_WINDOW, reference.frames());
+    std::size_t segment = (std::size_t)std::min<std::int64_t>(capture.frames(), (std::int64_t)(search_seconds * rate) + (std::int64_t)window);
+    if (segment < window)
+    {
+        std::cout << "Input Error: the capture is shorter than the start of the reference" << std::endl;
+        wav_close(&reference_wav);
+        wav_close(&capture_wav);
+        return -2;
+    }
+    std::vector<float> ref_x(window), ref_y(window), cap_x(segment), cap_y(segment), score_x, score_y;
+    reference.read(0, window, ref_x.data(), ref_y.data());
+    capture.read(0, segment, cap_x.data(), cap_y.data());
+    fft_plan search_plan(next_power_of_2(segment));
+    correlate(search_plan, ref_x.data(), ref_y.data(), window, cap_x.data(), cap_y.data(), segment, score_x, score_y);
+    float peak_x, peak_y;
+    double lag_x = find_peak(score_x, &peak_x, -1, 0), lag_y = find_peak(score_y, &peak_y, lag_x, COMPARE_PEAK_TOLERANCE);
+    if (std::fabs(peak_x) < COMPARE_LOCK || std::fabs(peak_y) < COMPARE_LOCK)
+    {
+        std::cout << "ERROR: the reference was not found in the first " << search_seconds << " s of the capture (correlation x "
+                  << peak_x << ", y " << peak_y << "), try a larger --search" << std::endl;
+        wav_close(&reference_wav);
+        wav_close(&capture_wav);
+        return -3;
+    }
+    double skew = lag_y - lag_x;
+    int skew_frames = (int)std::lround(skew);
+    std::int64_t lag = std::llround(lag_x);
+    float sign_x = peak_x < 0 ? -1.0f : 1.0f, sign_y = peak_y < 0 ? -1.0f : 1.0f;  // an inverting channel
+
+    // tracking, block by block
+    const int margin = COMPARE_LOCAL + std::abs(skew_frames);
+    std::vector<float> rx(block), ry(block), cx(block + 2 * margin), cy(block + 2 * margin);
+    std::vector<double> prefix_x(cx.size() + 1), prefix_y(cy.size() + 1);
+    std::size_t resync_reach = COMPARE_RESYNC_BLOCKS * block;
+    fft_plan resync_plan(next_power_of_2(2 * resync_reach + block));
+    std::vector<float> seg_x(2 * resync_reach + block), seg_y(2 * resync_reach + block), resync_x, resync_y;
+    channel_sums sums_x, sums_y;
+    std::vector<compare_event> events;
+    double residual_tracked = 0.0;      // sum of the residuals of the tracked blocks, the noise floor
+    double worst_db = -1e30, worst_time = 0.0, fit_n = 0, fit_t = 0, fit_l = 0, fit_tt = 0, fit_tl = 0;
+    std::int64_t jumps = 0, blocks = 0, tracked = 0, unlocked = 0, silent_blocks = 0;
+    bool silent = false, lost = false;
+    std::ofstream csv;
+    if (csv_name.length())
+    {
+        csv.open(csv_name);
+        csv << "time_s,lag,score,gain_x,gain_y,residual_db_x,residual_db_y,event\n";
+    }
+
+    for (std::int64_t r0 = 0; ; r0 += (std::int64_t)block, blocks++)
+    {
+        std::int64_t c0 = r0 + lag;
+        if ((!loop && r0 + (std::int64_t)block > reference.frames()) || c0 + (std::int64_t)block + margin > capture.frames())
+            break;
+        double time = (double)r0 / rate;
+        reference.read(r0, block, rx.data(), ry.data());
+        remove_mean(rx.data(), block);
+        remove_mean(ry.data(), block);
+        double energy_rx = dot(rx.data(), rx.data(), block), energy_ry = dot(ry.data(), ry.data(), block);
+        if (energy_rx + energy_ry < 1e-9 * block)
+            continue;   // no AC in the reference, nothing to follow
+
+        // capture around the lag, y shifted by the skew. The reference is mean free, so the cross sums do not
+        // depend on the capture mean, the capture energy of every shift d is corrected by its window mean
+        capture.read(c0 - margin, block + 2 * margin, cx.data(), cy.data());
+        remove_mean(cx.data(), cx.size());
+        remove_mean(cy.data(), cy.size());
+        for (std::size_t i = 0; i < cx.size(); i++)
+        {
+            prefix_x[i + 1] = prefix_x[i] + cx[i];
+            prefix_y[i + 1] = prefix_y[i] + cy[i];
+        }
+        double residual[2 * COMPARE_LOCAL + 1], energy[2 * COMPARE_LOCAL + 1], cross_x[2 * COMPARE_LOCAL + 1], cross_y[2 * COMPARE_LOCAL + 1];
+        double energy_x[2 * COMPARE_LOCAL + 1], energy_y[2 * COMPARE_LOCAL + 1];
+        int best = 0;
+        for (int d = -COMPARE_LOCAL; d <= COMPARE_LOCAL; d++)
+        {
+            int k = d + COMPARE_LOCAL;
+            std::size_t at_x = margin + d, at_y = margin + skew_frames + d;
+            double mean_x = (prefix_x[at_x + block] - prefix_x[at_x]) / block, mean_y = (prefix_y[at_y + block] - prefix_y[at_y]) / block;
+            energy_x[k] = std::max(0.0, dot(cx.data() + at_x, cx.data() + at_x, block) - block * mean_x * mean_x);
+            energy_y[k] = std::max(0.0, dot(cy.data() + at_y, cy.data() + at_y, block) - block * mean_y * mean_y);
+            cross_x[k] = dot(rx.data(), cx.data() + at_x, block);
+            cross_y[k] = dot(ry.data(), cy.data() + at_y, block);
+            // least squares: what is left after the best gain per channel
+            residual[k] = std::max(0.0, energy_x[k] - (energy_rx > 0 ? cross_x[k] * cross_x[k] / energy_rx : 0.0)) +
+                          std::max(0.0, energy_y[k] - (energy_ry > 0 ? cross_y[k] * cross_y[k] / energy_ry : 0.0));
+            energy[k] = energy_x[k] + energy_y[k];
+            if (residual[k] < residual[best + COMPARE_LOCAL])
+                best = d;
+        }
+        double gain2 = sums_x.rr > 0 ? (sums_x.gain() * sums_x.gain() + sums_y.gain() * sums_y.gain()) / 2 : 1.0;
+        if (energy[COMPARE_LOCAL] < COMPARE_SILENCE * gain2 * (energy_rx + energy_ry))
+        {
+            if (!silent)
+                events.push_back({time, 0, 0.0});
+            events.back().silent += (double)block / rate;
+            silent = true;
+            silent_blocks++;
+            if (csv.is_open())
+                csv << time << "," << lag << ",0,,,,,silent\n";
+            continue;
+        }
+        silent = false;
+        bool edge = std::abs(best) == COMPARE_LOCAL;    // the minimum is outside the local search
+        if (residual[best + COMPARE_LOCAL] > 0.5 * residual[COMPARE_LOCAL])
+            best = 0;   // a move must halve the residual, noise does not move the lag
+        int k = best + COMPARE_LOCAL;
+        float score = energy[k] > 0 ? (float)std::sqrt(std::max(0.0, 1.0 - residual[k] / energy[k])) : 0.0f;
+        // what the reference explains of the capture, relative to the reference at the gain so far (the capture
+        // energy before the first tracked block)
+        double reference_energy = sums_x.rr > 0 ? gain2 * (energy_rx + energy_ry) : energy[k];
+        // a block of little detail (a slow ramp) is below the lock in noise alone, it is lost only when the
+        // residual is also well above the one of the tracked blocks
+        bool noisy = tracked > 0 && residual[COMPARE_LOCAL] < COMPARE_NOISE * residual_tracked / tracked;
+
+        if (!lost && !noisy && (score < COMPARE_LOCK || edge || residual[k] > COMPARE_LOST * reference_energy))
+        {
+            // the block holding the dropout matches neither lag, search with the next one
+            lost = true;
+            unlocked++;
+            if (csv.is_open())
+                csv << time << "," << lag << "," << score << ",,,,,lost\n";
+            continue;
+        }
+        if (lost)
+        {
+            // FFT search of the block in +-resync_reach around the lag
+            capture.read(c0 - (std::int64_t)resync_reach, seg_x.size(), seg_x.data(), seg_y.data());
+            correlate(resync_plan, rx.data(), ry.data(), block, seg_x.data(), seg_y.data(), seg_x.size(), resync_x, resync_y);
+            for (std::size_t i = 0; i < resync_x.size(); i++)   // both channels with their polarity, y moved by the skew
+            {
+                std::int64_t at_y = (std::int64_t)i + skew_frames;
+                resync_x[i] = at_y >= 0 && at_y < (std::int64_t)resync_y.size() ? (sign_x * resync_x[i] + sign_y * resync_y[at_y]) / 2
+                                                                                : sign_x * resync_x[i];
+            }
+            float peak;
+            std::int64_t jump = std::llround(find_peak(resync_x, &peak, (double)resync_reach, COMPARE_PEAK_TOLERANCE)) - (std::int64_t)resync_reach;
+            if (std::fabs(peak) < COMPARE_LOCK)
+            {
+                unlocked++;
+                if (csv.is_open())
+                    csv << time << "," << lag << "," << peak << ",,,,,unlocked\n";
+                continue;
+            }
+            lost = false;
+            if (jump != 0)
+            {
+                lag += jump;
+                jumps += jump;
+                events.push_back({time, jump, 0.0});
+                unlocked--;     // the lost block was the dropout
+            }
+            if (csv.is_open())
+                csv << time << "," << lag << "," << peak << ",,,,,resync " << jump << "\n";
+            continue;   // measured from the next block on
+        }
+        std::string event;
+        if (std::abs(best) > 1)
+        {   // more than a frame in one block is not drift
+            events.push_back({time, best, 0.0});
+            jumps += best;
+            event = "jump " + std::to_string(best);
+        }
+        lag += best;
+
+        // fractional lag for the drift fit (parabola through the residuals), jumps taken out
+        double left = residual[k - 1], middle = residual[k], right = residual[k + 1], curvature = left - 2 * middle + right;
+        double fraction = lag - jumps + (curvature > 0 ? 0.5 * (left - right) / curvature : 0.0);
+        fit_n++, fit_t += time, fit_l += fraction, fit_tt += time * time, fit_tl += time * fraction;
+
+        channel_sums block_x, block_y;
+        block_x.add(cross_x[k], energy_rx, energy_x[k]);
+        block_y.add(cross_y[k], energy_ry, energy_y[k]);
+        sums_x.add(block_x.cr, block_x.rr, block_x.cc);
+        sums_y.add(block_y.cr, block_y.rr, block_y.cc);
+        double block_db = std::max(block_x.residual_db(), block_y.residual_db());
+        if (block_db > worst_db)
+            worst_db = block_db, worst_time = time;
+        residual_tracked += residual[k];
+        tracked++;
+        if (csv.is_open())
+            csv << time << "," << lag << "," << score << "," << block_x.gain() << "," << block_y.gain() << ","
+                << block_x.residual_db() << "," << block_y.residual_db() << "," << event << "\n";
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    unsigned int capture_rate = capture_wav.rate;
+    wav_close(&reference_wav);
+    wav_close(&capture_wav);
+
+    double compared = (double)blocks * block / rate;
+    double drift = fit_n > 1 && fit_n * fit_tt - fit_t * fit_t > 0 ? (fit_n * fit_tl - fit_t * fit_l) / (fit_n * fit_tt - fit_t * fit_t) / rate * 1e6 : 0.0;
+    std::cout << std::fixed << std::setprecision(2)
+              << "reference: " << reference_name << ", " << rate << " Hz" << (loop ? ", looped" : "") << "\n"
+              << "capture:   " << capture_name << ", " << capture_rate << " Hz" << (capture_rate != rate ? " resampled to the reference rate" : "") << "\n"
+              << "latency:   " << lag_x << " frames = " << std::setprecision(3) << lag_x * 1e3 / rate << " ms (correlation " << peak_x << ")\n"
+              << "skew y-x:  " << std::setprecision(2) << skew << " frames = " << skew * 1e6 / rate << " us\n"
+              << "gain:      x " << std::setprecision(4) << sums_x.gain() << " (" << std::setprecision(2) << 20 * std::log10(std::fabs(sums_x.gain()) + 1e-30)
+              << " dB), y " << std::setprecision(4) << sums_y.gain() << " (" << std::setprecision(2) << 20 * std::log10(std::fabs(sums_y.gain()) + 1e-30) << " dB)"
+              << (peak_x < 0 || peak_y < 0 ? ", INVERTED polarity" : "") << "\n"
+              << "residual:  x " << sums_x.residual_db() << " dB, y " << sums_y.residual_db() << " dB, worst block " << worst_db << " dB at " << worst_time << " s\n"
+              << "drift:     " << drift << " ppm\n"
+              << "blocks:    " << tracked << " of " << blocks << " tracked (" << block << " frames), " << unlocked << " unlocked, "
+              << silent_blocks << " silent, " << compared << " s compared in " << seconds << " s\n"
+              << "dropouts:  " << events.size() << std::endl;
+    for (const compare_event &e : events)
+    {
+        if (e.jump)
+            std::cout << "    at " << e.time << " s: " << (e.jump > 0 ? "+" : "") << e.jump << " frames ("
+                      << (e.jump > 0 ? "inserted, capture delayed" : "lost, capture ahead") << ")" << std::endl;
+        else
+            std::cout << "    at " << e.time << " s: silent for " << std::setprecision(3) << e.silent << std::setprecision(2) << " s" << std::endl;
+    }
+
+    bool failed = !events.empty() || unlocked > 0 || tracked == 0;
+    if (check_residual && std::max(sums_x.residual_db(), sums_y.residual_db()) > max_residual)
+    {
+        std::cout << "FAIL: residual above " << max_residual << " dB" << std::endl;
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
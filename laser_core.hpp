@@ -0,0 +1,290 @@
+/*H**********************************************************************
+* FILENAME :        laser_core.hpp
+*
+* DESCRIPTION :
+*       The one copy of the synthesis code: points file parsing, rescaling, lookup table sizing and filling,
+*       phase accumulator rendering and wav serialization. Works only on its arguments (no globals), used by
+*       svg_to_wav.cpp, wav_write.cpp and the C library liblaser.cpp
+*
+* PUBLIC FUNCTIONS :
+*   int load_points(std::string file, std::vector<PointT> &points, int* canvas_height, int* canvas_width)
+*   void rescale(double &x, double &y, int canvas_height, int canvas_width, double amp_multiplyer)
+*   std::uint32_t size_lut(std::uint32_t max_lut_size, std::size_t num_points, int* interpolation_factor)
+*   float build_wave_lut(std::int16_t lut[], std::uint32_t lut_size, int wave)
+*   void build_input_lut(std::int16_t lut_x[], std::int16_t lut_y[], std::uint32_t lut_size, const std::vector<PointT> &points,
+*                        int interpolation_factor)
+*   float phase_increment(float freq, int sampling_rate, std::uint32_t lut_size)
+*   std::size_t render(const render_tables &tables, float increment, phase_state &state, std::int16_t* x_out,
+*                      std::int16_t* y_out, std::size_t stride, std::size_t num_frames, bool* cycle_end = nullptr)
+*   void write_wav_header(std::ostream &out, int sampling_rate, std::uint32_t num_frames)
+*   void write_pcm(std::ostream &out, const std::int16_t* x, const std::int16_t* y, std::size_t stride, std::size_t num_frames)
+*
+Note:
+    -- lookup table of an input shape: forward half start->end with interpolation_factor linearly interpolated points
+       between two input points, backward half end->start, i.e. the beam draws the trace back and forth
+    -- sine/rectangle use one table for both channels, y runs lut_size/4 (sine -> cosine) or lut_size/2 (rectangle)
+       ahead of x. Input shapes use lut_x/lut_y with the same phase
+    -- the first TRIGGER_FRAMES frames of an input shape are a pulse the oscilloscope triggers on (falling edge)
+    -- a cycle ends with the frame after which phase_x wraps. Given cycle_end, render stops there (*cycle_end = true)
+       so a player can switch tables exactly between two cycles
+    -- size_lut of no points is 0, render of a table of size 0 renders nothing and returns 0
+    -- error codes are the LASER_ERR_* values of laser.h
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef LASER_CORE_HPP
+#define LASER_CORE_HPP
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "laser.h"
+
+namespace laser_core
+{
+    const std::int16_t TRIGGER_LEVEL = 32500;   // pulse level, last TRIGGER_FALLING_FRAMES at -TRIGGER_LEVEL
+    const std::uint64_t TRIGGER_FRAMES = 100;
+    const std::uint64_t TRIGGER_FALLING_FRAMES = 10;
+    const std::size_t PCM_CHUNK_FRAMES = 4096;  // frames serialized per write
+
+    // tables the renderer reads, table_x == table_y for sine/rectangle
+    struct render_tables{
+        const std::int16_t* table_x;
+        const std::int16_t* table_y;
+        std::uint32_t lut_size;
+        bool trigger;               // input shape, first TRIGGER_FRAMES frames are the trigger pulse
+    };
+
+    struct phase_state{
+        float phase_x = 0.0f;
+        float phase_y = 0.0f;
+        std::uint64_t frame = 0;    // frames rendered so far
+    };
+
+    // reads a points file: optional height|width line, x,y lines, # as the last line
+    template <typename PointT>
+    int load_points(std::string file, std::vector<PointT> &points, int* canvas_height, int* canvas_width)
+    {
+        std::ifstream file_points(file);
+        std::string line;
+        if (!file_points.is_open())
+            return LASER_ERR_OPEN;
+
+        try
+        {
+            while (std::getline(file_points, line))
+            {
+                if (line.length() && line[line.length() - 1] == '\r')  // file saved on windows
+                    line.erase(line.length() - 1);
+                std::size_t pos = line.find(",");
+                if (pos != std::string::npos)
+                    points.push_back(PointT(std::stod(line.substr(0, pos)), std::stod(line.substr(pos + 1))));
+                else if (line.compare("#") == 0)    // end of file
+                    break;
+                else if ((pos = line.find("|")) != std::string::npos)  // dimensions height|width
+                {
+                    *canvas_height = std::stoi(line.substr(0, pos));
+                    *canvas_width = std::stoi(line.substr(pos + 1));
+                }
+                else
+                    return LASER_ERR_FORMAT;
+            }
+        }
+        catch (const std::logic_error &)   // std::stod/stoi: invalid_argument, out_of_range
+        {
+            return LASER_ERR_FORMAT;
+        }
+        return LASER_OK;
+    }
+
+    // canvas coordinates -> [-amp/2, amp/2]
+    inline void rescale(double &x, double &y, int canvas_height, int canvas_width, double amp_multiplyer)
+    {
+        x = (x - 0.0) / ((double)canvas_width - 0.0);   // normalization between 0 and 1
+        y = (y - 0.0) / ((double)canvas_height - 0.0);
+        x -= 0.5;   // scale in [-0.5, 0.5] range
+        y -= 0.5;
+        x *= amp_multiplyer;
+        y *= amp_multiplyer;
+    }
+
+    // lut size for num_points input points, the table grows when the points do not fit into max_lut_size
+    inline std::uint32_t size_lut(std::uint32_t max_lut_size, std::size_t num_points, int* interpolation_factor)
+    {
+        *interpolation_factor = 0;
+        if (num_points == 0)
+            return 0;       // no table, callers must not render
+        if (num_points < 2 || max_lut_size <= num_points * 2)
+            return (std::uint32_t)(num_points * 2);     // no interpolated points
+        // interpolation_factor is num of points between 2 adjacent points
+        *interpolation_factor = (int)((max_lut_size / 2 - num_points) / (num_points - 1));
+        return (std::uint32_t)(2 * (num_points + (std::size_t)*interpolation_factor * (num_points - 1)));
+    }
+
+    // fills a sine or rectangle table, returns the initial phase of the y channel
+    inline float build_wave_lut(std::int16_t lut[], std::uint32_t lut_size, int wave)
+    {
+        if (wave == LASER_WAVE_RECTANGLE)
+        {
+            for (std::uint32_t i = 0; i < lut_size; ++i)
+                lut[i] = i < lut_size / 2 ? 0 : 30000;  // first half zero, rest 30000
+            return (float)(lut_size / 2);
+        }
+        for (std::uint32_t i = 0; i < lut_size; ++i)
+        {   // convert sin vals between (-1,1) to int_16 by multiplying SHRT_MAX
+            lut[i] = (std::int16_t)roundf(SHRT_MAX * sinf(2.0f * M_PI * (float)i / (float)lut_size));
+        }
+        return (float)(lut_size / 4);   // cosine
+    }
+
+    // forward half start->end with interpolated points, backward half end->start
+    template <typename PointT>
+    void build_input_lut(std::int16_t lut_x[], std::int16_t lut_y[], std::uint32_t lut_size, const std::vector<PointT> &points,
+                         int interpolation_factor)
+    {
+        std::size_t n = points.size(), lut_counter = 0;
+        if (n == 0 || lut_size == 0)
+            return;
+
+        for (std::size_t i = 0; i + 1 < n; i++)
+        {
+            double current_x = points[i].get_x(), current_y = points[i].get_y();
+            double next_x = points[i + 1].get_x(), next_y = points[i + 1].get_y();
+            double inc_x = std::abs(current_x - next_x) / (interpolation_factor + 1);  // distance / factor+1
+            double inc_y = std::abs(current_y - next_y) / (interpolation_factor + 1);
+            int direction_x = next_x > current_x ? 1 : (next_x < current_x ? -1 : 0);
+            int direction_y = next_y > current_y ? 1 : (next_y < current_y ? -1 : 0);
+
+            double interpolated_x = current_x, interpolated_y = current_y;  // original point first
+            for (int k = 0; k <= interpolation_factor; k++)
+            {
+                if (k > 0)
+                {   // stepping keeps the rounding of the original increment/decrement interpolation
+                    interpolated_x = direction_x > 0 ? interpolated_x + inc_x : (direction_x < 0 ? interpolated_x - inc_x : current_x);
+                    interpolated_y = direction_y > 0 ? interpolated_y + inc_y : (direction_y < 0 ? interpolated_y - inc_y : current_y);
+                }
+                lut_x[lut_counter] = (std::int16_t)interpolated_x;
+                lut_y[lut_counter] = (std::int16_t)interpolated_y;
+                lut_counter++;
+            }
+        }
+        lut_x[lut_counter] = (std::int16_t)points[n - 1].get_x();   // last point, no interpolation
+        lut_y[lut_counter] = (std::int16_t)points[n - 1].get_y();
+
+        // rest of the table with reverse values i.e. end -> start
+        std::size_t reverse_counter = lut_counter;
+        for (lut_counter++; lut_counter < lut_size; lut_counter++, reverse_counter--)
+        {
+            lut_x[lut_counter] = lut_x[reverse_counter];
+            lut_y[lut_counter] = lut_y[reverse_counter];
+        }
+    }
+
+    inline float phase_increment(float freq, int sampling_rate, std::uint32_t lut_size)
+    {
+        return (freq / (float)sampling_rate) * (float)lut_size;
+    }
+
+    // renders num_frames frames, x_out[i * stride] and y_out[i * stride], phase continues across calls.
+    // cycle_end given: stops after the last frame of the current cycle. Returns the frames rendered
+    inline std::size_t render(const render_tables &tables, float increment, phase_state &state, std::int16_t* x_out,
+                              std::int16_t* y_out, std::size_t stride, std::size_t num_frames, bool* cycle_end = nullptr)
+    {
+        if (cycle_end)
+            *cycle_end = false;
+        if (tables.lut_size == 0)
+            return 0;       // no table: nothing rendered, the output is left as it is
+        const float size = (float)tables.lut_size;
+        float phase_x = state.phase_x, phase_y = state.phase_y;
+        for (std::size_t i = 0; i < num_frames; ++i)
+        {
+            x_out[i * stride] = tables.table_x[(int)phase_x];
+            phase_x += increment;
+            bool wrapped = phase_x >= size;
+            while (phase_x >= size)     // handle wraparound
+                phase_x -= size;
+
+            y_out[i * stride] = tables.table_y[(int)phase_y];
+            phase_y += increment;
+            while (phase_y >= size)
+                phase_y -= size;
+
+            if (wrapped && cycle_end)
+            {
+                *cycle_end = true;
+                num_frames = i + 1;
+            }
+        }
+
+        if (tables.trigger && state.frame < TRIGGER_FRAMES)
+        {   // trigger pulse, TRIGGER_LEVEL and then TRIGGER_FALLING_FRAMES at -TRIGGER_LEVEL
+            for (std::uint64_t f = state.frame; f < TRIGGER_FRAMES && f - state.frame < num_frames; f++)
+            {
+                std::int16_t level = f < TRIGGER_FRAMES - TRIGGER_FALLING_FRAMES ? TRIGGER_LEVEL : -TRIGGER_LEVEL;
+                x_out[(f - state.frame) * stride] = level;
+                y_out[(f - state.frame) * stride] = level;
+            }
+        }
+        state.phase_x = phase_x;
+        state.phase_y = phase_y;
+        state.frame += num_frames;
+        return num_frames;
+    }
+
+    inline void put_le(unsigned char* out, std::uint32_t value, int size)
+    {
+        for (int i = 0; i < size; i++, value >>= 8)
+            out[i] = (unsigned char)(value & 0xFF);
+    }
+
+    // 44 byte header of a 16 bit stereo pcm wav (RIFF, fmt and data chunk header)
+    inline void write_wav_header(std::ostream &out, int sampling_rate, std::uint32_t num_frames)
+    {
+        const int BITS_PER_SAMPLE = 16;
+        const int NUM_CHANNELS = 2;
+        const int BLOCK_ALIGN = NUM_CHANNELS * BITS_PER_SAMPLE / 8;
+        unsigned char header[44];
+        std::uint32_t data_size = num_frames * BLOCK_ALIGN;
+
+        std::copy_n("RIFF", 4, header);
+        put_le(header + 4, 36 + data_size, 4);
+        std::copy_n("WAVEfmt ", 8, header + 8);
+        put_le(header + 16, 16, 4);                     // size of the rest of the fmt chunk for PCM
+        put_le(header + 20, 1, 2);                      // 1=PCM
+        put_le(header + 22, NUM_CHANNELS, 2);
+        put_le(header + 24, sampling_rate, 4);
+        put_le(header + 28, sampling_rate * BLOCK_ALIGN, 4);   // byte rate
+        put_le(header + 32, BLOCK_ALIGN, 2);
+        put_le(header + 34, BITS_PER_SAMPLE, 2);
+        std::copy_n("data", 4, header + 36);
+        put_le(header + 40, data_size, 4);
+        out.write((const char*)header, sizeof(header));
+    }
+
+    // x to the left and y to the right channel, little endian, PCM_CHUNK_FRAMES frames per write
+    inline void write_pcm(std::ostream &out, const std::int16_t* x, const std::int16_t* y, std::size_t stride, std::size_t num_frames)
+    {
+        unsigned char chunk[PCM_CHUNK_FRAMES * 4];
+        for (std::size_t start = 0; start < num_frames; start += PCM_CHUNK_FRAMES)
+        {
+            std::size_t count = std::min(PCM_CHUNK_FRAMES, num_frames - start);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                put_le(chunk + 4 * i, (std::uint16_t)x[(start + i) * stride], 2);
+                put_le(chunk + 4 * i + 2, (std::uint16_t)y[(start + i) * stride], 2);
+            }
+            out.write((const char*)chunk, count * 4);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*H**********************************************************************
+* FILENAME :        laser_ctl.c
+*
+* DESCRIPTION :
+*       Command line client of the laser_player control socket (--control=, control_socket.h): sends one command
+*       and prints the reply line. For scripts and for testing the player with the null device.
+*
+How to build:
+    gcc -O2 laser_ctl.c control_socket.c -o laser_ctl
+
+How to call:
+    ./laser_ctl <socket> <command> [arguments]
+    e.g.  ./laser_ctl /tmp/laser.sock load svg/batman.txt
+          ./laser_ctl /tmp/laser.sock freq 20
+          ./laser_ctl /tmp/laser.sock stats
+
+Note:
+    -- exit code 0 for an "ok" reply, 1 for "error", negative if the player can not be reached or does not answer
+       within CTL_REPLY_MS (load answers once the lookup table is built)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "control_socket.h"
+
+#define CTL_REPLY_MS 5000
+
+int main(int argc, char *argv[])
+{
+    char line[CTL_LINE_MAX], reply[CTL_LINE_MAX];
+    int fd, i, length = 0, used = 0;
+    ssize_t got;
+    struct pollfd pfd;
+
+    if (argc < 3)
+    {
+        printf("Input Error: usage %s <socket> <command> [arguments]\n", argv[0]);
+        return -1;
+    }
+    for (i = 2; i < argc; i++)
+    {
+        int n = snprintf(line + length, sizeof(line) - length, "%s%s", i > 2 ? " " : "", argv[i]);
+        if (n < 0 || length + n >= (int)sizeof(line) - 1)
+        {
+            printf("Input Error: command longer than %d characters\n", CTL_LINE_MAX - 2);
+            return -1;
+        }
+        length += n;
+    }
+    line[length++] = '\n';
+
+    if ((fd = ctl_connect(argv[1])) < 0)
+    {
+        printf("ERROR: Can't connect to %s. %s\n", argv[1], strerror(-fd));
+        return -2;
+    }
+    if (write(fd, line, length) != length)
+    {
+        printf("ERROR: Can't send the command. %s\n", strerror(errno));
+        close(fd);
+        return -2;
+    }
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (used < CTL_LINE_MAX - 1 && !memchr(reply, '\n', used))
+    {
+        if (poll(&pfd, 1, CTL_REPLY_MS) <= 0 || (got = read(fd, reply + used, CTL_LINE_MAX - 1 - used)) <= 0)
+        {
+            printf("ERROR: no reply from %s\n", argv[1]);
+            close(fd);
+            return -3;
+        }
+        used += (int)got;
+    }
+    close(fd);
+    reply[used] = '\0';
+    printf("%s", reply);
+    return strncmp(reply, "ok", 2) == 0 ? 0 : 1;
+}
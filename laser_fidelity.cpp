@@ -0,0 +1,447 @@
+/*H**********************************************************************
+* FILENAME :        laser_fidelity.cpp
+*
+* DESCRIPTION :
+*       Measures how well a wav reproduces its points file after rescaling, lookup table interpolation, int16
+*       truncation, decimation and sampling: Hausdorff distance and mean nearest distance between the source
+*       shape and the decoded x/y trace, in output sample units (the drawing spans LASER_AMP_MULTIPLYER = 60000).
+*         samples -> shape   distance of every sample to the source polyline (consecutive points joined, the path
+*                            the lookup table interpolates along, jumps between strokes included)
+*         shape -> trace     distance of every source point to the trace (consecutive samples joined, the path the
+*                            beam moves along), catches corners that are cut or skipped at a low sample rate
+*         hausdorff          the larger of the two maxima
+*       Both sides go into a uniform grid of segments, a query walks rings of cells around its cell until no
+*       closer segment can exist, starting from the segment the previous query hit (consecutive samples are
+*       neighbours). Queries are split over threads.
+*       The sweep renders the shape in process for lookup table sizes and point budgets (decimate_budget) and
+*       finds the smallest ones that stay under the error threshold, printed as the svg_to_wav command line that
+*       renders them (--lut-size, --point-budget).
+*
+* PUBLIC FUNCTIONS :
+*   segment_grid(std::vector<segment> segments)
+*   double segment_grid::nearest(double px, double py, std::uint32_t &hint) const
+*   distance_stats directed_distance(const segment_grid &grid, std::size_t count, Point point, int threads)
+*   fidelity_result measure(const std::vector<segment> &shape, const std::int16_t* x, const std::int16_t* y,
+*                           std::size_t stride, std::size_t num_frames, int threads)
+*
+How to build:
+    g++ -O2 --std=c++17 -pthread laser_fidelity.cpp wav_reader.c -o laser_fidelity
+
+How to call:
+    1  ./laser_fidelity <points file> <file.wav>            compare a wav written by svg_to_wav with its points file
+    2  ./laser_fidelity <points file> --sweep [--freq=<Hz>] [--rate=<Hz>]
+                                                            lookup table sizes from 480000 down and point budgets from
+                                                            all points down, rendered in process, one cycle each
+    options:
+        --threshold=<units>     1: exit code 1 when the Hausdorff distance is larger, 2: the error limit of the sweep
+                                (default: off in 1, 150 = 0.25% of the drawing in 2)
+        --skip=<frames>         frames at the start of the wav that are not part of the shape (default 100, the
+                                oscilloscope trigger pulse of svg_to_wav)
+        --freq=<Hz>             sweep: cycles per second (default 100, as svg_to_wav)
+        --rate=<Hz>             sweep: sampling rate (default 48000)
+        --threads=<n>           measuring threads (default all cores)
+    e.g. ./laser_fidelity svg/batman.txt "svg/batman,10sec,0.10Hz,SR48000.wav" --threshold=2
+
+Note:
+    -- 16 bit pcm wav with at least 2 channels, x left and y right. The points are rescaled like svg_to_wav does
+       (height|width of the first line, 400|400 without it)
+    -- a wav from the optional stages that move the trace on purpose (--galvo-filter pre-emphasis overshoots,
+       --optimize-strokes changes the jumps between strokes) measures those changes too
+    -- the grid covers the whole int16 range, cells ~ sqrt(segments) per side. A segment is entered into every cell
+       its line crosses, long jumps cost one cell per row they cross
+    -- exit code 0 when measured (and under --threshold), 1 over the threshold, negative on an error
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include "laser_core.hpp"
+#include "decimate.hpp"
+#include "wav_reader.h"
+
+const double GRID_LOW = -32768.0, GRID_SPAN = 65536.0;     // the int16 range
+const int GRID_MIN_CELLS = 16, GRID_MAX_CELLS = 1024;       // per side
+const double SWEEP_DEFAULT_THRESHOLD = 150.0;
+const std::size_t SWEEP_MIN_POINTS = 16;
+
+struct fidelity_point{
+    double x, y;
+    fidelity_point() : x(0.0), y(0.0){}
+    fidelity_point(double mx, double my) : x(mx), y(my){}
+    double get_x() const { return x; }
+    double get_y() const { return y; }
+};
+
+struct segment{
+    float x0, y0, x1, y1;
+};
+
+// squared distance of (px, py) to a segment
+inline double segment_dist2(const segment &s, double px, double py)
+{
+    double dx = s.x1 - s.x0, dy = s.y1 - s.y0, length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? ((px - s.x0) * dx + (py - s.y0) * dy) / length2 : 0.0;
+    t = std::min(1.0, std::max(0.0, t));
+    double ex = s.x0 + t * dx - px, ey = s.y0 + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+// uniform grid over the int16 range, every cell lists the segments that cross it (compressed rows)
+class segment_grid{
+    public:
+        segment_grid(std::vector<segment> segments);
+        double nearest(double px, double py, std::uint32_t &hint) const;    // distance, hint: segment found
+        std::size_t size() const { return segments.size(); }
+    private:
+        template <typename Visit>
+        void for_each_cell(const segment &s, Visit visit) const;
+        int cell_of(double value) const { return std::min(cells - 1, std::max(0, (int)((value - GRID_LOW) / cell))); }
+
+        std::vector<segment> segments;
+        int cells;                          // per side
+        double cell;                        // side length in sample units
+        std::vector<std::uint32_t> start;   // items of cell c: items[start[c]] ... items[start[c + 1] - 1]
+        std::vector<std::uint32_t> items;   // segment ids
+};
+
+inline segment_grid::segment_grid(std::vector<segment> segments_in) : segments(std::move(segments_in))
+{
+    cells = std::min(GRID_MAX_CELLS, std::max(GRID_MIN_CELLS, (int)std::sqrt((double)segments.size())));
+    cell = GRID_SPAN / cells;
+    start.assign((std::size_t)cells * cells + 1, 0);
+    for (const segment &s : segments)
+        for_each_cell(s, [this](std::size_t c) { start[c + 1]++; });
+    for (std::size_t c = 1; c < start.size(); c++)
+        start[c] += start[c - 1];
+    items.resize(start.back());
+    std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+    for (std::uint32_t id = 0; id < (std::uint32_t)segments.size(); id++)
+        for_each_cell(segments[id], [&](std::size_t c) { items[fill[c]++] = id; });
+}
+
+// the cells of every row the segment crosses, between the x of the segment at the top and the bottom of the row
+template <typename Visit>
+inline void segment_grid::for_each_cell(const segment &s, Visit visit) const
+{
+    double low_y = std::min(s.y0, s.y1), high_y = std::max(s.y0, s.y1);
+    for (int row = cell_of(low_y), last_row = cell_of(high_y); row <= last_row; row++)
+    {
+        double band_low = std::max(low_y, GRID_LOW + row * cell), band_high = std::min(high_y, GRID_LOW + (row + 1) * cell);
+        double xa = s.x0, xb = s.x1;
+        if (s.y1 != s.y0)
+        {
+            xa = s.x0 + (band_low - s.y0) * (s.x1 - s.x0) / (s.y1 - s.y0);
+            xb = s.x0 + (band_high - s.y0) * (s.x1 - s.x0) / (s.y1 - s.y0);
+        }
+        for (int column = cell_of(std::min(xa, xb)), last_column = cell_of(std::max(xa, xb)); column <= last_column; column++)
+            visit((std::size_t)row * cells + column);
+    }
+}
+
+// rings of cells around the cell of the query until the ring is further away than the best segment so far
+inline double segment_grid::nearest(double px, double py, std::uint32_t &hint) const
+{
+    double best = hint < segments.size() ? segment_dist2(segments[hint], px, py) : std::numeric_limits<double>::max();
+    int cx = cell_of(px), cy = cell_of(py);
+    double cell_x = GRID_LOW + cx * cell, cell_y = GRID_LOW + cy * cell;
+    double edge = std::max(0.0, std::min(std::min(px - cell_x, cell_x + cell - px), std::min(py - cell_y, cell_y + cell - py)));
+
+    auto visit = [&](int column, int row) {
+        if (column < 0 || row < 0 || column >= cells || row >= cells)
+            return;
+        std::size_t c = (std::size_t)row * cells + column;
+        for (std::uint32_t i = start[c]; i < start[c + 1]; i++)
+        {
+            double d = segment_dist2(segments[items[i]], px, py);
+            if (d < best)
+            {
+                best = d;
+                hint = items[i];
+            }
+        }
+    };
+    for (int r = 0; r < cells; r++)
+    {
+        double bound = r > 0 ? (r - 1) * cell + edge : 0.0;    // closest a point of ring r can be
+        if (r > 0 && bound * bound >= best)
+            break;
+        if (r == 0)
+            visit(cx, cy);
+        for (int i = -r; r > 0 && i <= r; i++)
+        {
+            visit(cx + i, cy - r);
+            visit(cx + i, cy + r);
+        }
+        for (int i = -r + 1; r > 0 && i < r; i++)
+        {
+            visit(cx - r, cy + i);
+            visit(cx + r, cy + i);
+        }
+        if (cx - r <= 0 && cy - r <= 0 && cx + r >= cells - 1 && cy + r >= cells - 1)
+            break;  // the whole grid was searched
+    }
+    return std::sqrt(best);
+}
+
+struct distance_stats{
+    double sum = 0.0, max = 0.0, max_x = 0.0, max_y = 0.0;  // max_x/y: where the largest distance is
+    std::uint64_t count = 0;
+    double mean() const { return count ? sum / count : 0.0; }
+    void merge(const distance_stats &other)
+    {
+        sum += other.sum;
+        count += other.count;
+        if (other.max > max)
+            max = other.max, max_x = other.max_x, max_y = other.max_y;
+    }
+};
+
+// distance of count query points to the nearest segment of grid, point(i, x, y) gives query i
+template <typename Point>
+distance_stats directed_distance(const segment_grid &grid, std::size_t count, Point point, int threads)
+{
+    std::vector<distance_stats> partial(threads);
+    auto worker = [&](int index) {
+        std::size_t begin = count * index / threads, end = count * (index + 1) / threads;
+        std::uint32_t hint = std::numeric_limits<std::uint32_t>::max();
+        distance_stats &stats = partial[index];
+        for (std::size_t i = begin; i < end; i++)
+        {
+            double x, y;
+            point(i, x, y);
+            double d = grid.nearest(x, y, hint);
+            stats.sum += d;
+            stats.count++;
+            if (d > stats.max)
+                stats.max = d, stats.max_x = x, stats.max_y = y;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int index = 1; index < threads; index++)
+        workers.emplace_back(worker, index);
+    worker(0);
+    for (std::thread &thread : workers)
+        thread.join();
+    for (int index = 1; index < threads; index++)
+        partial[0].merge(partial[index]);
+    return partial[0];
+}
+
+struct fidelity_result{
+    distance_stats samples_to_shape, shape_to_trace;
+    double hausdorff() const { return std::max(samples_to_shape.max, shape_to_trace.max); }
+};
+
+// consecutive points joined, repeated points left out
+template <typename Point>
+std::vector<segment> polyline(std::size_t count, Point point)
+{
+    std::vector<segment> segments;
+    double x0 = 0, y0 = 0, x1, y1;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        point(i, x1, y1);
+        if (i == 0 && count == 1)
+            segments.push_back({(float)x1, (float)y1, (float)x1, (float)y1});
+        else if (i > 0 && (x1 != x0 || y1 != y0 || segments.empty()))
+            segments.push_back({(float)x0, (float)y0, (float)x1, (float)y1});
+        x0 = x1;
+        y0 = y1;
+    }
+    return segments;
+}
+
+// shape: source polyline. x/y: trace frames, sample i at x[i * stride], y[i * stride]
+fidelity_result measure(const std::vector<segment> &shape, const std::int16_t* x, const std::int16_t* y, std::size_t stride,
+                        std::size_t num_frames, int threads)
+{
+    fidelity_result result;
+    segment_grid shape_grid(shape);
+    result.samples_to_shape = directed_distance(shape_grid, num_frames,
+        [&](std::size_t i, double &px, double &py) { px = x[i * stride]; py = y[i * stride]; }, threads);
+
+    segment_grid trace_grid(polyline(num_frames, [&](std::size_t i, double &px, double &py) { px = x[i * stride]; py = y[i * stride]; }));
+    std::vector<std::pair<double, double>> points;     // shape points: start of every segment and the last end
+    for (const segment &s : shape)
+        points.push_back({s.x0, s.y0});
+    points.push_back({shape.back().x1, shape.back().y1});
+    result.shape_to_trace = directed_distance(trace_grid, points.size(),
+        [&](std::size_t i, double &px, double &py) { px = points[i].first; py = points[i].second; }, threads);
+    return result;
+}
+
+void print_result(const fidelity_result &result)
+{
+    std::cout << std::fixed << std::setprecision(2)
+              << "samples -> shape: mean " << result.samples_to_shape.mean() << ", max " << result.samples_to_shape.max
+              << " at (" << result.samples_to_shape.max_x << ", " << result.samples_to_shape.max_y << ")\n"
+              << "shape -> trace:   mean " << result.shape_to_trace.mean() << ", max " << result.shape_to_trace.max
+              << " at (" << result.shape_to_trace.max_x << ", " << result.shape_to_trace.max_y << ")\n"
+              << "hausdorff: " << result.hausdorff() << " units (" << std::setprecision(4)
+              << 100.0 * result.hausdorff() / LASER_AMP_MULTIPLYER << "% of the drawing), mean nearest distance: "
+              << std::setprecision(2) << result.samples_to_shape.mean() << std::endl;
+}
+
+// lut sizes from the default down, point budgets from all points down, one cycle of each rendered and measured
+int sweep(std::string points_file, const std::vector<fidelity_point> &points, const std::vector<segment> &shape, float freq, int rate,
+          double threshold, int threads)
+{
+    std::size_t cycle_frames = (std::size_t)std::ceil(rate / freq) + laser_core::TRIGGER_FRAMES;
+    std::vector<std::int16_t> frames(cycle_frames * 2);
+    std::uint32_t best_lut = 0;
+    std::size_t best_points = 0;
+
+    std::cout << std::setw(10) << "lut_size" << std::setw(10) << "points" << std::setw(12) << "hausdorff" << std::setw(10) << "mean" << std::endl;
+    for (std::size_t budget = points.size(); ; budget /= 2)
+    {
+        std::vector<fidelity_point> decimated = points;
+        if (budget < points.size())
+            decimate_budget(decimated, budget);
+        std::uint32_t previous_size = 0;
+        for (std::uint32_t max_lut_size = LASER_DEFAULT_LUT_SIZE; ; max_lut_size /= 2)
+        {
+            int interpolation_factor;
+            std::uint32_t lut_size = laser_core::size_lut(max_lut_size, decimated.size(), &interpolation_factor);
+            if (lut_size == previous_size)
+                break;  // the table does not get smaller, every point needs its entries
+            previous_size = lut_size;
+            std::vector<std::int16_t> lut_x(lut_size), lut_y(lut_size);
+            laser_core::build_input_lut(lut_x.data(), lut_y.data(), lut_size, decimated, interpolation_factor);
+            laser_core::render_tables tables = {lut_x.data(), lut_y.data(), lut_size, true};
+            laser_core::phase_state state;
+            laser_core::render(tables, laser_core::phase_increment(freq, rate, lut_size), state, frames.data(), frames.data() + 1, 2, cycle_frames);
+
+            std::size_t skip = laser_core::TRIGGER_FRAMES;
+            fidelity_result result = measure(shape, frames.data() + 2 * skip, frames.data() + 2 * skip + 1, 2, cycle_frames - skip, threads);
+            bool pass = result.hausdorff() <= threshold;
+            std::cout << std::setw(10) << lut_size << std::setw(10) << decimated.size() << std::fixed << std::setprecision(2)
+                      << std::setw(12) << result.hausdorff() << std::setw(10) << result.samples_to_shape.mean() << (pass ? "  PASS" : "  FAIL") << std::endl;
+            if (pass && (best_lut == 0 || lut_size < best_lut || (lut_size == best_lut && decimated.size() < best_points)))
+                best_lut = lut_size, best_points = decimated.size();
+        }
+        if (budget / 2 < SWEEP_MIN_POINTS)
+            break;
+    }
+    if (best_lut == 0)
+    {
+        std::cout << "no lut size and point budget under " << threshold << " units at " << freq << " Hz, " << rate << " Hz sampling rate" << std::endl;
+        return 1;
+    }
+    std::cout << "smallest under " << threshold << " units: lut_size " << best_lut << " with " << best_points << " points" << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6) << "    ./svg_to_wav " << points_file << " 10 " << freq << " " << rate << " --lut-size=" << best_lut
+              << (best_points < points.size() ? " --point-budget=" + std::to_string(best_points) : "") << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string points_file, wav_name;
+    bool sweep_mode = false;
+    double threshold = -1.0;
+    float freq = 100.0f;
+    int rate = 48000, threads = 0;
+    std::size_t skip = laser_core::TRIGGER_FRAMES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.compare("--sweep") == 0)
+            sweep_mode = true;
+        else if (arg.rfind("--threshold=", 0) == 0)
+            threshold = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--skip=", 0) == 0)
+            skip = (std::size_t)std::strtoul(value.c_str(), NULL, 10);
+        else if (arg.rfind("--freq=", 0) == 0)
+            freq = std::strtof(value.c_str(), NULL);
+        else if (arg.rfind("--rate=", 0) == 0)
+            rate = std::atoi(value.c_str());
+        else if (arg.rfind("--threads=", 0) == 0)
+            threads = std::atoi(value.c_str());
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+        else if (points_file.empty())
+            points_file = arg;
+        else if (wav_name.empty())
+            wav_name = arg;
+        else
+        {
+            std::cout << "Invalid argument: " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (points_file.empty() || (wav_name.empty() != sweep_mode))
+    {
+        std::cout << "Input Error: usage: laser_fidelity <points file> <file.wav> | --sweep [options], see laser_fidelity.cpp" << std::endl;
+        return -1;
+    }
+    if (!(freq > 0.0f) || rate <= 0 || rate < 2 * freq)
+    {
+        std::cout << "Invalid argument: --freq must be > 0 and below half of --rate" << std::endl;
+        return -1;
+    }
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // source points rescaled to output sample units like svg_to_wav
+    std::vector<fidelity_point> points;
+    int canvas_height = 400, canvas_width = 400, retval;
+    if ((retval = laser_core::load_points(points_file, points, &canvas_height, &canvas_width)) != LASER_OK || points.empty()
+        || canvas_height <= 0 || canvas_width <= 0)
+    {
+        std::cout << "Input Error: " << points_file << ": " << (retval == LASER_ERR_OPEN ? "can't open" : "no points or not a points file") << std::endl;
+        return -2;
+    }
+    for (fidelity_point &point : points)
+        laser_core::rescale(point.x, point.y, canvas_height, canvas_width, (double)LASER_AMP_MULTIPLYER);
+    std::vector<segment> shape = polyline(points.size(), [&](std::size_t i, double &x, double &y) { x = points[i].x; y = points[i].y; });
+
+    if (sweep_mode)
+        return sweep(points_file, points, shape, freq, rate, threshold >= 0 ? threshold : SWEEP_DEFAULT_THRESHOLD, threads);
+
+    wav_file wav;
+    if ((retval = wav_open(&wav, wav_name.c_str())) != WAV_OK)
+    {
+        std::cout << "Input Error: " << wav_name << ": " << wav_strerror(retval) << std::endl;
+        return -2;
+    }
+    if (wav.format != WAV_FORMAT_PCM || wav.bits_per_sample != 16 || wav.channels < 2 || wav.num_frames <= skip)
+    {
+        std::cout << "Input Error: " << wav_name << " is not a 16 bit pcm wav of 2 channels and more than " << skip << " frames" << std::endl;
+        wav_close(&wav);
+        return -2;
+    }
+    const std::int16_t* samples = (const std::int16_t*)wav.data;     // 2 byte aligned in the mapping, little endian host
+    std::size_t stride = wav.block_align / 2, num_frames = wav.num_frames - skip;
+
+    auto start = std::chrono::steady_clock::now();
+    fidelity_result result = measure(shape, samples + skip * stride, samples + skip * stride + 1, stride, num_frames, threads);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    wav_close(&wav);
+
+    std::cout << points_file << ": " << points.size() << " points, " << wav_name << ": " << num_frames << " frames (" << skip << " skipped)" << std::endl;
+    print_result(result);
+    std::cout << "measured in " << std::setprecision(1) << ms << " ms, " << num_frames / ms / 1e3 << " Msamples/s, " << threads << " threads" << std::endl;
+    if (threshold >= 0 && result.hausdorff() > threshold)
+    {
+        std::cout << "FAIL: hausdorff " << result.hausdorff() << " > threshold " << threshold << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,906 @@
+/*H**********************************************************************
+* FILENAME :        laser_player.cpp
+*
+* DESCRIPTION :
+*       Real time player. Loads a points file, builds the lookup table in memory (liblaser) and plays the laser
+*       signal on an ALSA device, no wav file and no pipe in between. A synthesis thread renders frames into a
+*       lock-free single producer / single consumer ring (spsc_ring.hpp), a high priority output thread drains
+*       the ring into the hardware buffer (mmap, snd_pcm_writei where the device has no mmap, pcm_output.h).
+*       Playback starts as soon as the lookup table is built.
+*
+* PUBLIC FUNCTIONS :
+*   int set_player_args(int argc, char* argv[], player_options & options)
+*   int build_live_shape(std::string input, float freq, unsigned int sampling_rate, unsigned int flags, live_shape** result)
+*   void free_live_shape(live_shape* live)
+*   void synthesize(live_shape* current, player_state & state, Ring & ring)
+*   void synthesis_thread(live_shape* current, player_state & state)
+*   void output_thread(pcm_output* out, player_state & state)
+*   void loader_thread(player_options options, player_state & state)
+*   int generate_shared(player_options options, std::string watched)
+*
+How to build:
+    g++ -O2 --std=c++17 -pthread laser_player.cpp liblaser.cpp pcm_output.c rt_profile.c control_socket.c shm_ring.c -o laser_player -lasound
+    gcc -O2 laser_ctl.c control_socket.c -o laser_ctl
+
+How to call:
+    ./laser_player <points file | directory | sine | rect> <freq> <sampling_rate> [options]
+    options:
+        --device=<pcm>          ALSA pcm (default "default"), e.g. hw:0,0, plughw:1,0, null, file:'out.raw',raw
+        --seconds=<s>           play s seconds and stop (default: until Ctrl-C)
+        --period=<frames>       ALSA period size (default: from the profile, else 1024)
+        --periods=<n>           ALSA buffer size in periods (default: from the profile, else 4)
+        --ring-ms=<ms>          ring between synthesis and output (default 200)
+        --access=<mode>         auto (default: mmap, rw if not supported), mmap or rw
+        --profile=<file>        device profiles written by alsa_tune (default alsa.profile). The line of the device,
+                                rate and 2 channels sets period, periods and access unless they are given
+        --no-trigger            no oscilloscope trigger pulse at the start of the shape
+        --watch                 hot-swap: watch the points file (or the directory, any *.txt in it) with inotify and
+                                switch to the new shape when it is written. A directory starts with its newest *.txt
+        --rt                    real time mode (rt_profile.h): lock memory, prefault the ring and the output stack, pin
+                                the output thread, print wake-up latency and write duration histograms at the end
+        --rt-cpu=<n>            cpu of the output thread with --rt (default: the first isolated cpu, none if none is)
+        --rt-priority=<p>       SCHED_FIFO priority of the output thread (default 49)
+        --control=<socket>      control socket (control_socket.h), commands one per line, answered with "ok ..." or
+                                "error ...":
+                                    load <points file | sine | rect>    switch shape at the end of the playing cycle
+                                    freq <hz>                           repetition frequency, from the next period
+                                    scale <0..1>                        amplitude of x and y
+                                    pause / resume                      silence (beam at the centre) / play on
+                                    stats                               frames, underruns, xruns, settings
+                                    stop                                end playback as with Ctrl-C
+        --shm-out=<name>        generator only: render into the shared memory ring <name> (shm_ring.h) instead of an
+                                ALSA device, for a player in another process: ./alsa-wav shm:<name> [device] ...
+                                The ring is --ring-ms long, --seconds, --watch and --period (render block) apply
+
+    e.g.  ./laser_player svg/batman.txt 10 48000 --device=hw:0,0
+
+Testing without a sound card:
+    -- ./laser_player svg/batman.txt 10 48000 --device=null --seconds=10
+       the null plugin consumes frames at the real rate, xruns (with their recovery time) and ring underruns are
+       printed at the end
+    -- ./laser_player svg/batman.txt 0.1 48000 --device=file:'batman.raw',raw --seconds=10
+       the file plugin writes every frame to batman.raw, which is byte identical to the data chunk of
+       ./svg_to_wav batman.txt 10 0.1 48000 (same renderer, see laser.h)
+    -- ./laser_player sine 10 48000 --device=null --control=/tmp/laser.sock &
+       ./laser_ctl /tmp/laser.sock stats;  ./laser_ctl /tmp/laser.sock load svg/batman.txt;  ./laser_ctl /tmp/laser.sock stop
+    -- ./laser_player svg/batman.txt 10 48000 --shm-out=laser --seconds=10 &  ./alsa-wav shm:laser null
+       generator and player in two processes, the player prints the frames it got and the underruns of the ring
+
+Note:
+    -- the output thread asks for SCHED_FIFO, without the rights (root, or rtprio in /etc/security/limits.conf)
+       it keeps running with normal priority and says so. The same for every step of --rt (memlock limit,
+       cpu not allowed): a Note, and playback goes on without it
+    -- --rt on a Raspberry Pi: isolcpus=3 in /boot/cmdline.txt keeps other tasks off cpu 3, which --rt then uses
+    -- with --seconds exactly seconds * sampling_rate frames are played, then the device is drained
+    -- an xrun (-EPIPE) is counted and recovered with snd_pcm_recover, playback continues
+    -- --access=auto falls back to rw on a device or plugin without mmap, the access in use is printed
+    -- hot-swap: the loader thread loads the changed file and builds its lookup table and renderer, then publishes it
+       with an atomic pointer exchange. The synthesis thread takes it at the next cycle end of the current shape
+       (laser_render_to_cycle_end), so no trace is cut and no period is missed. The old shape goes back through a
+       second ring and is freed by the loader thread, never by the threads on the audio path. A file that does not
+       load (half written, wrong format) is reported and the current shape keeps playing
+    -- flush: the synthesis thread runs up to --ring-ms ahead of the device. On a freq command or a published shape
+       the output thread stops reading the ring and asks the synthesis thread to rewind its renderer to the frame
+       played next (laser_renderer_rewind) and to render on from there with the new freq, or up to the next cycle end
+       of the playing shape and then the new one. The output thread drops the frames rendered ahead and plays the
+       new ones from the next period on. A shape swapped in but not heard yet starts again after the old one
+    -- control: the output thread polls the ALSA descriptors and the socket in one poll() and answers between two
+       periods with non blocking sends, a command never makes it wait. scale and pause apply to the next period
+       written, freq (flush) from the next period on. load goes to the loader thread (the one that watches with
+       --watch), which builds the shape off the audio path and answers when it is published; it switches like a
+       hot-swap, at the end of the cycle that is playing then
+    -- --shm-out: the synthesis loop renders straight into the shared pages, the player copies them straight into
+       its ALSA buffer. The generator waits while the ring is full, so it runs at the pace of the player; it marks
+       the ring done at the end and the player drains it. A player started later picks up the frames from the
+       start of the ring. --control and --rt belong to the ALSA output and are refused with --shm-out
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "control_socket.h"
+#include "laser.h"
+#include "pcm_output.h"
+#include "rt_profile.h"
+#include "shm_ring.h"
+#include "spsc_ring.hpp"
+
+const int CHANNELS = 2;                     // x left, y right, interleaved
+const int WATCH_POLL_MS = 100;              // loader thread checks the stop flag and frees retired shapes this often
+const std::size_t RETIRED_SHAPES = 16;
+const std::size_t LOAD_REQUESTS = 8;        // load commands waiting for the loader thread
+const int MAX_POLL_FDS = 32;                // ALSA descriptors + control socket and its clients
+const int FLUSH_NONE = 0;                   // flush: output thread -> requested -> synthesis thread -> ready -> none
+const int FLUSH_REQUESTED = 1;
+const int FLUSH_READY = 2;
+namespace fs = std::filesystem;
+
+struct player_options{
+    std::string input = "";
+    float freq = 0.0f;
+    unsigned int sampling_rate = 0;
+    std::string device = "default";
+    double seconds = 0.0;                   // 0 = until Ctrl-C
+    snd_pcm_uframes_t period = 1024;
+    unsigned int periods = 4;
+    bool buffer_given = false;              // --period/--periods/--access on the command line
+    std::string profile_file = PCM_PROFILE_FILE;
+    unsigned int ring_ms = 200;
+    int access = PCM_ACCESS_AUTO;
+    bool trigger = true;
+    bool watch = false;
+    bool rt = false;
+    int rt_cpu = -1;                        // -1: first isolated cpu
+    int rt_priority = RT_DEFAULT_PRIORITY;
+    std::string control = "";               // control socket path, "" = none
+    std::string shm_out = "";               // shared memory ring name, "" = play on ALSA
+};
+
+// one playable shape, owned by exactly one thread at a time
+struct live_shape{
+    std::string name;
+    laser_shape* shape = NULL;
+    laser_lut* lut = NULL;
+    laser_renderer* renderer = NULL;
+};
+
+// control: output thread -> loader thread and back, fixed size so the output thread does not allocate
+struct load_request{
+    int client;
+    unsigned int generation;
+    char path[CTL_LINE_MAX];
+};
+
+struct load_result{
+    int client;
+    unsigned int generation;
+    char text[CTL_LINE_MAX];
+};
+
+struct player_state{
+    spsc_ring<std::int16_t> ring;           // interleaved samples, always whole frames
+    std::uint64_t total_frames;             // 0 = endless
+    snd_pcm_uframes_t period;
+    std::atomic<bool> synthesis_done{false};
+    // hot-swap: loader thread -> pending -> synthesis thread -> retired -> loader thread
+    std::atomic<live_shape*> pending{nullptr};
+    spsc_ring<live_shape*> retired;
+    unsigned int swaps = 0;                 // written by the synthesis thread
+    std::uint64_t frames_rendered = 0;
+    live_shape* last_shape = nullptr;
+    std::atomic<float> freq{0.0f};          // set by the control, taken by the synthesis thread with a flush
+    std::atomic<unsigned int> published{0}; // shapes published by the loader thread, each one flushes
+    // flush, the plain fields are handed over with the release/acquire of flush. Frame numbers count every frame
+    // that went through the ring, dropped ones included
+    std::atomic<int> flush{FLUSH_NONE};
+    std::uint64_t flush_from = 0;           // frame played next, set by the output thread with the request
+    std::uint64_t discard_from = 0;         // frames the output thread drops, set by the synthesis thread when ready
+    std::uint64_t discard_to = 0;
+    std::uint64_t shape_start = 0;          // first frame of the current shape, synthesis thread only
+    // control: load commands to the loader thread (woken by loader_event) and its answers back
+    spsc_ring<load_request> load_requests;
+    spsc_ring<load_result> load_results;
+    int loader_event = -1;
+    ctl_server* control = nullptr;          // owned by main, served by the output thread
+    // statistics, written by the output thread, read after join
+    std::uint64_t frames_played = 0;
+    unsigned int ring_underruns = 0;
+    std::size_t min_ring_frames = SIZE_MAX;
+    double first_write_ms = 0.0;
+    std::uint64_t paused_frames = 0;
+    // output thread setup
+    int output_priority = RT_DEFAULT_PRIORITY;
+    int output_cpu = -1;                    // -1: not pinned
+    bool rt = false;
+
+    player_state(std::size_t ring_samples) : ring(ring_samples), retired(RETIRED_SHAPES),
+                                             load_requests(LOAD_REQUESTS), load_results(LOAD_REQUESTS){}
+};
+
+std::atomic<bool> stop_requested{false};    // set by SIGINT/SIGTERM
+std::chrono::steady_clock::time_point start_time;
+
+void on_signal(int){
+    stop_requested.store(true);
+}
+
+double elapsed_ms(){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+int set_player_args(int argc, char* argv[], player_options & options){
+    int positional = 0;
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0){
+            if (positional == 0)
+                options.input = arg;
+            else if (positional == 1)
+                options.freq = std::strtof(arg.c_str(), NULL);
+            else if (positional == 2)
+                options.sampling_rate = (unsigned int)std::strtoul(arg.c_str(), NULL, 10);
+            positional++;
+        }
+        else if (arg.rfind("--device=", 0) == 0)
+            options.device = arg.substr(9);
+        else if (arg.rfind("--seconds=", 0) == 0)
+            options.seconds = std::strtod(arg.substr(10).c_str(), NULL);
+        else if (arg.rfind("--period=", 0) == 0){
+            options.period = std::strtoul(arg.substr(9).c_str(), NULL, 10);
+            options.buffer_given = true;
+        }
+        else if (arg.rfind("--periods=", 0) == 0){
+            options.periods = (unsigned int)std::strtoul(arg.substr(10).c_str(), NULL, 10);
+            options.buffer_given = true;
+        }
+        else if (arg.rfind("--profile=", 0) == 0)
+            options.profile_file = arg.substr(10);
+        else if (arg.rfind("--ring-ms=", 0) == 0)
+            options.ring_ms = (unsigned int)std::strtoul(arg.substr(10).c_str(), NULL, 10);
+        else if (arg.rfind("--access=", 0) == 0){
+            options.access = pcm_output_parse_access(arg.substr(9).c_str());
+            if (options.access < 0){
+                std::cout << "Invalid argument: --access must be auto, mmap or rw" << std::endl;
+                return -3;
+            }
+            options.buffer_given = true;
+        }
+        else if (arg.compare("--no-trigger") == 0)
+            options.trigger = false;
+        else if (arg.compare("--watch") == 0)
+            options.watch = true;
+        else if (arg.rfind("--control=", 0) == 0)
+            options.control = arg.substr(10);
+        else if (arg.rfind("--shm-out=", 0) == 0)
+            options.shm_out = arg.substr(10);
+        else if (arg.compare("--rt") == 0)
+            options.rt = true;
+        else if (arg.rfind("--rt-cpu=", 0) == 0)
+            options.rt_cpu = std::atoi(arg.substr(9).c_str());
+        else if (arg.rfind("--rt-priority=", 0) == 0){
+            options.rt_priority = std::atoi(arg.substr(14).c_str());
+            if (options.rt_priority < sched_get_priority_min(SCHED_FIFO) || options.rt_priority > sched_get_priority_max(SCHED_FIFO)){
+                std::cout << "Invalid argument: --rt-priority must be between " << sched_get_priority_min(SCHED_FIFO)
+                          << " and " << sched_get_priority_max(SCHED_FIFO) << std::endl;
+                return -3;
+            }
+        }
+        else{
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (positional != 3){
+        std::cout << "Input Error: usage " << argv[0] << " <points file | sine | rect> <freq> <sampling_rate> [options]" << std::endl;
+        return -1;
+    }
+    if (!(options.freq > 0.0f) || options.sampling_rate == 0){
+        std::cout << "Input Error: freq and sampling_rate must be larger than 0" << std::endl;
+        return -2;
+    }
+    if (options.period == 0 || options.periods < 2 || options.ring_ms == 0 || options.seconds < 0.0){
+        std::cout << "Invalid argument: --period, --ring-ms must be larger than 0, --periods at least 2" << std::endl;
+        return -3;
+    }
+    if (!options.shm_out.empty() && (!options.control.empty() || options.rt)){
+        std::cout << "Invalid argument: --control and --rt need the ALSA output, not --shm-out" << std::endl;
+        return -3;
+    }
+    return 0;
+}
+
+void free_live_shape(live_shape* live){
+    if (!live)
+        return;
+    laser_renderer_free(live->renderer);
+    laser_lut_free(live->lut);
+    laser_shape_free(live->shape);
+    delete live;
+}
+
+// points file, or sine/rect, to shape, lookup table and renderer
+int build_live_shape(std::string input, float freq, unsigned int sampling_rate, unsigned int flags, live_shape** result){
+    int retval;
+    live_shape* live = new live_shape();
+    live->name = input;
+    int wave = input.compare("sine") == 0 ? LASER_WAVE_SINE :
+               input.compare("rect") == 0 ? LASER_WAVE_RECTANGLE : LASER_WAVE_INPUT;
+    if ((wave == LASER_WAVE_INPUT && (retval = laser_shape_load(input.c_str(), &live->shape)) != LASER_OK) ||
+        (retval = laser_lut_build(live->shape, wave, 0, &live->lut)) != LASER_OK ||
+        (retval = laser_renderer_create(live->lut, freq, (int)sampling_rate, flags, &live->renderer)) != LASER_OK){
+        free_live_shape(live);
+        return retval;
+    }
+    *result = live;
+    return LASER_OK;
+}
+
+// renders frames interleaved frames into out, the first one is frame position of the ring. A pending shape is
+// taken at the end of a cycle of the current one and plays freq from there on
+void render_frames(live_shape* & current, player_state & state, std::uint64_t position, float freq, std::int16_t* out, std::size_t frames){
+    while (frames > 0){
+        if (state.pending.load(std::memory_order_relaxed) == nullptr){
+            laser_render(current->renderer, out, frames);
+            return;
+        }
+        std::size_t rendered;
+        int cycle_end;
+        laser_render_to_cycle_end(current->renderer, out, frames, &rendered, &cycle_end);
+        out += rendered * CHANNELS;
+        frames -= rendered;
+        position += rendered;
+        if (cycle_end && state.retired.write_available() > 0){     // else retry at the next cycle end
+            live_shape* next = state.pending.exchange(nullptr, std::memory_order_acquire);
+            state.retired.write(&current, 1);
+            current = next;
+            laser_renderer_set_freq(current->renderer, freq);  // built before a freq command, the rest of the block too
+            state.swaps++;
+            state.shape_start = position;
+        }
+    }
+}
+
+// the shared memory ring seen through the write side of spsc_ring, counts in samples
+struct shared_ring_writer{
+    shm_ring* ring;
+
+    std::size_t write_regions(ring_regions<std::int16_t> & regions){
+        shm_regions shared;
+        std::uint64_t frames = shm_ring_write_regions(ring, &shared);
+        regions.first = shared.first;
+        regions.first_count = (std::size_t)shared.first_frames * CHANNELS;
+        regions.second = shared.second;
+        regions.second_count = (std::size_t)shared.second_frames * CHANNELS;
+        return (std::size_t)frames * CHANNELS;
+    }
+    void commit_write(std::size_t samples){
+        shm_ring_commit_write(ring, samples / CHANNELS);
+    }
+};
+
+// the output thread waits for the answer and reads nothing meanwhile, every frame from flush_from on is still in the
+// ring. Rewinds the renderer to flush_from and takes the new freq, returns the frames the output thread drops
+std::uint64_t answer_flush(live_shape* current, player_state & state, std::uint64_t rendered, float freq){
+    if (state.flush_from >= state.shape_start){
+        laser_renderer_rewind(current->renderer, (std::size_t)(rendered - state.flush_from));
+        state.discard_from = state.flush_from;
+    }
+    else{
+        // swapped in while the old shape still plays: the old one ends its cycle, the new one starts again after it
+        laser_renderer_reset(current->renderer);
+        state.discard_from = state.shape_start;
+    }
+    state.discard_to = rendered;
+    laser_renderer_set_freq(current->renderer, freq);
+    state.flush.store(FLUSH_READY, std::memory_order_release);
+    return state.discard_to - state.discard_from;
+}
+
+// renders whole periods into the free part of the ring (state.ring or the shared one), sleeps while it is full
+template <typename Ring>
+void synthesize(live_shape* current, player_state & state, Ring & ring){
+    std::uint64_t rendered = 0, total = state.total_frames;    // total grows by the dropped frames
+    ring_regions<std::int16_t> regions;
+    float freq = state.freq.load(std::memory_order_relaxed);   // freq of the current shape, a swapped in one takes it
+    while (!stop_requested.load(std::memory_order_relaxed) && (total == 0 || rendered < total)){
+        if (state.flush.load(std::memory_order_acquire) == FLUSH_REQUESTED){
+            freq = state.freq.load(std::memory_order_relaxed);
+            std::uint64_t dropped = answer_flush(current, state, rendered, freq);
+            if (total != 0)
+                total += dropped;
+        }
+        std::size_t free_frames = ring.write_regions(regions) / CHANNELS;
+        if (free_frames < state.period){
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+            continue;
+        }
+        std::size_t frames = free_frames;
+        if (total != 0 && frames > total - rendered)
+            frames = (std::size_t)(total - rendered);
+        std::size_t first = std::min(frames, regions.first_count / CHANNELS);
+        render_frames(current, state, rendered, freq, regions.first, first);
+        render_frames(current, state, rendered + first, freq, regions.second, frames - first);
+        ring.commit_write(frames * CHANNELS);
+        rendered += frames;
+    }
+    state.frames_rendered = rendered;
+    state.last_shape = current;     // freed by main after join
+    state.synthesis_done.store(true, std::memory_order_release);
+}
+
+void synthesis_thread(live_shape* current, player_state & state){
+    synthesize(current, state, state.ring);
+}
+
+// output thread side of the control, only touched by the output thread
+struct control_context{
+    player_state* state;
+    pcm_output* out;
+    float scale = 1.0f;
+    bool paused = false;
+    bool refresh = false;                   // freq command, flush before the next period
+};
+
+// one command line of a client, answered at once except load (answered by the loader thread when it is done)
+void handle_command(ctl_server* server, int client, const char* line, void* user){
+    control_context & ctx = *(control_context*)user;
+    player_state & state = *ctx.state;
+    unsigned int generation = ctl_server_generation(server, client);
+    char command[16] = "", reply[CTL_LINE_MAX];
+    int skip = 0;
+    std::sscanf(line, " %15s %n", command, &skip);
+    const char* arg = line + skip;
+    float value = std::strtof(arg, NULL);
+
+    if (std::strcmp(command, "stats") == 0)
+        std::snprintf(reply, sizeof(reply), "ok frames %llu paused_frames %llu ring_ms %.1f underruns %u xruns %lu freq %g scale %g %s",
+                      (unsigned long long)state.frames_played, (unsigned long long)state.paused_frames,
+                      state.ring.read_available() / CHANNELS * 1000.0 / ctx.out->rate, state.ring_underruns, ctx.out->xruns,
+                      state.freq.load(), ctx.scale, ctx.paused ? "paused" : "playing");
+    else if (std::strcmp(command, "scale") == 0 && *arg && value >= 0.0f && value <= 1.0f){
+        ctx.scale = value;
+        std::snprintf(reply, sizeof(reply), "ok scale %g", value);
+    }
+    else if (std::strcmp(command, "freq") == 0 && value > 0.0f){
+        state.freq.store(value);
+        ctx.refresh = true;
+        std::snprintf(reply, sizeof(reply), "ok freq %g from the next period", value);
+    }
+    else if (std::strcmp(command, "pause") == 0 || std::strcmp(command, "resume") == 0){
+        ctx.paused = command[0] == 'p';
+        std::snprintf(reply, sizeof(reply), "ok %s", ctx.paused ? "paused" : "playing");
+    }
+    else if (std::strcmp(command, "stop") == 0){
+        stop_requested.store(true);
+        std::snprintf(reply, sizeof(reply), "ok stopping");
+    }
+    else if (std::strcmp(command, "load") == 0 && *arg){
+        load_request request;
+        request.client = client;
+        request.generation = generation;
+        std::snprintf(request.path, sizeof(request.path), "%s", arg);
+        std::uint64_t one = 1;
+        if (state.load_requests.write(&request, 1) == 1 && write(state.loader_event, &one, sizeof(one)) == sizeof(one))
+            return;
+        std::snprintf(reply, sizeof(reply), "error busy loading");
+    }
+    else if (std::strcmp(command, "scale") == 0 || std::strcmp(command, "freq") == 0 || std::strcmp(command, "load") == 0)
+        std::snprintf(reply, sizeof(reply), "error %s needs %s", command,
+                      command[0] == 's' ? "a value from 0 to 1" : command[0] == 'f' ? "a frequency above 0" : "a points file, sine or rect");
+    else
+        std::snprintf(reply, sizeof(reply), "error unknown command, try load, freq, scale, pause, resume, stats, stop");
+    ctl_server_reply(server, client, generation, reply);
+}
+
+// one poll() on the ALSA descriptors and the control socket, true when a period can be written
+bool poll_output(pcm_output* out, control_context & ctx){
+    player_state & state = *ctx.state;
+    pollfd pfds[MAX_POLL_FDS];
+    int alsa_fds = std::max(pcm_output_poll_descriptors(out, pfds, MAX_POLL_FDS), 0);
+    int control_fds = ctl_server_fds(state.control, pfds + alsa_fds, MAX_POLL_FDS - alsa_fds);
+    // not running: begin/commit fill or recover it without waiting, only look at the socket
+    bool running = snd_pcm_state(out->pcm) == SND_PCM_STATE_RUNNING;
+    if (poll(pfds, alsa_fds + control_fds, running ? PCM_OUTPUT_WAIT_MS : 0) < 0)
+        return false;   // EINTR, check the stop flag
+    ctl_server_handle(state.control, pfds + alsa_fds, control_fds, handle_command, &ctx);
+    load_result result;
+    while (state.load_results.read(&result, 1) == 1)
+        ctl_server_reply(state.control, result.client, result.generation, result.text);
+    return !running || pcm_output_poll_ready(out, pfds, alsa_fds) != 0;
+}
+
+void scale_frames(std::int16_t* samples, std::size_t count, float scale){
+    for (std::size_t i = 0; i < count; i++)
+        samples[i] = (std::int16_t)(samples[i] * scale);
+}
+
+// asks for real time priority (and its cpu with --rt), then moves periods from the ring to the device
+void output_thread(pcm_output* out, player_state & state){
+    int err = rt_enter_thread(state.output_priority, state.output_cpu, stdout);
+    if (state.rt){
+        rt_prefault_stack();
+        std::cout << "output thread: " << ((err & RT_SCHED_FIFO) ? "SCHED_FIFO " + std::to_string(state.output_priority) : "normal priority")
+                  << ((err & RT_PINNED) ? ", cpu " + std::to_string(state.output_cpu) : ", not pinned") << std::endl;
+    }
+    err = 0;
+
+    control_context ctx;
+    ctx.state = &state;
+    ctx.out = out;
+    ring_regions<std::int16_t> regions;
+    bool starving = false;
+    std::uint64_t consumed = 0;                     // frames taken from the ring, played or dropped
+    unsigned int published = 0;                     // shapes published so far, a new one flushes
+    while (!stop_requested.load(std::memory_order_relaxed)){
+        if (state.control){
+            if (!poll_output(out, ctx))
+                continue;                           // nothing to write yet, or only a command
+            if (ctx.paused){
+                // silence instead of the ring, the synthesis waits on the full ring meanwhile
+                std::int16_t* frames;
+                snd_pcm_uframes_t count = state.period;
+                if ((err = pcm_output_begin(out, &frames, &count)) < 0)
+                    break;
+                if (count == 0)
+                    continue;
+                std::memset(frames, 0, count * CHANNELS * sizeof(std::int16_t));
+                if ((err = pcm_output_commit(out, count)) < 0)
+                    break;
+                state.paused_frames += count;
+                continue;
+            }
+        }
+        bool done = state.synthesis_done.load(std::memory_order_acquire);   // before reading the fill level
+        int flush = state.flush.load(std::memory_order_acquire);
+        if (flush == FLUSH_NONE && !done && (ctx.refresh || state.published.load(std::memory_order_relaxed) != published)){
+            ctx.refresh = false;
+            published = state.published.load(std::memory_order_relaxed);
+            state.flush_from = consumed;
+            state.flush.store(flush = FLUSH_REQUESTED, std::memory_order_release);
+        }
+        if (flush == FLUSH_REQUESTED){
+            if (!done){
+                std::this_thread::sleep_for(std::chrono::microseconds(100));   // answered before the next render
+                continue;
+            }
+            state.flush.store(flush = FLUSH_NONE, std::memory_order_relaxed);   // synthesis ended, nothing to redo
+        }
+        if (flush == FLUSH_READY && consumed == state.discard_from){
+            // the frames rendered ahead, the ones rendered again follow
+            state.ring.commit_read((std::size_t)(state.discard_to - state.discard_from) * CHANNELS);
+            consumed = state.discard_to;
+            state.flush.store(flush = FLUSH_NONE, std::memory_order_relaxed);
+            starving = true;                        // waiting for them is not a ring underrun
+        }
+        std::size_t available = state.ring.read_regions(regions) / CHANNELS;
+        if (available == 0 && done)
+            break;
+        if (available < state.period && !done){
+            if (state.frames_played != 0 && !starving)
+                state.ring_underruns++;             // synthesis fell behind, ALSA buffer is still playing
+            starving = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        starving = false;
+        state.min_ring_frames = std::min(state.min_ring_frames, available);
+
+        snd_pcm_uframes_t frames = std::min<std::size_t>(available, state.period);
+        if (flush == FLUSH_READY)
+            frames = std::min<std::uint64_t>(frames, state.discard_from - consumed);   // up to the old shape's cycle end
+        if (out->mmap){
+            // ring straight into the hardware buffer
+            std::int16_t* hw_frames;
+            if ((err = pcm_output_begin(out, &hw_frames, &frames)) < 0)
+                break;
+            if (frames == 0)
+                continue;                           // timeout, check the stop flag
+            state.ring.read(hw_frames, frames * CHANNELS);
+            if (ctx.scale != 1.0f)
+                scale_frames(hw_frames, frames * CHANNELS, ctx.scale);
+            err = pcm_output_commit(out, frames);
+        }
+        else{
+            // snd_pcm_writei from the contiguous first region, the wrap is picked up in the next round
+            frames = std::min<std::size_t>(frames, regions.first_count / CHANNELS);
+            if (ctx.scale != 1.0f)
+                scale_frames(regions.first, frames * CHANNELS, ctx.scale);     // the consumer owns the region until commit_read
+            snd_pcm_sframes_t written = pcm_output_write(out, regions.first, frames);
+            err = written < 0 ? (int)written : 0;
+            if (err == 0)
+                state.ring.commit_read(frames * CHANNELS);
+        }
+        if (err < 0)
+            break;
+        if (state.frames_played == 0)
+            state.first_write_ms = elapsed_ms();
+        state.frames_played += frames;
+        consumed += frames;
+    }
+    if (err < 0)
+        std::cout << "ERROR. Can't write to PCM device. " << snd_strerror(err) << std::endl;
+    pcm_output_close(out, !stop_requested.load());  // drain pending frames unless interrupted
+    stop_requested.store(true);  // synthesis stops too if output ended on an error
+}
+
+// newest *.txt of a directory, "" if there is none
+std::string newest_points_file(std::string dir){
+    std::string newest = "";
+    fs::file_time_type newest_time;
+    std::error_code ec;
+    for (const fs::directory_entry &entry : fs::directory_iterator(dir, ec)){
+        if (entry.path().extension() != ".txt" || !entry.is_regular_file(ec))
+            continue;
+        fs::file_time_type time = entry.last_write_time(ec);
+        if (newest.empty() || time > newest_time){
+            newest = entry.path().string();
+            newest_time = time;
+        }
+    }
+    return newest;
+}
+
+void free_retired(player_state & state){
+    live_shape* live;
+    while (state.retired.read(&live, 1) == 1)
+        free_live_shape(live);
+}
+
+// builds a shape for the current freq and publishes it for the synthesis thread, message for the control reply
+bool load_shape(std::string path, player_options & options, player_state & state, std::string & message){
+    live_shape* next;
+    auto build_start = std::chrono::steady_clock::now();
+    int retval = build_live_shape(path, state.freq.load(), options.sampling_rate, 0, &next);
+    if (retval != LASER_OK){
+        message = path + " not loaded (" + laser_strerror(retval) + ")";
+        std::cout << "Note: " << message << ", keeping the current shape" << std::endl;
+        return false;
+    }
+    message = "loaded " + path + ", lut size: " + std::to_string(laser_lut_size(next->lut)) + ", "
+              + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count())
+              + " ms, switching at the end of the cycle";
+    std::cout << message << std::endl;
+    free_live_shape(state.pending.exchange(next, std::memory_order_acq_rel));   // a shape never taken
+    state.published.fetch_add(1, std::memory_order_relaxed);                   // the output thread flushes for it
+    return true;
+}
+
+// load commands of the control and, with --watch, inotify on the directory (editors replace files by rename, so
+// IN_MOVED_TO as well as IN_CLOSE_WRITE). Frees the retired shapes
+void loader_thread(player_options options, player_state & state){
+    bool is_dir = fs::is_directory(options.input);
+    fs::path input(options.input);
+    std::string dir = is_dir ? options.input : (input.has_parent_path() ? input.parent_path().string() : ".");
+    std::string file_name = is_dir ? "" : input.filename().string();
+
+    int fd = -1;
+    if (options.watch){
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+            std::cout << "ERROR: Can't watch " << dir << ". " << strerror(errno) << std::endl;
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+        else
+            std::cout << "watching " << (is_dir ? dir + "/*.txt" : options.input) << std::endl;
+    }
+
+    alignas(inotify_event) char events[4096];
+    std::string message;
+    while (!stop_requested.load(std::memory_order_relaxed)){
+        free_retired(state);
+        pollfd pfds[2];
+        int count = 0;
+        if (fd >= 0)
+            pfds[count++] = {fd, POLLIN, 0};
+        if (state.loader_event >= 0)
+            pfds[count++] = {state.loader_event, POLLIN, 0};
+        if (poll(pfds, count, WATCH_POLL_MS) <= 0)
+            continue;
+
+        if (state.loader_event >= 0){
+            std::uint64_t wakeups;
+            if (read(state.loader_event, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN)
+                std::cout << "ERROR: control event. " << strerror(errno) << std::endl;
+            load_request request;
+            while (state.load_requests.read(&request, 1) == 1){
+                load_result result;
+                result.client = request.client;
+                result.generation = request.generation;
+                bool loaded = load_shape(request.path, options, state, message);
+                std::snprintf(result.text, sizeof(result.text), "%s %s", loaded ? "ok" : "error", message.c_str());
+                state.load_results.write(&result, 1);   // full only if the output thread stopped answering
+            }
+        }
+        if (fd < 0)
+            continue;
+        std::string changed = "";       // several events in one read: the last one counts
+        ssize_t length;
+        while ((length = read(fd, events, sizeof(events))) > 0){
+            for (char* ptr = events; ptr < events + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len){
+                inotify_event* event = (inotify_event*)ptr;
+                if (event->len == 0 || (event->mask & IN_ISDIR))
+                    continue;
+                std::string name = event->name;
+                if (is_dir ? fs::path(name).extension() == ".txt" : name == file_name)
+                    changed = (fs::path(dir) / name).string();
+            }
+        }
+        if (!changed.empty())
+            load_shape(changed, options, state, message);
+    }
+    if (fd >= 0)
+        close(fd);
+}
+
+// --shm-out: no ALSA device, the synthesis runs here and fills the shared ring for a player process
+int generate_shared(player_options options, std::string watched){
+    int retval;
+    live_shape* current;
+    if ((retval = build_live_shape(options.input, options.freq, options.sampling_rate, options.trigger ? LASER_RENDER_TRIGGER : 0, &current)) != LASER_OK){
+        std::cout << "Input Error: " << options.input << ": " << laser_strerror(retval) << std::endl;
+        return -4;
+    }
+    std::cout << "lut size: " << laser_lut_size(current->lut) << ", ready after " << elapsed_ms() << " ms" << std::endl;
+
+    shm_ring shared;
+    std::size_t ring_frames = std::max<std::size_t>((std::size_t)options.sampling_rate * options.ring_ms / 1000, 2 * options.period);
+    if ((retval = shm_ring_create(&shared, options.shm_out.c_str(), options.sampling_rate, CHANNELS, ring_frames)) < 0){
+        std::cout << "ERROR: Can't create shared ring " << options.shm_out << ". " << strerror(-retval) << std::endl;
+        free_live_shape(current);
+        return -6;
+    }
+    std::cout << "shared ring: " << shared.name << ", " << shared.header->capacity * 1000.0 / options.sampling_rate << " ms, rate: "
+              << options.sampling_rate << ", render block: " << options.period << " frames" << std::endl;
+
+    player_state state(CHANNELS);           // the local ring is not used
+    state.period = options.period;
+    state.total_frames = (std::uint64_t)(options.seconds * options.sampling_rate + 0.5);
+    state.freq.store(options.freq);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    std::thread loader;
+    if (options.watch){
+        if (!watched.empty())
+            options.input = watched;
+        loader = std::thread(loader_thread, options, std::ref(state));
+    }
+    shared_ring_writer writer = {&shared};
+    synthesize(current, state, writer);
+    shm_ring_set_flags(&shared, SHM_RING_DONE);
+    stop_requested.store(true);
+    if (loader.joinable())
+        loader.join();
+    free_retired(state);
+    free_live_shape(state.pending.exchange(nullptr));
+    free_live_shape(state.last_shape);
+
+    std::cout << "frames rendered: " << state.frames_rendered << ", still in the ring: " << shm_ring_read_available(&shared)
+              << ", player " << ((shm_ring_flags(&shared) & SHM_RING_CONSUMER) ? "attached" : "never attached")
+              << ", ring underruns of the player: " << shm_ring_underruns(&shared) << std::endl;
+    if (options.watch)
+        std::cout << "shape swaps: " << state.swaps << std::endl;
+    shm_ring_close(&shared);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    start_time = std::chrono::steady_clock::now();
+    player_options options;
+    int retval;
+    std::string watched = "";           // directory given with --watch
+    if ((retval = set_player_args(argc, argv, options)) != 0)
+        exit(retval);
+    if (options.rt){
+        // before the lookup table, the ring and the threads are allocated: all of it stays resident
+        if (rt_lock_memory(stdout) == 0)
+            std::cout << "memory locked" << std::endl;
+        if (options.rt_cpu < 0)
+            options.rt_cpu = rt_default_cpu();
+        if (options.rt_cpu < 0)
+            std::cout << "Note: no isolated cpu (isolcpus=), output thread not pinned" << std::endl;
+    }
+
+    if (options.watch && fs::is_directory(options.input)){
+        watched = options.input;
+        options.input = newest_points_file(watched);
+        if (options.input.empty()){
+            std::cout << "Input Error: no *.txt points file in " << watched << std::endl;
+            exit(-4);
+        }
+    }
+    if (!options.shm_out.empty())
+        return generate_shared(options, watched);
+
+    pcm_profile profile;
+    if (!options.buffer_given &&
+        pcm_profile_load(options.profile_file.c_str(), options.device.c_str(), options.sampling_rate, CHANNELS, &profile) == 0){
+        options.period = profile.period_size;
+        options.periods = profile.periods;
+        options.access = profile.access;
+        std::cout << "profile " << options.profile_file << ": period " << options.period << " x " << options.periods << std::endl;
+    }
+    pcm_output out;
+    if ((retval = pcm_output_open(&out, options.device.c_str(), options.sampling_rate, CHANNELS, options.period, options.periods, options.access)) < 0){
+        std::cout << "ERROR: Can't open \"" << options.device << "\" PCM device. " << snd_strerror(retval) << std::endl;
+        exit(-5);
+    }
+    options.sampling_rate = out.rate;
+    std::cout << "PCM name: '" << snd_pcm_name(out.pcm) << "', access: " << pcm_output_access_name(&out) << ", rate: " << out.rate
+              << ", period: " << out.period_size << " frames, buffer: " << out.buffer_size << " frames" << std::endl;
+    // the device may have picked another rate, render for the rate that is played
+    live_shape* current;
+    if ((retval = build_live_shape(options.input, options.freq, options.sampling_rate, options.trigger ? LASER_RENDER_TRIGGER : 0, &current)) != LASER_OK){
+        std::cout << "Input Error: " << options.input << ": " << laser_strerror(retval) << std::endl;
+        pcm_output_close(&out, 0);
+        exit(-4);
+    }
+    std::cout << "lut size: " << laser_lut_size(current->lut) << ", ready after " << elapsed_ms() << " ms" << std::endl;
+
+    std::size_t ring_frames = std::max<std::size_t>((std::size_t)options.sampling_rate * options.ring_ms / 1000, 2 * out.period_size);
+    player_state state(ring_frames * CHANNELS);
+    state.period = out.period_size;
+    state.total_frames = (std::uint64_t)(options.seconds * options.sampling_rate + 0.5);
+    state.output_priority = options.rt_priority;
+    state.freq.store(options.freq);
+    rt_histogram wakeup_hist = RT_HISTOGRAM_INIT, write_hist = RT_HISTOGRAM_INIT;
+    if (options.rt){
+        state.rt = true;
+        state.output_cpu = options.rt_cpu;
+        // the ring is empty, its first write region is all of it
+        ring_regions<std::int16_t> regions;
+        state.ring.write_regions(regions);
+        rt_prefault(regions.first, regions.first_count * sizeof(std::int16_t));
+        out.wakeup_hist = &wakeup_hist;
+        out.write_hist = &write_hist;
+    }
+
+    ctl_server control;
+    if (!options.control.empty()){
+        if ((retval = ctl_server_open(&control, options.control.c_str())) < 0 ||
+            (state.loader_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0){
+            std::cout << "ERROR: Can't open control socket " << options.control << ". " << strerror(retval < 0 ? -retval : errno) << std::endl;
+            ctl_server_close(&control);
+            free_live_shape(current);
+            pcm_output_close(&out, 0);
+            exit(-6);
+        }
+        state.control = &control;
+        std::cout << "control socket: " << options.control << std::endl;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    std::thread synthesis(synthesis_thread, current, std::ref(state));
+    std::thread output(output_thread, &out, std::ref(state));
+    std::thread loader;
+    if (options.watch || state.control){
+        player_options loader_options = options;
+        if (!watched.empty())
+            loader_options.input = watched;
+        loader = std::thread(loader_thread, loader_options, std::ref(state));
+    }
+    output.join();
+    synthesis.join();
+    if (loader.joinable())
+        loader.join();
+    if (state.control){
+        ctl_server_close(&control);
+        close(state.loader_event);
+    }
+    free_retired(state);
+    free_live_shape(state.pending.exchange(nullptr));
+    free_live_shape(state.last_shape);
+
+    std::cout << "first period written after " << state.first_write_ms << " ms" << std::endl;
+    std::cout << "frames played: " << state.frames_played << ", ring underruns: " << state.ring_underruns << ", min ring fill: "
+              << (state.min_ring_frames == SIZE_MAX ? 0 : state.min_ring_frames * 1000.0 / options.sampling_rate) << " ms, ";
+    std::cout.flush();
+    pcm_output_report(&out, stdout);
+    if (options.watch || state.control)
+        std::cout << "shape swaps: " << state.swaps << std::endl;
+    if (state.paused_frames)
+        std::cout << "paused: " << state.paused_frames * 1000.0 / options.sampling_rate << " ms" << std::endl;
+    if (options.rt){
+        rt_histogram_print(&wakeup_hist, "wake-up latency", stdout);
+        rt_histogram_print(&write_hist, out.mmap ? "mmap_commit" : "snd_pcm_writei", stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,527 @@
+/*H**********************************************************************
+* FILENAME :        laser_recover.cpp
+*
+* DESCRIPTION :
+*       Recovers a points file from a wav of a shape (written by svg_to_wav or recorded), when the .txt is gone:
+*         period     autocorrelation of x + i*y through one FFT (fft.hpp) on a 4x box filtered start of the file,
+*                    the first peak that is as high as the highest one, refined at full rate at the largest
+*                    multiple of the period that fits twice into the file
+*         average    every cycle resampled onto the same power of 2 phases and averaged, the noise drops with the
+*                    square root of the number of cycles
+*         unfold     the lookup table draws the trace start->end->start, i.e. the cycle is mirrored about the two
+*                    turning points. The axis is the peak of the circular self-convolution of the averaged cycle
+*                    (one more FFT), both halves are averaged into the start->end trace
+*         points     decimated to --points (decimate_tolerance at one int16 step, then decimate_budget), rescaled
+*                    back to the canvas and written as a height|width points file that load_image_params reads
+*       Files of a batch are spread over threads, one file per thread at a time.
+*
+* PUBLIC FUNCTIONS :
+*   bool read_channels(const wav_file &wav, std::vector<float> &x, std::vector<float> &y)
+*   double find_period(const float* x, const float* y, std::size_t n)
+*   double refine_period(const float* x, const float* y, std::size_t n, double period)
+*   recover_result recover(const std::string &wav_name, const recover_options &options, std::vector<recover_point> &points)
+*
+How to build:
+    g++ -O2 --std=c++17 -pthread laser_recover.cpp wav_reader.c -o laser_recover
+
+How to call:
+    ./laser_recover <file.wav> [<file.wav> ...] [options]
+    options:
+        --points=<n>            points of the recovered trace (default 1000), decimate_budget
+        --out=<dir>             directory of the points files (default .), <wav name without .wav>.txt
+        --canvas=<size>         height and width of the written canvas (default 1000)
+        --fit                   stretch the trace to the canvas (a recording of unknown gain), default: undo the
+                                rescaling of svg_to_wav so that the wav renders again the same
+        --period=<frames>       cycle length, skips the search (default: autocorrelation)
+        --skip=<frames>         frames at the start that are not part of the shape (default 100, the oscilloscope
+                                trigger pulse of svg_to_wav)
+        --threads=<n>           files recovered at the same time (default all cores)
+    e.g. ./laser_recover "svg/batman,10sec,0.10Hz,SR48000.wav" --out=recovered --points=500
+
+Note:
+    -- pcm 16, 24, 32 bit or 32 bit float wavs of at least 2 channels, x is the first channel, y the second
+    -- without a period of at least 2 cycles in the first RECOVER_SEARCH frames, the whole file is one cycle that
+       starts at frame 0 (svg_to_wav at 0.1 Hz for 10 seconds), give --period when the file holds a part of a cycle
+    -- a cycle that is not mirrored (sine, rectangle, a trace changed by the optional stages of svg_to_wav) is
+       written as the whole closed cycle, from the phase where the file starts
+    -- the trace starts at the turning point nearest to the phase of frame 0, the first point of the source for a
+       wav of svg_to_wav. A recording starts anywhere, its trace may come out reversed
+    -- dropouts of a recording shift the cycles after them and blur the average, check it with laser_compare
+    -- points beyond the int16 range wrap in the wav (e.g. batman.txt), they come back wrapped
+    -- exit code 0 when every file was recovered, negative on an error
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "laser_core.hpp"
+#include "decimate.hpp"
+#include "fft.hpp"
+#include "wav_reader.h"
+
+const int RECOVER_COARSE = 4;                   // box filter of the period search
+const std::size_t RECOVER_SEARCH = 262144;      // frames of the period search, periods up to half of it
+const double RECOVER_LOBE = 0.5;                // the autocorrelation falls below this before the first peak
+const double RECOVER_PERIODIC = 0.5;            // smallest normalized autocorrelation of a period
+const double RECOVER_PEAK_TOLERANCE = 0.1;      // peaks this close to the highest count as equal, the first wins
+const double RECOVER_NOISE_DB = -10.0;          // cycle noise above: the cycles do not line up
+const double RECOVER_MIRROR_DB = -10.0;         // mirror error above: the cycle is not a forward/reverse trace
+const std::size_t RECOVER_MAX_PHASES = 1 << 18; // phases of the averaged cycle, a long single cycle is resampled down
+const double RECOVER_QUANTUM = 1.0;             // int16 step, tolerance of the lossless first decimation
+const int RECOVER_OVERSAMPLE = 4;               // phases per frame of a short cycle, corners fall near a phase
+
+struct recover_point{
+    double x, y;
+    recover_point() : x(0.0), y(0.0){}
+    recover_point(double mx, double my) : x(mx), y(my){}
+    double get_x() const { return x; }
+    double get_y() const { return y; }
+};
+
+struct recover_options{
+    std::size_t points = 1000;
+    std::string out_dir = ".";
+    int canvas = 1000;
+    bool fit = false;
+    double period = 0.0;
+    std::size_t skip = laser_core::TRIGGER_FRAMES;
+};
+
+struct recover_result{
+    int error = 0;              // 0 or a negative code with message
+    std::string message;
+    double period = 0.0;        // frames
+    unsigned int rate = 0;
+    double cycles = 0.0;        // averaged
+    double noise_db = 0.0;      // samples - average relative to the average
+    double mirror_db = 0.0;     // the two halves of the cycle against each other
+    bool folded = false;
+    decimation_report decimation;
+    std::string out_name;
+};
+
+// x and y of every frame in output sample units (int16 scale), false for an unsupported format
+bool read_channels(const wav_file &wav, std::vector<float> &x, std::vector<float> &y)
+{
+    bool pcm = wav.format == WAV_FORMAT_PCM && (wav.bits_per_sample == 16 || wav.bits_per_sample == 24 || wav.bits_per_sample == 32);
+    bool pcm_float = wav.format == WAV_FORMAT_FLOAT && wav.bits_per_sample == 32;
+    if ((!pcm && !pcm_float) || wav.channels < 2)
+        return false;
+    x.resize(wav.num_frames);
+    y.resize(wav.num_frames);
+    int bytes = wav.bits_per_sample / 8;
+    for (std::size_t frame = 0; frame < wav.num_frames; frame++)
+    {
+        for (int channel = 0; channel < 2; channel++)
+        {
+            const std::uint8_t* p = wav.data + frame * wav.block_align + channel * bytes;
+            float value;
+            if (pcm_float)
+            {
+                std::memcpy(&value, p, sizeof(value));
+                value *= 32768.0f;
+            }
+            else if (bytes == 2)
+                value = (float)(std::int16_t)(p[0] | (p[1] << 8));
+            else if (bytes == 3)
+                value = (std::int32_t)((std::uint32_t)p[0] << 8 | (std::uint32_t)p[1] << 16 | (std::uint32_t)p[2] << 24) / 65536.0f;
+            else
+                value = (std::int32_t)((std::uint32_t)p[0] | (std::uint32_t)p[1] << 8 | (std::uint32_t)p[2] << 16 | (std::uint32_t)p[3] << 24) / 65536.0f;
+            (channel ? y : x)[frame] = value;
+        }
+    }
+    return true;
+}
+
+std::size_t next_power_of_2(std::size_t n)
+{
+    std::size_t size = 1;
+    while (size < n)
+        size *= 2;
+    return size;
+}
+
+// sum over both channels of a[i] * a[i + lag] for i < n - lag, normalized by the energy of both ends
+double lag_correlation(const float* x, const float* y, std::size_t n, std::size_t lag)
+{
+    std::size_t len = n - lag;
+    double cross = (double)dot(x, x + lag, len) + dot(y, y + lag, len);
+    double energy = ((double)dot(x, x, len) + dot(y, y, len)) * ((double)dot(x + lag, x + lag, len) + dot(y + lag, y + lag, len));
+    return energy > 0 ? cross / std::sqrt(energy) : 0.0;
+}
+
+// cycle length in frames of the mean free x and y, 0 without 2 cycles in the first RECOVER_SEARCH frames.
+// Autocorrelation of z = x + i*y: Re(sum z[j + k] conj(z[j])) = Rxx(k) + Ryy(k), |FFT(z)|^2 back through one FFT
+double find_period(const float* x, const float* y, std::size_t n)
+{
+    std::size_t coarse = std::min(n, RECOVER_SEARCH) / RECOVER_COARSE;
+    if (coarse < 16)
+        return 0.0;
+    fft_plan plan(next_power_of_2(2 * coarse));     // zero padded, no wraparound
+    std::vector<float> re(plan.size(), 0.0f), im(plan.size(), 0.0f);
+    for (std::size_t i = 0; i < coarse; i++)
+    {
+        for (int k = 0; k < RECOVER_COARSE; k++)
+        {
+            re[i] += x[i * RECOVER_COARSE + k];
+            im[i] += y[i * RECOVER_COARSE + k];
+        }
+    }
+    plan.forward(re.data(), im.data());
+    for (std::size_t k = 0; k < plan.size(); k++)
+    {
+        re[k] = re[k] * re[k] + im[k] * im[k];
+        im[k] = 0.0f;
+    }
+    plan.inverse(re.data(), im.data());
+    if (!(re[0] > 0.0f))
+        return 0.0;
+
+    // unbiased and normalized, lags up to half of the window
+    std::size_t lags = coarse / 2;
+    std::vector<double> r(lags + 1);
+    for (std::size_t k = 0; k <= lags; k++)
+        r[k] = re[k] / re[0] * (double)coarse / (double)(coarse - k);
+    std::size_t first = 1;
+    while (first < lags && r[first] > RECOVER_LOBE)
+        first++;
+    double highest = -1.0;
+    for (std::size_t k = first; k < lags; k++)
+        highest = std::max(highest, r[k]);
+    if (highest < RECOVER_PERIODIC)
+        return 0.0;
+    for (std::size_t k = first; k < lags; k++)
+    {
+        if (r[k] >= highest - RECOVER_PEAK_TOLERANCE && r[k] >= r[k - 1] && r[k] >= r[k + 1])
+        {
+            double curvature = r[k - 1] - 2 * r[k] + r[k + 1];
+            return (k + (curvature < 0 ? 0.5 * (r[k - 1] - r[k + 1]) / curvature : 0.0)) * RECOVER_COARSE;
+        }
+    }
+    return 0.0;
+}
+
+// the period at full rate: the peak around it, then the peak around the largest multiple that fits twice into
+// the file, its error divided by the multiple
+double refine_period(const float* x, const float* y, std::size_t n, double period)
+{
+    for (double multiple : {1.0, std::floor(n / (2.0 * period))})
+    {
+        if (multiple < 1.0)
+            break;
+        std::int64_t center = std::llround(period * multiple), reach = multiple == 1.0 ? 2 * RECOVER_COARSE : 3;
+        std::int64_t best = center;
+        double score[3] = {0, 0, 0}, best_score = -2.0;
+        for (std::int64_t lag = std::max<std::int64_t>(1, center - reach); lag <= center + reach && lag < (std::int64_t)n; lag++)
+        {
+            double c = lag_correlation(x, y, n, (std::size_t)lag);
+            if (c > best_score)
+                best_score = c, best = lag;
+        }
+        if (best <= 1 || best + 1 >= (std::int64_t)n)
+            continue;
+        for (int k = 0; k < 3; k++)
+            score[k] = lag_correlation(x, y, n, (std::size_t)(best - 1 + k));
+        double curvature = score[0] - 2 * score[1] + score[2];
+        period = (best + (curvature < 0 ? 0.5 * (score[0] - score[2]) / curvature : 0.0)) / multiple;
+    }
+    return period;
+}
+
+recover_result recover(const std::string &wav_name, const recover_options &options, std::vector<recover_point> &points)
+{
+    recover_result result;
+    wav_file wav;
+    int retval;
+    if ((retval = wav_open(&wav, wav_name.c_str())) != WAV_OK)
+    {
+        result.error = -2;
+        result.message = wav_strerror(retval);
+        return result;
+    }
+    std::vector<float> x, y;
+    bool read = read_channels(wav, x, y);
+    result.rate = wav.rate;
+    wav_close(&wav);
+    if (!read || x.size() < options.skip + 16)
+    {
+        result.error = -2;
+        result.message = "needs 16/24/32 bit pcm or 32 bit float, 2 channels and more than --skip frames";
+        return result;
+    }
+
+    // mean free, the trigger pulse zeroed for the period search (it is not periodic)
+    std::size_t n = x.size();
+    double mean_x = 0.0, mean_y = 0.0;
+    for (std::size_t i = options.skip; i < n; i++)
+        mean_x += x[i], mean_y += y[i];
+    mean_x /= (double)(n - options.skip);
+    mean_y /= (double)(n - options.skip);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] = i < options.skip ? 0.0f : x[i] - (float)mean_x;
+        y[i] = i < options.skip ? 0.0f : y[i] - (float)mean_y;
+    }
+
+    const float* search_x = x.data() + options.skip;
+    const float* search_y = y.data() + options.skip;
+    double period = options.period;
+    if (period <= 0.0 && (period = find_period(search_x, search_y, n - options.skip)) > 0.0)
+        period = refine_period(search_x, search_y, n - options.skip, period);
+    if (period <= 0.0)
+        period = (double)n;     // one cycle from frame 0
+    result.period = period;
+
+    // every cycle onto the same phases, sums and counts (the skipped frames leave gaps in the first cycle)
+    std::size_t phases = std::min(RECOVER_MAX_PHASES, next_power_of_2((std::size_t)std::ceil(RECOVER_OVERSAMPLE * period)));
+    std::vector<double> sum_x(phases, 0.0), sum_y(phases, 0.0), count(phases, 0.0);
+    double step = period / (double)phases;
+    for (std::size_t cycle = 0; cycle * period < (double)n; cycle++)
+    {
+        for (std::size_t j = 0; j < phases; j++)
+        {
+            double t = cycle * period + j * step;
+            if (t < (double)options.skip || t + 1.0 >= (double)n)
+                continue;
+            std::size_t i = (std::size_t)t;
+            double fraction = t - i;
+            sum_x[j] += x[i] * (1.0 - fraction) + x[i + 1] * fraction;
+            sum_y[j] += y[i] * (1.0 - fraction) + y[i + 1] * fraction;
+            count[j] += 1.0;
+        }
+    }
+    std::vector<double> average_x(phases, 0.0), average_y(phases, 0.0);
+    double cycle_samples = 0.0, signal = 0.0, noise = 0.0;
+    for (std::size_t j = 0; j < phases; j++)
+    {
+        if (count[j] > 0)
+        {
+            average_x[j] = sum_x[j] / count[j];
+            average_y[j] = sum_y[j] / count[j];
+        }
+        cycle_samples += count[j];
+    }
+    result.cycles = cycle_samples / (double)phases;
+    for (std::size_t cycle = 0; cycle * period < (double)n; cycle++)
+    {
+        for (std::size_t j = 0; j < phases; j++)
+        {
+            double t = cycle * period + j * step;
+            if (t < (double)options.skip || t + 1.0 >= (double)n)
+                continue;
+            std::size_t i = (std::size_t)t;
+            double fraction = t - i;
+            double dx = x[i] * (1.0 - fraction) + x[i + 1] * fraction - average_x[j];
+            double dy = y[i] * (1.0 - fraction) + y[i + 1] * fraction - average_y[j];
+            noise += dx * dx + dy * dy;
+            signal += average_x[j] * average_x[j] + average_y[j] * average_y[j];
+        }
+    }
+    result.noise_db = 10 * std::log10((noise + 1e-30) / (signal + 1e-30));
+
+    // mirror axis: sum_k A(a + k) A(a - k) is the circular self-convolution at 2a, IFFT(Z(k) conj(Z(-k)))
+    // with Z = FFT(average_x + i * average_y) is the sum of the x and y convolutions
+    fft_plan plan(phases);
+    std::vector<float> re(phases), im(phases), conv_re(phases), conv_im(phases);
+    for (std::size_t j = 0; j < phases; j++)
+        re[j] = (float)average_x[j], im[j] = (float)average_y[j];
+    plan.forward(re.data(), im.data());
+    for (std::size_t k = 0; k < phases; k++)
+    {
+        std::size_t m = (phases - k) & (phases - 1);
+        conv_re[k] = re[k] * re[m] + im[k] * im[m];
+        conv_im[k] = im[k] * re[m] - re[k] * im[m];
+    }
+    plan.inverse(conv_re.data(), conv_im.data());
+    // the peak at 2a puts the axis a on the phase grid or half way between two phases, phase i mirrors onto
+    // 2a - i without interpolation (which would round off the turning points)
+    std::size_t twice_axis = 0;
+    for (std::size_t j = 1; j < phases; j++)
+        if (conv_re[j] > conv_re[twice_axis])
+            twice_axis = j;
+    // two axes half a cycle apart, the start of the trace is the one nearest to the phase of frame 0 (the first
+    // lookup table entry is mirrored about -0.5 frames)
+    double twice_start = -1.0 / step;
+    auto cyclic_distance = [&](double a, double b) { double d = std::fmod(std::fabs(a - b), 2.0 * phases); return std::min(d, 2.0 * phases - d); };
+    if (cyclic_distance(twice_axis + (double)phases, twice_start) < cyclic_distance((double)twice_axis, twice_start))
+        twice_axis += phases;
+    auto partner = [&](std::size_t i) { return (twice_axis + 2 * phases - i) % phases; };
+
+    double mirror = 0.0, energy = 0.0;
+    for (std::size_t j = 0; j < phases; j++)
+    {
+        std::size_t m = partner(j);
+        mirror += (average_x[j] - average_x[m]) * (average_x[j] - average_x[m]) + (average_y[j] - average_y[m]) * (average_y[j] - average_y[m]);
+        energy += 2 * (average_x[j] * average_x[j] + average_y[j] * average_y[j]);
+    }
+    result.mirror_db = 10 * std::log10((mirror + 1e-30) / (energy + 1e-30));
+    result.folded = result.mirror_db < RECOVER_MIRROR_DB;
+
+    points.clear();
+    if (result.folded)
+    {   // start axis -> end axis, both halves weighted by their counts
+        for (std::size_t i = (twice_axis + 1) / 2; 2 * i <= twice_axis + phases; i++)
+        {
+            std::size_t j = i % phases, m = partner(j);
+            double c = count[j] + (m != j ? count[m] : 0.0);
+            if (c > 0)
+                points.push_back(recover_point((sum_x[j] + (m != j ? sum_x[m] : 0.0)) / c + mean_x,
+                                               (sum_y[j] + (m != j ? sum_y[m] : 0.0)) / c + mean_y));
+        }
+    }
+    else
+    {   // the whole cycle, closed
+        for (std::size_t j = 0; j <= phases; j++)
+            if (count[j % phases] > 0)
+                points.push_back(recover_point(average_x[j % phases] + mean_x, average_y[j % phases] + mean_y));
+    }
+    if (points.size() < 2)
+    {
+        result.error = -3;
+        result.message = "no cycle found";
+        return result;
+    }
+    // points within one int16 step of the trace carry nothing, the budget then works on far fewer of them
+    decimation_report lossless = decimate_tolerance(points, RECOVER_QUANTUM);
+    result.decimation = decimate_budget(points, std::max<std::size_t>(2, options.points));
+    result.decimation.points_before = lossless.points_before;
+    result.decimation.max_deviation = std::max(result.decimation.max_deviation, lossless.max_deviation);
+
+    // output sample units -> canvas, the inverse of laser_core::rescale (or the bounding box with --fit)
+    double low_x = -LASER_AMP_MULTIPLYER / 2.0, low_y = low_x, span_x = LASER_AMP_MULTIPLYER, span_y = span_x;
+    if (options.fit)
+    {
+        double high_x = points[0].x, high_y = points[0].y;
+        low_x = points[0].x, low_y = points[0].y;
+        for (const recover_point &point : points)
+        {
+            low_x = std::min(low_x, point.x), high_x = std::max(high_x, point.x);
+            low_y = std::min(low_y, point.y), high_y = std::max(high_y, point.y);
+        }
+        span_x = std::max(high_x - low_x, 1e-9);
+        span_y = std::max(high_y - low_y, 1e-9);
+    }
+    std::string base = wav_name.substr(wav_name.find_last_of("/\\") + 1);
+    if (base.size() > 4 && base.compare(base.size() - 4, 4, ".wav") == 0)
+        base.erase(base.size() - 4);
+    result.out_name = options.out_dir + "/" + base + ".txt";
+    std::ofstream out(result.out_name);
+    if (!out.is_open())
+    {
+        result.error = -4;
+        result.message = "can't write " + result.out_name;
+        return result;
+    }
+    out << options.canvas << "|" << options.canvas << "\n" << std::setprecision(15);
+    for (const recover_point &point : points)
+        out << (point.x - low_x) / span_x * options.canvas << "," << (point.y - low_y) / span_y * options.canvas << "\n";
+    out << "#\n";
+    if (!out.good())
+    {
+        result.error = -4;
+        result.message = "can't write " + result.out_name;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> wav_names;
+    recover_options options;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.rfind("--points=", 0) == 0)
+            options.points = (std::size_t)std::strtoul(value.c_str(), NULL, 10);
+        else if (arg.rfind("--out=", 0) == 0)
+            options.out_dir = value;
+        else if (arg.rfind("--canvas=", 0) == 0)
+            options.canvas = std::atoi(value.c_str());
+        else if (arg.compare("--fit") == 0)
+            options.fit = true;
+        else if (arg.rfind("--period=", 0) == 0)
+            options.period = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--skip=", 0) == 0)
+            options.skip = (std::size_t)std::strtoul(value.c_str(), NULL, 10);
+        else if (arg.rfind("--threads=", 0) == 0)
+            threads = std::atoi(value.c_str());
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+        else
+            wav_names.push_back(arg);
+    }
+    if (wav_names.empty())
+    {
+        std::cout << "Input Error: usage: laser_recover <file.wav> [<file.wav> ...] [options], see laser_recover.cpp" << std::endl;
+        return -1;
+    }
+    if (options.points < 2 || options.canvas <= 0 || options.period < 0.0 || options.out_dir.empty())
+    {
+        std::cout << "Invalid argument: --points >= 2, --canvas > 0, --period >= 0, --out not empty" << std::endl;
+        return -1;
+    }
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (int)std::min<std::size_t>((std::size_t)threads, wav_names.size());
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next(0);
+    std::atomic<int> failed(0);
+    std::mutex print_mutex;
+    auto worker = [&]()
+    {
+        std::vector<recover_point> points;
+        for (std::size_t i; (i = next.fetch_add(1)) < wav_names.size(); )
+        {
+            recover_result result = recover(wav_names[i], options, points);
+            std::lock_guard<std::mutex> lock(print_mutex);
+            if (result.error)
+            {
+                std::cout << "ERROR: " << wav_names[i] << ": " << result.message << std::endl;
+                failed++;
+                continue;
+            }
+            std::cout << std::fixed << std::setprecision(2) << wav_names[i] << ": period " << result.period << " frames ("
+                      << result.rate / result.period << " Hz), " << std::setprecision(1) << result.cycles << " cycles, noise ";
+            if (result.cycles < 2.0)
+                std::cout << "- (one cycle)";
+            else
+                std::cout << result.noise_db << " dB" << (result.noise_db > RECOVER_NOISE_DB ? " (cycles do not line up, dropouts?)" : "");
+            std::cout << ", mirror " << result.mirror_db << " dB" << (result.folded ? "" : " (not mirrored, whole cycle)")
+                      << ", " << result.decimation.points_before << " -> " << result.decimation.points_after << " points (max deviation "
+                      << result.decimation.max_deviation << ") -> " << result.out_name << std::endl;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.push_back(std::thread(worker));
+    worker();
+    for (std::thread &thread : workers)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << std::fixed << std::setprecision(2) << wav_names.size() - failed << " of " << wav_names.size() << " recovered in "
+              << seconds << " s, " << threads << " threads" << std::endl;
+    return failed ? -2 : 0;
+}
@@ -0,0 +1,554 @@
+/*H**********************************************************************
+* FILENAME :        laser_regress.cpp
+*
+* DESCRIPTION :
+*       Golden output and performance regression test for svg_to_wav. Renders every points file in svg/ at
+*       several sampling rates (plus sine, rectangle and each optional stage alone and combined), compares a hash of the pcm
+*       payload of each wav with the stored golden and fails when a case got slower than the perf baseline.
+*       The liblaser cases render the same shape in process through the C API (laser.h) and must match the golden
+*       of the svg_to_wav case they name. The laser_compare cases cut frames out of a rendered shape and check that
+*       laser_compare reports these dropouts. Runs headless, replaces the interactive batch test of test.sh
+*
+* PUBLIC FUNCTIONS :
+*   std::uint64_t fnv1a_64(const char* data, std::size_t size, std::uint64_t hash)
+*   bool hash_wav_payload(std::string file, std::uint64_t* hash, std::size_t* payload_bytes)
+*   std::vector<regress_case> collect_cases(std::string svg_dir)
+*   bool run_case(regress_case & test_case, int reps)
+*   int render_liblaser(const regress_case & test_case)
+*   std::string run_compare(const regress_case & test_case)
+*
+How to build:
+    g++ -O2 --std=c++17 laser_regress.cpp liblaser.cpp -o laser_regress     (svg_to_wav and laser_compare must be
+                                                                            built too, see test.sh)
+
+How to call:
+    1  ./laser_regress                  run all cases, compare with goldens and perf baseline
+    2  ./laser_regress --update         write goldens and perf baseline from this run (after an intended change)
+    options:
+        --exec=<file>           svg_to_wav executable (default ./svg_to_wav)
+        --svg-dir=<path>        directory of the points files (default svg)
+        --golden=<file>         golden hashes (default svg/regress.golden, part of the repository)
+        --perf=<file>           perf baseline of this machine (default regress.perf, written on the first run)
+        --threshold=<fraction>  a case fails when best wall time > baseline * (1 + fraction) (default 0.5)
+        --min-delta-ms=<ms>     and the difference is larger than this, filters timer noise (default 20)
+        --reps=<n>              runs per case, the fastest counts (default 3). All runs must give the same hash
+        --json=<file>           write per case results as json
+        --scope=<dir>           render the wav of every passing run into <dir>/<arguments>.png with laser_scope, to
+                                look at the output instead of photographing the scope
+        --scope-exec=<file>     laser_scope executable (default ./laser_scope, see laser_scope.cpp)
+        --compare-exec=<file>   laser_compare executable (default ./laser_compare), the laser_compare cases are
+                                skipped when it does not exist
+
+Golden file: one case per line, <svg_to_wav arguments>|<fnv-1a 64 of the pcm payload in hex, or exit=<code>>
+    e.g.  batman.txt 10 0.1 48000|5c1a0e2f9d3b7a41
+Lines starting with // are comments. Points files are given relative to the svg directory. The liblaser cases
+("liblaser batman.txt 10 0.1 48000") have no line of their own, they are compared with the svg_to_wav line.
+A laser_compare case stores the jumps laser_compare reported, e.g.
+    laser_compare diamond.txt 10 100 48000 100000:37 200000:240|dropouts=-37,-240
+
+Note:
+    -- points files without height|width in the first line are skipped, the same files test.sh did not process
+    -- the hash covers only the sample data (data chunk), the header is checked to be a 16 bit stereo pcm wav
+    -- the scope render is not part of the timed run, a case fails when laser_scope fails on its wav
+    -- exit code 0 when every case passed, 1 otherwise
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <sys/wait.h>
+#include "laser.h"
+#include "laser_core.hpp"
+namespace fs = std::filesystem;
+
+const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const std::uint64_t FNV_PRIME = 1099511628211ULL;
+const int REGRESS_SAMPLING_RATES[] = {8000, 44100, 48000, 192000};
+
+struct regress_case{
+    std::string args;           // arguments of svg_to_wav, points file relative to svg dir
+    std::string wav_file;       // file svg_to_wav writes for these arguments
+    std::string result;         // hash in hex or exit=<code>
+    std::string golden_args;    // liblaser case: the svg_to_wav case whose golden it must match, else empty
+    bool compare = false;       // laser_compare case, the result is its dropout report
+    std::size_t samples = 0;    // stereo samples in the wav
+    double wall_ns = 0.0;       // fastest run
+    std::string status;         // PASS, FAIL ..., NEW
+};
+
+std::string exec_file = "./svg_to_wav", svg_dir = "svg", golden_file = "svg/regress.golden", perf_file = "regress.perf", json_file = "";
+std::string scope_dir = "", scope_exec = "./laser_scope", compare_exec = "./laser_compare";
+double threshold = 0.5, min_delta_ms = 20.0;
+int reps = 3;
+bool update = false;
+
+std::uint64_t fnv1a_64(const char* data, std::size_t size, std::uint64_t hash)
+{
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+std::uint32_t read_le(const unsigned char* bytes, int size)
+{
+    std::uint32_t value = 0;
+    for (int i = size - 1; i >= 0; i--)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+// hashes the data chunk of a 16 bit stereo pcm wav, false if the file is not one
+bool hash_wav_payload(std::string file, std::uint64_t* hash, std::size_t* payload_bytes)
+{
+    std::ifstream file_wav(file, std::ios::binary);
+    unsigned char header[12], chunk[8], fmt[16];
+    if (!file_wav.read((char*)header, 12) || std::string((char*)header, 4) != "RIFF" || std::string((char*)header + 8, 4) != "WAVE")
+        return false;
+
+    bool fmt_ok = false;
+    while (file_wav.read((char*)chunk, 8))
+    {
+        std::string id((char*)chunk, 4);
+        std::uint32_t size = read_le(chunk + 4, 4);
+        if (id == "fmt " && size >= 16)
+        {
+            file_wav.read((char*)fmt, 16);
+            fmt_ok = read_le(fmt, 2) == 1 && read_le(fmt + 2, 2) == 2 && read_le(fmt + 14, 2) == 16;
+            file_wav.seekg(size - 16 + (size & 1), std::ios::cur);
+        }
+        else if (id == "data")
+        {
+            if (!fmt_ok)
+                return false;
+            std::vector<char> buffer(1 << 16);
+            std::uint64_t h = FNV_OFFSET;
+            std::size_t left = size;
+            while (left > 0 && file_wav.read(buffer.data(), std::min(left, buffer.size())))
+            {
+                std::size_t count = (std::size_t)file_wav.gcount();
+                h = fnv1a_64(buffer.data(), count, h);
+                left -= count;
+            }
+            *hash = h;
+            *payload_bytes = size - left;
+            return left == 0;
+        }
+        else
+            file_wav.seekg(size + (size & 1), std::ios::cur);
+    }
+    return false;
+}
+
+// name of the wav svg_to_wav writes: <signal or points file without .txt>,<seconds>sec,<freq>Hz,SR<rate>.wav
+std::string wav_name(std::string signal, int seconds, double freq, int sampling_rate)
+{
+    std::ostringstream name;
+    name << signal << "," << seconds << "sec," << std::fixed << std::setprecision(2) << freq << "Hz,SR" << sampling_rate << ".wav";
+    return name.str();
+}
+
+bool has_dimensions(std::string file)
+{
+    std::ifstream file_points(file);
+    std::string line;
+    if (!std::getline(file_points, line))
+        return false;
+    std::size_t pos = line.find("|");
+    return pos != std::string::npos && pos > 0 && pos + 1 < line.length();
+}
+
+std::vector<regress_case> collect_cases(std::string svg_dir)
+{
+    std::vector<regress_case> cases;
+    std::vector<std::string> files;
+    for (const auto & entry : fs::directory_iterator(svg_dir))
+        if (entry.is_regular_file() && entry.path().extension() == ".txt")
+            files.push_back(entry.path().filename().string());
+    std::sort(files.begin(), files.end());
+
+    for (std::string & file : files)
+    {
+        if (!has_dimensions(svg_dir + "/" + file))
+        {
+            std::cout << "SKIP  " << file << " (no height|width in the first line)" << std::endl;
+            continue;
+        }
+        std::string signal = svg_dir + "/" + file.substr(0, file.length() - 4);
+        for (int rate : REGRESS_SAMPLING_RATES)
+        {
+            regress_case test_case;
+            test_case.args = file + " 10 0.1 " + std::to_string(rate);
+            test_case.wav_file = wav_name(signal, 10, 0.1, rate);
+            cases.push_back(test_case);
+        }
+        regress_case high_freq;     // lut played many times per file
+        high_freq.args = file + " 2 50 48000";
+        high_freq.wav_file = wav_name(signal, 2, 50, 48000);
+        cases.push_back(high_freq);
+    }
+
+    if (std::find(files.begin(), files.end(), "batman.txt") != files.end())
+    {   // each optional stage alone on the most complex fixture, so a changed hash names its stage, then all together
+        // point-budget=lut keeps lut_size / 2 points: a no-op on batman at the default lut size
+        for (std::string option : {"--decimate-tol=2", "--point-budget=200", "--lut-size=4096 --point-budget=lut",
+                                   "--lut-size=65536", "--corner-dwell", "--galvo-filter=../galvo.cal",
+                                   "--optimize-strokes --decimate-tol=2 --corner-dwell --galvo-filter=../galvo.cal"})
+        {
+            regress_case stage;
+            stage.args = "batman.txt 10 0.1 48000 " + option;
+            stage.wav_file = wav_name(svg_dir + "/batman", 10, 0.1, 48000);
+            cases.push_back(stage);
+        }
+    }
+
+    if (std::find(files.begin(), files.end(), "strokes.txt") != files.end())
+    {   // batman is one stroke, strokes.txt has five disjoint ones in a poor order
+        regress_case strokes;
+        strokes.args = "strokes.txt 10 0.1 48000 --optimize-strokes";
+        strokes.wav_file = wav_name(svg_dir + "/strokes", 10, 0.1, 48000);
+        cases.push_back(strokes);
+    }
+
+    if (std::find(files.begin(), files.end(), "batman.txt") != files.end())
+    {   // the same renderer through the C API, one long and one many cycles per file
+        for (std::string args : {"batman.txt 10 0.1 48000", "batman.txt 2 50 48000"})
+        {
+            regress_case api;
+            api.args = "liblaser " + args;
+            api.golden_args = args;
+            api.wav_file = svg_dir + "/liblaser.wav";
+            cases.push_back(api);
+        }
+    }
+
+    if (std::find(files.begin(), files.end(), "diamond.txt") != files.end() && fs::exists(compare_exec))
+    {   // dropouts of 37, 240 (half a cycle) and 1000 frames (2 cycles + 40) in a shape of 480 frames per cycle,
+        // laser_compare finds them modulo the cycle
+        regress_case dropouts;
+        dropouts.args = "laser_compare diamond.txt 10 100 48000 100000:37 200000:240 300000:1000";
+        dropouts.wav_file = svg_dir + "/compare_capture.wav";
+        dropouts.compare = true;
+        cases.push_back(dropouts);
+    }
+
+    regress_case sine, rect, nyquist;  // lut size of sine/rectangle follows the points file, needs an existing one
+    sine.args = "square.txt 1 100 48000 sine";
+    sine.wav_file = wav_name(svg_dir + "/sine", 1, 100, 48000);
+    rect.args = "square.txt 1 100 48000 rect";
+    rect.wav_file = wav_name(svg_dir + "/rect", 1, 100, 48000);
+    nyquist.args = "square.txt 1 30000 48000 sine";     // above 24000 Hz, must be rejected
+    cases.push_back(sine);
+    cases.push_back(rect);
+    cases.push_back(nyquist);
+    return cases;
+}
+
+// laser_scope image of the wav of a case, named after its arguments (cases can write the same wav)
+bool render_scope_image(regress_case & test_case)
+{
+    std::string name = test_case.args;
+    std::replace_if(name.begin(), name.end(), [](char c) { return !std::isalnum((unsigned char)c) && c != '.' && c != '-'; }, '_');
+    std::string image = (fs::path(scope_dir) / (name + ".png")).string();
+    std::string command = "\"" + fs::absolute(scope_exec).string() + "\" \"" + test_case.wav_file + "\" \"" + image + "\" > /dev/null 2>&1";
+    return std::system(command.c_str()) == 0;
+}
+
+// "liblaser <points file> <seconds> <freq> <sampling_rate>": load, lut, renderer with the trigger pulse and wav
+// through laser.h like svg_to_wav does it, returns 0 or the negative LASER_ERR_* code
+int render_liblaser(const regress_case & test_case)
+{
+    std::istringstream args(test_case.args.substr(std::string("liblaser ").length()));
+    std::string file;
+    int seconds = 0, sampling_rate = 0;
+    float freq = 0.0f;
+    args >> file >> seconds >> freq >> sampling_rate;
+
+    laser_shape* shape = NULL;
+    laser_lut* lut = NULL;
+    laser_renderer* renderer = NULL;
+    int retval;
+    if ((retval = laser_shape_load((svg_dir + "/" + file).c_str(), &shape)) == LASER_OK &&
+        (retval = laser_lut_build(shape, LASER_WAVE_INPUT, 0, &lut)) == LASER_OK &&
+        (retval = laser_renderer_create(lut, freq, sampling_rate, LASER_RENDER_TRIGGER, &renderer)) == LASER_OK)
+        retval = laser_write_wav(renderer, test_case.wav_file.c_str(), (size_t)seconds * sampling_rate);
+    laser_renderer_free(renderer);
+    laser_lut_free(lut);
+    laser_shape_free(shape);
+    return retval;
+}
+
+// "laser_compare <points file> <seconds> <freq> <sampling_rate> <frame>:<count> ...": renders the shape through
+// laser.h as the reference, the capture is the same at half the gain after 1234 frames of silence with count
+// frames cut out at each frame. Returns "dropouts=<jumps laser_compare reported, comma separated>" or exit=<code>
+std::string run_compare(const regress_case & test_case)
+{
+    std::istringstream args(test_case.args.substr(std::string("laser_compare ").length()));
+    std::string file, cut;
+    int seconds = 0, sampling_rate = 0;
+    float freq = 0.0f;
+    args >> file >> seconds >> freq >> sampling_rate;
+    std::size_t num_frames = (std::size_t)seconds * sampling_rate;
+
+    laser_shape* shape = NULL;
+    laser_lut* lut = NULL;
+    laser_renderer* renderer = NULL;
+    std::vector<std::int16_t> frames(2 * num_frames);
+    int retval;
+    if ((retval = laser_shape_load((svg_dir + "/" + file).c_str(), &shape)) == LASER_OK &&
+        (retval = laser_lut_build(shape, LASER_WAVE_INPUT, 0, &lut)) == LASER_OK &&
+        (retval = laser_renderer_create(lut, freq, sampling_rate, LASER_RENDER_TRIGGER, &renderer)) == LASER_OK)
+        retval = laser_render(renderer, frames.data(), num_frames);
+    laser_renderer_free(renderer);
+    laser_lut_free(lut);
+    laser_shape_free(shape);
+    if (retval != LASER_OK)
+        return "exit=" + std::to_string(-retval);
+
+    std::vector<std::int16_t> capture(2 * 1234, 0);
+    std::size_t next = 0;
+    while (args >> cut)
+    {
+        std::size_t at = std::strtoul(cut.c_str(), NULL, 10), count = std::strtoul(cut.substr(cut.find(":") + 1).c_str(), NULL, 10);
+        for (; next < at && next < num_frames; next++)
+            capture.insert(capture.end(), {(std::int16_t)(frames[2 * next] / 2), (std::int16_t)(frames[2 * next + 1] / 2)});
+        next = at + count;
+    }
+    for (; next < num_frames; next++)
+        capture.insert(capture.end(), {(std::int16_t)(frames[2 * next] / 2), (std::int16_t)(frames[2 * next + 1] / 2)});
+
+    std::string reference_file = svg_dir + "/compare_reference.wav";
+    for (auto wav : {std::make_pair(reference_file, &frames), std::make_pair(test_case.wav_file, &capture)})
+    {
+        std::ofstream file_wav(wav.first, std::ios::binary);
+        laser_core::write_wav_header(file_wav, sampling_rate, (std::uint32_t)(wav.second->size() / 2));
+        laser_core::write_pcm(file_wav, wav.second->data(), wav.second->data() + 1, 2, wav.second->size() / 2);
+    }
+
+    std::string command = "\"" + fs::absolute(compare_exec).string() + "\" \"" + reference_file + "\" \"" + test_case.wav_file + "\" 2>&1";
+    std::string report, line;
+    FILE* pipe = popen(command.c_str(), "r");
+    char buffer[512];
+    while (pipe && std::fgets(buffer, sizeof(buffer), pipe))
+    {
+        line = buffer;
+        std::size_t pos = line.find(" s: ");      // "    at 2.13 s: -37 frames (lost, capture ahead)"
+        if (line.rfind("    at ", 0) == 0 && pos != std::string::npos)
+            report += (report.empty() ? "" : ",") + line.substr(pos + 4, line.find(" ", pos + 4) - pos - 4);
+    }
+    int status = pipe ? pclose(pipe) : -1;
+    fs::remove(reference_file);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) > 1)
+        return "exit=" + std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    return "dropouts=" + (report.empty() ? std::string("none") : report);
+}
+
+// runs svg_to_wav (render_liblaser, run_compare) reps times inside the svg directory, keeps the fastest wall time
+bool run_case(regress_case & test_case, int reps)
+{
+    std::string command = "cd \"" + svg_dir + "\" && \"" + fs::absolute(exec_file).string() + "\" " + test_case.args + " > /dev/null 2>&1";
+    for (int rep = 0; rep < reps; rep++)
+    {
+        fs::remove(test_case.wav_file);
+        auto start = std::chrono::steady_clock::now();
+        bool svg_to_wav = test_case.golden_args.empty() && !test_case.compare;
+        int status = svg_to_wav ? std::system(command.c_str()) : 0;
+        int api_error = test_case.golden_args.empty() ? LASER_OK : render_liblaser(test_case);
+        std::string compare_result = test_case.compare ? run_compare(test_case) : "";
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        std::string result;
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        if (api_error != LASER_OK)
+            code = -api_error;
+        std::uint64_t hash = 0;
+        std::size_t payload_bytes = 0;
+        if (test_case.compare)
+            result = compare_result;
+        else if (code != 0)
+            result = "exit=" + std::to_string(code);
+        else if (!hash_wav_payload(test_case.wav_file, &hash, &payload_bytes))
+            result = "invalid_wav";
+        else
+        {
+            std::ostringstream hex;
+            hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+            result = hex.str();
+            test_case.samples = payload_bytes / 4;
+            if (scope_dir.length() && rep == reps - 1 && !render_scope_image(test_case))
+                result = "scope_failed";
+        }
+        fs::remove(test_case.wav_file);
+
+        if (rep > 0 && result != test_case.result)
+        {
+            test_case.status = "FAIL nondeterministic output";
+            return false;
+        }
+        test_case.result = result;
+        test_case.wall_ns = rep == 0 ? ns : std::min(test_case.wall_ns, ns);
+    }
+    return true;
+}
+
+// reads <key>|<value> lines
+std::map<std::string, std::string> read_table(std::string file)
+{
+    std::map<std::string, std::string> table;
+    std::ifstream file_table(file);
+    std::string line;
+    while (std::getline(file_table, line))
+    {
+        std::size_t pos = line.rfind("|");
+        if (line.rfind("//", 0) == 0 || pos == std::string::npos)
+            continue;
+        table[line.substr(0, pos)] = line.substr(pos + 1);
+    }
+    return table;
+}
+
+void write_table(std::string file, std::string comment, std::vector<regress_case> & cases, bool perf)
+{
+    std::ofstream file_table(file);
+    file_table << "// " << comment << "\n";
+    for (regress_case & test_case : cases)
+        if (perf || test_case.golden_args.empty())  // a liblaser case shares the golden of its svg_to_wav case
+            file_table << test_case.args << "|" << (perf ? std::to_string((long long)test_case.wall_ns) : test_case.result) << "\n";
+}
+
+void write_json(std::string file, std::vector<regress_case> & cases)
+{
+    std::ofstream out(file);
+    out << "{\"cases\": [";
+    for (std::size_t i = 0; i < cases.size(); i++)
+    {
+        regress_case & c = cases[i];
+        out << (i ? ",\n  " : "\n  ") << "{\"args\": \"" << c.args << "\", \"result\": \"" << c.result << "\", \"status\": \""
+            << c.status << "\", \"samples\": " << c.samples << ", \"wall_ns\": " << std::fixed << std::setprecision(0) << c.wall_ns
+            << ", \"samples_per_sec\": " << (c.wall_ns > 0 ? c.samples * 1e9 / c.wall_ns : 0.0) << "}";
+    }
+    out << "\n]}" << std::endl;
+}
+
+int set_regress_args(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.compare("--update") == 0)
+            update = true;
+        else if (arg.rfind("--exec=", 0) == 0)
+            exec_file = value;
+        else if (arg.rfind("--svg-dir=", 0) == 0)
+            svg_dir = value;
+        else if (arg.rfind("--golden=", 0) == 0)
+            golden_file = value;
+        else if (arg.rfind("--perf=", 0) == 0)
+            perf_file = value;
+        else if (arg.rfind("--json=", 0) == 0)
+            json_file = value;
+        else if (arg.rfind("--scope=", 0) == 0)
+            scope_dir = value;
+        else if (arg.rfind("--scope-exec=", 0) == 0)
+            scope_exec = value;
+        else if (arg.rfind("--compare-exec=", 0) == 0)
+            compare_exec = value;
+        else if (arg.rfind("--threshold=", 0) == 0)
+            threshold = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--min-delta-ms=", 0) == 0)
+            min_delta_ms = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--reps=", 0) == 0)
+            reps = std::max(1, std::atoi(value.c_str()));
+        else
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (!fs::exists(exec_file) || !fs::is_directory(svg_dir))
+    {
+        std::cout << "Input Error: " << exec_file << " or " << svg_dir << " not found, build svg_to_wav first (see test.sh)" << std::endl;
+        return -2;
+    }
+    if (scope_dir.length() && !fs::exists(scope_exec))
+    {
+        std::cout << "Input Error: " << scope_exec << " not found, build laser_scope first (see laser_scope.cpp)" << std::endl;
+        return -2;
+    }
+    if (scope_dir.length())
+        fs::create_directories(scope_dir);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int retval;
+    if ((retval = set_regress_args(argc, argv)) != 0)
+        return retval;
+
+    std::map<std::string, std::string> goldens = read_table(golden_file), perf = read_table(perf_file);
+    bool write_perf = update || perf.empty();
+    std::vector<regress_case> cases = collect_cases(svg_dir);
+    int failed = 0;
+
+    for (regress_case & test_case : cases)
+    {
+        if (run_case(test_case, reps))
+        {
+            auto golden = goldens.find(test_case.golden_args.empty() ? test_case.args : test_case.golden_args);
+            auto baseline = perf.find(test_case.args);
+            if (update)
+                test_case.status = "NEW";
+            else if (golden == goldens.end())
+                test_case.status = "FAIL no golden (run with --update)";
+            else if (golden->second != test_case.result)
+                test_case.status = "FAIL output " + test_case.result + " != golden " + golden->second;
+            else if (!write_perf && baseline != perf.end())
+            {
+                double baseline_ns = std::strtod(baseline->second.c_str(), NULL);
+                bool slower = test_case.wall_ns > baseline_ns * (1.0 + threshold) && test_case.wall_ns - baseline_ns > min_delta_ms * 1e6;
+                test_case.status = slower ? "FAIL slower than baseline " + std::to_string((long long)(baseline_ns / 1e6)) + " ms" : "PASS";
+            }
+            else
+                test_case.status = "PASS";
+        }
+        if (test_case.status.rfind("FAIL", 0) == 0)
+            failed++;
+        std::cout << std::left << std::setw(6) << test_case.status.substr(0, test_case.status.find(" ")) << std::setw(95) << test_case.args
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(9) << test_case.wall_ns / 1e6 << " ms";
+        if (test_case.wall_ns > 0 && test_case.samples)
+            std::cout << std::setw(8) << std::setprecision(1) << test_case.samples / test_case.wall_ns * 1e3 << " Msamples/s";
+        if (test_case.status.find(" ") != std::string::npos)
+            std::cout << "  " << test_case.status.substr(test_case.status.find(" ") + 1);
+        std::cout << std::endl;
+    }
+
+    if (update)
+        write_table(golden_file, "laser_regress goldens: <svg_to_wav arguments>|<fnv-1a 64 of the pcm payload or exit=<code>>", cases, false);
+    if (write_perf)
+        write_table(perf_file, "laser_regress perf baseline of this machine: <svg_to_wav arguments>|<fastest wall time in ns>", cases, true);
+    if (json_file.length())
+        write_json(json_file, cases);
+
+    std::cout << cases.size() - failed << " of " << cases.size() << " cases passed" << (update ? ", goldens updated" : "") << std::endl;
+    return failed ? 1 : 0;
+}
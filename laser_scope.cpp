@@ -0,0 +1,428 @@
+/*H**********************************************************************
+* FILENAME :        laser_scope.cpp
+*
+* DESCRIPTION :
+*       Offline XY oscilloscope: reads a wav written by svg_to_wav (left = x, right = y) and rasterizes the
+*       trace into a PPM or PNG image, the way a scope in XY mode shows it, instead of photographing the scope
+*       by hand (audacity vs oscilloscope comp img). Beam model:
+*         -- the beam spends one sample period on the segment between two samples, its energy is spread evenly
+*            over the segment, so the brightness is inversely proportional to the beam velocity: slow parts and
+*            corners are bright, fast jumps between strokes are faint
+*         -- phosphor decay: a sample t seconds before the end of the file counts exp(-t / persistence), the
+*            image is the screen at the end of the file. persistence 0 = no decay, every sample counts the same
+*            (long exposure photo)
+*       Rendering is multithreaded: the samples are cut into blocks, block b goes to thread b % threads, every
+*       thread accumulates into its own buffer, the buffers are summed row-parallel at the end. No locks, no
+*       atomics in the inner loop, and the same output for the same thread count.
+*
+* PUBLIC FUNCTIONS :
+*   int render_scope(const wav_file &wav, const scope_options &options, std::vector<float> &image)
+*   void tone_map(const std::vector<float> &image, float gain, std::vector<std::uint8_t> &rgb)
+*   bool write_ppm(std::string file, int size, const std::vector<std::uint8_t> &rgb)
+*   bool write_png(std::string file, int size, const std::vector<std::uint8_t> &rgb)
+*
+How to build:
+    g++ -O2 --std=c++17 -pthread laser_scope.cpp wav_reader.c -o laser_scope
+
+How to call:
+    ./laser_scope <file.wav> <image.ppm|image.png> [options]
+    options:
+        --size=<pixels>         width and height of the square image (default 512)
+        --persistence=<s>       phosphor decay time constant in seconds (default 0 = no decay)
+        --exposure=<s>          only the last s seconds of the file (default the whole file)
+        --gain=<factor>         brightness (default 1)
+        --fit                   scale the bounding box of the trace to the image instead of the full scale
+        --y-down                y axis pointing down like the svg (a scope shows the drawing upside down)
+        --threads=<n>           render threads (default all cores)
+    e.g. ./laser_scope "svg/batman,10sec,0.10Hz,SR192000.wav" batman.png --persistence=0.5
+
+Note:
+    -- 16 bit pcm or 32 bit float wav with at least 2 channels, the first two are x and y
+    -- full scale (-32768 ... 32767, or -1 ... 1 for float) maps onto the image with a 2% margin
+    -- the image is normalized to the 99.5th percentile of the lit pixels, then 1 - exp(-gain * value) like
+       film, so a few very bright dwell points do not make the rest dark. P31 green, saturating to white
+    -- the output format follows the extension, .png is written uncompressed (stored deflate, no zlib needed)
+    -- samples whose weight is below 1e-9 (more than 20 persistence before the end) are skipped
+    -- exit code 0 on success, negative on an error
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "wav_reader.h"
+
+const int SCOPE_BLOCK = 16384;          // samples per block handed to a thread
+const float SCOPE_MARGIN = 0.02f;       // of the image on every side
+const float SCOPE_PERCENTILE = 0.995f;  // normalization point of the lit pixels
+const double SCOPE_MIN_WEIGHT = 1e-9;
+
+struct scope_options{
+    int size = 512;
+    double persistence = 0.0;
+    double exposure = 0.0;
+    float gain = 1.0f;
+    bool fit = false;
+    bool y_down = false;
+    int threads = 0;
+};
+
+// sample -> pixel coordinates
+struct scope_transform{
+    float scale_x, offset_x, scale_y, offset_y;
+};
+
+template <typename Sample>
+inline float sample_value(const std::uint8_t* frame, int channel)
+{
+    Sample value;
+    std::memcpy(&value, frame + channel * sizeof(Sample), sizeof(Sample));
+    return (float)value;
+}
+
+// energy onto the 4 pixels around (x, y)
+inline void splat(float* image, int size, float x, float y, float energy)
+{
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+    if (x0 < 0 || y0 < 0 || x0 + 1 >= size || y0 + 1 >= size)
+        return;     // outside of the screen
+    float* row = image + (std::size_t)y0 * size + x0;
+    row[0] += energy * (1 - fx) * (1 - fy);
+    row[1] += energy * fx * (1 - fy);
+    row[size] += energy * (1 - fx) * fy;
+    row[size + 1] += energy * fx * fy;
+}
+
+// segments first ... last - 1 (segment i runs from sample i to i + 1) with phosphor weights
+template <typename Sample>
+void render_range(const wav_file &wav, const scope_transform &transform, int size, double persistence, std::uint64_t end_frame,
+                  std::uint64_t first, std::uint64_t last, float* image)
+{
+    const double dt = 1.0 / wav.rate;
+    double weight = persistence > 0 ? std::exp(-(double)(end_frame - first) * dt / persistence) : 1.0;
+    const double weight_step = persistence > 0 ? std::exp(dt / persistence) : 1.0;
+    const std::uint8_t* frame = wav.data + first * wav.block_align;
+    float x = sample_value<Sample>(frame, 0) * transform.scale_x + transform.offset_x;
+    float y = sample_value<Sample>(frame, 1) * transform.scale_y + transform.offset_y;
+
+    for (std::uint64_t i = first; i < last; i++)
+    {
+        frame += wav.block_align;
+        float next_x = sample_value<Sample>(frame, 0) * transform.scale_x + transform.offset_x;
+        float next_y = sample_value<Sample>(frame, 1) * transform.scale_y + transform.offset_y;
+        float dx = next_x - x, dy = next_y - y;
+        // one splat per pixel of length, each gets its share of the segment: energy per pixel ~ 1 / velocity
+        int steps = 1 + (int)std::sqrt(dx * dx + dy * dy);
+        float energy = (float)(weight * dt) / steps;
+        for (int step = 0; step < steps; step++)
+        {
+            float t = (step + 0.5f) / steps;
+            splat(image, size, x + dx * t, y + dy * t, energy);
+        }
+        x = next_x;
+        y = next_y;
+        weight *= weight_step;
+    }
+}
+
+// sample -> pixel: full scale or the bounding box of the trace, y up like the scope
+template <typename Sample>
+scope_transform make_transform(const wav_file &wav, const scope_options &options, std::uint64_t first)
+{
+    float low_x = -32768.0f, high_x = 32767.0f, low_y = -32768.0f, high_y = 32767.0f;
+    if (sizeof(Sample) == sizeof(float))
+        low_x = low_y = -1.0f, high_x = high_y = 1.0f;
+    if (options.fit)
+    {
+        low_x = low_y = INFINITY;
+        high_x = high_y = -INFINITY;
+        for (std::uint64_t i = first; i < wav.num_frames; i++)
+        {
+            const std::uint8_t* frame = wav.data + i * wav.block_align;
+            float x = sample_value<Sample>(frame, 0), y = sample_value<Sample>(frame, 1);
+            low_x = std::min(low_x, x);
+            high_x = std::max(high_x, x);
+            low_y = std::min(low_y, y);
+            high_y = std::max(high_y, y);
+        }
+        // keep the aspect ratio, center the smaller side
+        float span = std::max(std::max(high_x - low_x, high_y - low_y), 1e-6f), center_x = (low_x + high_x) / 2, center_y = (low_y + high_y) / 2;
+        low_x = center_x - span / 2, high_x = center_x + span / 2;
+        low_y = center_y - span / 2, high_y = center_y + span / 2;
+    }
+    float pixels = (options.size - 1) * (1 - 2 * SCOPE_MARGIN), margin = (options.size - 1) * SCOPE_MARGIN;
+    scope_transform transform;
+    transform.scale_x = pixels / (high_x - low_x);
+    transform.offset_x = margin - low_x * transform.scale_x;
+    transform.scale_y = (options.y_down ? 1 : -1) * pixels / (high_y - low_y);
+    transform.offset_y = options.y_down ? margin - low_y * transform.scale_y : margin + pixels - low_y * transform.scale_y;
+    return transform;
+}
+
+template <typename Sample>
+void render_threads(const wav_file &wav, const scope_options &options, int threads, std::vector<float> &image)
+{
+    std::uint64_t first = 0, end_frame = wav.num_frames - 1;
+    if (options.exposure > 0)
+        first = (std::uint64_t)std::max(0.0, (double)end_frame - options.exposure * wav.rate);
+    if (options.persistence > 0)
+        first = std::max(first, (std::uint64_t)std::max(0.0, end_frame + options.persistence * wav.rate * std::log(SCOPE_MIN_WEIGHT)));
+    scope_transform transform = make_transform<Sample>(wav, options, first);
+    std::uint64_t blocks = (end_frame - first + SCOPE_BLOCK - 1) / SCOPE_BLOCK;
+    std::size_t pixels = (std::size_t)options.size * options.size;
+    std::vector<std::vector<float>> accumulators(threads - 1);     // thread 0 renders into image
+
+    auto worker = [&](int index) {
+        float* target = index == 0 ? image.data() : accumulators[index - 1].data();
+        for (std::uint64_t block = index; block < blocks; block += threads)
+        {
+            std::uint64_t start = first + block * SCOPE_BLOCK;
+            render_range<Sample>(wav, transform, options.size, options.persistence, end_frame, start,
+                                 std::min(start + SCOPE_BLOCK, end_frame), target);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int index = 1; index < threads; index++)
+    {
+        accumulators[index - 1].assign(pixels, 0.0f);
+        workers.emplace_back(worker, index);
+    }
+    worker(0);
+    for (std::thread &thread : workers)
+        thread.join();
+    workers.clear();
+
+    // sum the accumulators into image, row bands in parallel, always in the same order
+    auto reduce = [&](int index) {
+        std::size_t band = (pixels + threads - 1) / threads, begin = std::min(pixels, index * band), end = std::min(pixels, begin + band);
+        for (std::vector<float> &accumulator : accumulators)
+            for (std::size_t i = begin; i < end; i++)
+                image[i] += accumulator[i];
+    };
+    for (int index = 1; index < threads; index++)
+        workers.emplace_back(reduce, index);
+    reduce(0);
+    for (std::thread &thread : workers)
+        thread.join();
+}
+
+// renders the trace of wav into image (size * size, beam energy per pixel), 0 or negative on an error
+int render_scope(const wav_file &wav, const scope_options &options, std::vector<float> &image)
+{
+    if (wav.channels < 2 || wav.num_frames < 2)
+    {
+        std::cout << "Input Error: need at least 2 channels and 2 frames, the wav has " << wav.channels << " and " << wav.num_frames << std::endl;
+        return -1;
+    }
+    int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    image.assign((std::size_t)options.size * options.size, 0.0f);
+    if (wav.format == WAV_FORMAT_PCM && wav.bits_per_sample == 16)
+        render_threads<std::int16_t>(wav, options, threads, image);
+    else if (wav.format == WAV_FORMAT_FLOAT && wav.bits_per_sample == 32)
+        render_threads<float>(wav, options, threads, image);
+    else
+    {
+        std::cout << "Input Error: only 16 bit pcm and 32 bit float wav, not format " << wav.format << " with " << wav.bits_per_sample << " bits" << std::endl;
+        return -2;
+    }
+    return 0;
+}
+
+// beam energy -> 8 bit rgb
+void tone_map(const std::vector<float> &image, float gain, std::vector<std::uint8_t> &rgb)
+{
+    std::vector<float> lit;
+    for (float value : image)
+        if (value > 0)
+            lit.push_back(value);
+    float reference = 1.0f;
+    if (!lit.empty())
+    {
+        auto nth = lit.begin() + (std::size_t)((lit.size() - 1) * SCOPE_PERCENTILE);
+        std::nth_element(lit.begin(), nth, lit.end());
+        reference = *nth;
+    }
+
+    rgb.resize(image.size() * 3);
+    for (std::size_t i = 0; i < image.size(); i++)
+    {
+        float level = 1.0f - std::exp(-gain * image[i] / reference * 2.0f);     // 2: the reference pixel at 86%
+        float white = level * level * level;                                   // the brightest parts saturate
+        rgb[3 * i] = (std::uint8_t)(255.0f * (0.15f * level + 0.85f * white) + 0.5f);
+        rgb[3 * i + 1] = (std::uint8_t)(255.0f * level + 0.5f);
+        rgb[3 * i + 2] = (std::uint8_t)(255.0f * (0.25f * level + 0.75f * white) + 0.5f);
+    }
+}
+
+bool write_ppm(std::string file, int size, const std::vector<std::uint8_t> &rgb)
+{
+    std::ofstream out(file, std::ios::binary);
+    out << "P6\n" << size << " " << size << "\n255\n";
+    out.write((const char*)rgb.data(), rgb.size());
+    return (bool)out;
+}
+
+std::uint32_t png_crc(const std::uint8_t* data, std::size_t size, std::uint32_t crc)
+{
+    static std::uint32_t table[256];
+    if (table[1] == 0)
+        for (std::uint32_t n = 0; n < 256; n++)
+        {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    for (std::size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+void put_be32(std::vector<std::uint8_t> &out, std::uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((std::uint8_t)(value >> shift));
+}
+
+void png_chunk(std::ofstream &out, const char* type, const std::vector<std::uint8_t> &data)
+{
+    std::vector<std::uint8_t> chunk;
+    put_be32(chunk, (std::uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_be32(chunk, png_crc(chunk.data() + 4, chunk.size() - 4, 0xFFFFFFFFu) ^ 0xFFFFFFFFu);
+    out.write((const char*)chunk.data(), chunk.size());
+}
+
+// 8 bit rgb png, zlib stream of stored (uncompressed) deflate blocks
+bool write_png(std::string file, int size, const std::vector<std::uint8_t> &rgb)
+{
+    std::vector<std::uint8_t> raw, header, zlib = {0x78, 0x01};
+    for (int row = 0; row < size; row++)
+    {
+        raw.push_back(0);   // filter none
+        raw.insert(raw.end(), rgb.begin() + (std::size_t)row * size * 3, rgb.begin() + (std::size_t)(row + 1) * size * 3);
+    }
+    std::uint32_t adler_a = 1, adler_b = 0;
+    for (std::uint8_t byte : raw)
+    {
+        adler_a = (adler_a + byte) % 65521;
+        adler_b = (adler_b + adler_a) % 65521;
+    }
+    for (std::size_t pos = 0; pos < raw.size(); pos += 65535)
+    {
+        std::uint16_t length = (std::uint16_t)std::min<std::size_t>(65535, raw.size() - pos);
+        zlib.push_back(pos + length == raw.size() ? 1 : 0);
+        zlib.insert(zlib.end(), {(std::uint8_t)length, (std::uint8_t)(length >> 8), (std::uint8_t)~length, (std::uint8_t)(~length >> 8)});
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+    }
+    put_be32(zlib, (adler_b << 16) | adler_a);
+
+    put_be32(header, size);
+    put_be32(header, size);
+    header.insert(header.end(), {8, 2, 0, 0, 0});     // 8 bit, rgb, deflate, no filter, no interlace
+    std::ofstream out(file, std::ios::binary);
+    out.write("\x89PNG\r\n\x1a\n", 8);
+    png_chunk(out, "IHDR", header);
+    png_chunk(out, "IDAT", zlib);
+    png_chunk(out, "IEND", {});
+    return (bool)out;
+}
+
+int set_scope_args(int argc, char* argv[], std::string &wav_name, std::string &image_name, scope_options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i], value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos)
+            value = arg.substr(pos + 1);
+
+        if (arg.rfind("--size=", 0) == 0)
+            options.size = std::atoi(value.c_str());
+        else if (arg.rfind("--persistence=", 0) == 0)
+            options.persistence = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--exposure=", 0) == 0)
+            options.exposure = std::strtod(value.c_str(), NULL);
+        else if (arg.rfind("--gain=", 0) == 0)
+            options.gain = std::strtof(value.c_str(), NULL);
+        else if (arg.compare("--fit") == 0)
+            options.fit = true;
+        else if (arg.compare("--y-down") == 0)
+            options.y_down = true;
+        else if (arg.rfind("--threads=", 0) == 0)
+            options.threads = std::atoi(value.c_str());
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -1;
+        }
+        else if (wav_name.empty())
+            wav_name = arg;
+        else if (image_name.empty())
+            image_name = arg;
+        else
+        {
+            std::cout << "Invalid argument: " << arg << std::endl;
+            return -1;
+        }
+    }
+    if (wav_name.empty() || image_name.empty())
+    {
+        std::cout << "Input Error: usage: laser_scope <file.wav> <image.ppm|image.png> [options], see laser_scope.cpp" << std::endl;
+        return -1;
+    }
+    if (options.size < 16 || options.size > 8192 || options.persistence < 0 || options.exposure < 0 || !(options.gain > 0))
+    {
+        std::cout << "Invalid argument: --size 16 ... 8192, --persistence and --exposure >= 0, --gain > 0" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string wav_name, image_name;
+    scope_options options;
+    int retval;
+    if ((retval = set_scope_args(argc, argv, wav_name, image_name, options)) != 0)
+        return retval;
+
+    wav_file wav;
+    if ((retval = wav_open(&wav, wav_name.c_str())) != WAV_OK)
+    {
+        std::cout << "Input Error: " << wav_name << ": " << wav_strerror(retval) << std::endl;
+        return -2;
+    }
+    std::vector<float> image;
+    std::vector<std::uint8_t> rgb;
+    auto start = std::chrono::steady_clock::now();
+    retval = render_scope(wav, options, image);
+    double render_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::uint64_t frames = wav.num_frames;
+    unsigned int rate = wav.rate;
+    wav_close(&wav);
+    if (retval != 0)
+        return -3;
+
+    tone_map(image, options.gain, rgb);
+    bool png = image_name.size() > 4 && image_name.compare(image_name.size() - 4, 4, ".png") == 0;
+    if (!(png ? write_png(image_name, options.size, rgb) : write_ppm(image_name, options.size, rgb)))
+    {
+        std::cout << "ERROR: Can't write " << image_name << std::endl;
+        return -4;
+    }
+    std::cout << wav_name << ": " << frames << " frames (" << (double)frames / rate << " s) rendered in " << render_ms << " ms -> "
+              << image_name << std::endl;
+    return 0;
+}
@@ -0,0 +1,276 @@
+/*H**********************************************************************
+* FILENAME :        liblaser.cpp
+*
+* DESCRIPTION :
+*       liblaser, the C interface of laser.h on top of laser_core.hpp. No globals, every call works on the
+*       objects passed in.
+*
+How to build:
+    static: g++ -O2 --std=c++17 -c liblaser.cpp -o liblaser.o && ar rcs liblaser.a liblaser.o
+    shared: g++ -O2 --std=c++17 -fPIC -shared liblaser.cpp -o liblaser.so
+    link C programs with: gcc player.c liblaser.a -lstdc++ -lm
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <new>
+#include <vector>
+#include "laser.h"
+#include "laser_core.hpp"
+
+struct laser_point{
+    double x, y;
+    laser_point(double mx, double my) : x(mx), y(my){}
+    double get_x() const { return x; }
+    double get_y() const { return y; }
+};
+
+struct laser_shape{
+    std::vector<laser_point> points;    // rescaled
+};
+
+struct laser_lut{
+    int wave;
+    std::uint32_t lut_size;
+    std::vector<std::int16_t> table_x, table_y;    // table_y empty for sine/rectangle
+    float phase_y;                                  // initial phase of y
+};
+
+struct laser_renderer{
+    const laser_lut* lut;
+    laser_core::render_tables tables;
+    float increment;
+    int sampling_rate;
+    float initial_phase_y;
+    laser_core::phase_state state;
+};
+
+extern "C" {
+
+int laser_shape_load(const char *points_file, laser_shape **shape)
+{
+    if (!points_file || !shape)
+        return LASER_ERR_ARG;
+    try
+    {
+        std::unique_ptr<laser_shape> result(new laser_shape());     // freed on an error or bad_alloc
+        int canvas_height = 400, canvas_width = 400;    // svg_to_wav default
+        int error = laser_core::load_points(points_file, result->points, &canvas_height, &canvas_width);
+        if (error == LASER_OK && (canvas_height <= 0 || canvas_width <= 0))
+            error = LASER_ERR_FORMAT;
+        if (error != LASER_OK)
+            return error;
+        for (laser_point &point : result->points)
+            laser_core::rescale(point.x, point.y, canvas_height, canvas_width, LASER_AMP_MULTIPLYER);
+        *shape = result.release();
+        return LASER_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return LASER_ERR_MEMORY;
+    }
+}
+
+int laser_shape_from_points(const double *xy, size_t num_points, int canvas_height, int canvas_width, laser_shape **shape)
+{
+    if ((!xy && num_points) || !shape || canvas_height <= 0 || canvas_width <= 0)
+        return LASER_ERR_ARG;
+    try
+    {
+        std::unique_ptr<laser_shape> result(new laser_shape());
+        result->points.reserve(num_points);
+        for (size_t i = 0; i < num_points; i++)
+        {
+            laser_point point(xy[2 * i], xy[2 * i + 1]);
+            laser_core::rescale(point.x, point.y, canvas_height, canvas_width, LASER_AMP_MULTIPLYER);
+            result->points.push_back(point);
+        }
+        *shape = result.release();
+        return LASER_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return LASER_ERR_MEMORY;
+    }
+}
+
+size_t laser_shape_points(const laser_shape *shape)
+{
+    return shape ? shape->points.size() : 0;
+}
+
+void laser_shape_free(laser_shape *shape)
+{
+    delete shape;
+}
+
+int laser_lut_build(const laser_shape *shape, int wave, uint32_t max_lut_size, laser_lut **lut)
+{
+    if (!lut || (wave != LASER_WAVE_INPUT && wave != LASER_WAVE_SINE && wave != LASER_WAVE_RECTANGLE) ||
+        (wave == LASER_WAVE_INPUT && (!shape || shape->points.empty())))
+        return LASER_ERR_ARG;
+
+    int interpolation_factor = 0;
+    std::uint32_t lut_size = max_lut_size ? max_lut_size : LASER_DEFAULT_LUT_SIZE;
+    if (shape)
+        lut_size = laser_core::size_lut(lut_size, shape->points.size(), &interpolation_factor);
+    if (lut_size == 0)
+        return LASER_ERR_ARG;
+
+    try
+    {
+        std::unique_ptr<laser_lut> result(new laser_lut());         // freed when a table does not fit
+        result->wave = wave;
+        result->lut_size = lut_size;
+        result->table_x.resize(lut_size);
+        result->phase_y = 0.0f;
+        if (wave == LASER_WAVE_INPUT)
+        {
+            result->table_y.resize(lut_size);
+            laser_core::build_input_lut(result->table_x.data(), result->table_y.data(), lut_size, shape->points, interpolation_factor);
+        }
+        else
+            result->phase_y = laser_core::build_wave_lut(result->table_x.data(), lut_size, wave);
+        *lut = result.release();
+        return LASER_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return LASER_ERR_MEMORY;
+    }
+}
+
+uint32_t laser_lut_size(const laser_lut *lut)
+{
+    return lut ? lut->lut_size : 0;
+}
+
+void laser_lut_free(laser_lut *lut)
+{
+    delete lut;
+}
+
+int laser_renderer_create(const laser_lut *lut, float freq, int sampling_rate, unsigned flags, laser_renderer **renderer)
+{
+    if (!lut || !renderer || !(freq > 0.0f) || sampling_rate <= 0)
+        return LASER_ERR_ARG;
+    laser_renderer* result = new (std::nothrow) laser_renderer();
+    if (!result)
+        return LASER_ERR_MEMORY;
+
+    result->lut = lut;
+    result->tables.table_x = lut->table_x.data();
+    result->tables.table_y = lut->table_y.empty() ? lut->table_x.data() : lut->table_y.data();
+    result->tables.lut_size = lut->lut_size;
+    result->tables.trigger = lut->wave == LASER_WAVE_INPUT && (flags & LASER_RENDER_TRIGGER);
+    result->increment = laser_core::phase_increment(freq, sampling_rate, lut->lut_size);
+    result->sampling_rate = sampling_rate;
+    result->initial_phase_y = lut->phase_y;
+    laser_renderer_reset(result);
+    *renderer = result;
+    return LASER_OK;
+}
+
+int laser_render(laser_renderer *renderer, int16_t *frames, size_t num_frames)
+{
+    if (!renderer || (!frames && num_frames))
+        return LASER_ERR_ARG;
+    laser_core::render(renderer->tables, renderer->increment, renderer->state, frames, frames + 1, 2, num_frames);
+    return LASER_OK;
+}
+
+int laser_render_planar(laser_renderer *renderer, int16_t *x, int16_t *y, size_t num_frames)
+{
+    if (!renderer || ((!x || !y) && num_frames))
+        return LASER_ERR_ARG;
+    laser_core::render(renderer->tables, renderer->increment, renderer->state, x, y, 1, num_frames);
+    return LASER_OK;
+}
+
+int laser_render_to_cycle_end(laser_renderer *renderer, int16_t *frames, size_t num_frames, size_t *rendered, int *cycle_end)
+{
+    if (!renderer || (!frames && num_frames) || !rendered || !cycle_end)
+        return LASER_ERR_ARG;
+    bool end = false;
+    *rendered = laser_core::render(renderer->tables, renderer->increment, renderer->state, frames, frames + 1, 2, num_frames, &end);
+    *cycle_end = end;
+    return LASER_OK;
+}
+
+int laser_renderer_set_freq(laser_renderer *renderer, float freq)
+{
+    if (!renderer || !(freq > 0.0f))
+        return LASER_ERR_ARG;
+    renderer->increment = laser_core::phase_increment(freq, renderer->sampling_rate, renderer->tables.lut_size);
+    return LASER_OK;
+}
+
+void laser_renderer_reset(laser_renderer *renderer)
+{
+    if (!renderer)
+        return;
+    renderer->state = laser_core::phase_state();
+    renderer->state.phase_y = renderer->initial_phase_y;
+}
+
+int laser_renderer_rewind(laser_renderer *renderer, size_t num_frames)
+{
+    if (!renderer)
+        return LASER_ERR_ARG;
+    const double size = renderer->tables.lut_size;
+    const double back = std::fmod((double)renderer->increment * (double)num_frames, size);
+    float* phases[2] = {&renderer->state.phase_x, &renderer->state.phase_y};
+    for (float* phase : phases)
+    {
+        double rewound = *phase - back;
+        *phase = (float)(rewound < 0.0 ? rewound + size : rewound);
+        if (*phase >= (float)size)     // rounded up to the wrap
+            *phase = 0.0f;
+    }
+    renderer->state.frame -= std::min<std::uint64_t>(num_frames, renderer->state.frame);     // trigger pulse again
+    return LASER_OK;
+}
+
+void laser_renderer_free(laser_renderer *renderer)
+{
+    delete renderer;
+}
+
+int laser_write_wav(laser_renderer *renderer, const char *wav_file, size_t num_frames)
+{
+    if (!renderer || !wav_file || num_frames > UINT32_MAX / 4 - 36)    // riff sizes are 32 bit
+        return LASER_ERR_ARG;
+    std::ofstream file_wav(wav_file, std::ios::binary);
+    if (!file_wav.is_open())
+        return LASER_ERR_OPEN;
+
+    std::int16_t frames[laser_core::PCM_CHUNK_FRAMES * 2];
+    laser_core::write_wav_header(file_wav, renderer->sampling_rate, (std::uint32_t)num_frames);
+    for (size_t start = 0; start < num_frames && file_wav; start += laser_core::PCM_CHUNK_FRAMES)
+    {
+        size_t count = std::min(laser_core::PCM_CHUNK_FRAMES, num_frames - start);
+        laser_render(renderer, frames, count);
+        laser_core::write_pcm(file_wav, frames, frames + 1, 2, count);
+    }
+    file_wav.close();
+    return file_wav ? LASER_OK : LASER_ERR_WRITE;
+}
+
+const char *laser_strerror(int error)
+{
+    switch (error)
+    {
+    case LASER_OK:          return "no error";
+    case LASER_ERR_ARG:     return "invalid argument";
+    case LASER_ERR_OPEN:    return "file can not be opened";
+    case LASER_ERR_FORMAT:  return "invalid points file, see svg_to_wav.cpp header comment for the format";
+    case LASER_ERR_MEMORY:  return "out of memory";
+    case LASER_ERR_WRITE:   return "writing the wav file failed";
+    default:                return "unknown error";
+    }
+}
+
+}
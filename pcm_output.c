@@ -0,0 +1,586 @@
+/*H**********************************************************************
+* FILENAME :        pcm_output.c
+*
+* DESCRIPTION :
+*       ALSA playback output with mmap access and rw fallback, device probing, autotuning, profiles and xrun
+*       telemetry, see pcm_output.h. C, compiles as C++ too so the C++ players can put it on their g++ line.
+*
+How to build:
+    gcc -O2 -c pcm_output.c -o pcm_output.o         (or list pcm_output.c in the player compile line)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pcm_output.h"
+
+#define AUTOTUNE_MIN_PERIOD 16
+#define AUTOTUNE_MAX_CANDIDATES 64
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* interleaved S16_LE with the given access, rate/period/periods are updated to what the device accepted */
+static int set_hw_params(pcm_output *out, snd_pcm_access_t access, unsigned int *rate,
+                         snd_pcm_uframes_t *period_size, unsigned int *periods)
+{
+    int err;
+    snd_pcm_hw_params_t *params;
+
+    snd_pcm_hw_params_alloca(&params);
+    if ((err = snd_pcm_hw_params_any(out->pcm, params)) < 0 ||
+        (err = snd_pcm_hw_params_set_access(out->pcm, params, access)) < 0 ||
+        (err = snd_pcm_hw_params_set_format(out->pcm, params, SND_PCM_FORMAT_S16_LE)) < 0 ||
+        (err = snd_pcm_hw_params_set_channels(out->pcm, params, out->channels)) < 0 ||
+        (err = snd_pcm_hw_params_set_rate_near(out->pcm, params, rate, 0)) < 0 ||
+        (err = snd_pcm_hw_params_set_period_size_near(out->pcm, params, period_size, 0)) < 0 ||
+        (err = snd_pcm_hw_params_set_periods_near(out->pcm, params, periods, 0)) < 0 ||
+        (err = snd_pcm_hw_params(out->pcm, params)) < 0)
+        return err;
+
+    snd_pcm_hw_params_get_rate(params, &out->rate, 0);
+    snd_pcm_hw_params_get_period_size(params, &out->period_size, 0);
+    snd_pcm_hw_params_get_buffer_size(params, &out->buffer_size);
+    out->mmap = access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+    return 0;
+}
+
+/* xrun (-EPIPE) or suspend (-ESTRPIPE): prepare again, other errors are returned */
+static int recover(pcm_output *out, int err)
+{
+    if (err == -EPIPE || err == -ESTRPIPE)
+    {
+        out->xruns++;
+        if (out->xrun_start_ns == 0)
+            out->xrun_start_ns = now_ns();
+    }
+    return snd_pcm_recover(out->pcm, err, 1);
+}
+
+/* after an xrun: the recovery ends when the stream runs again */
+static void check_recovered(pcm_output *out)
+{
+    uint64_t recovery;
+    if (out->xrun_start_ns == 0 || snd_pcm_state(out->pcm) != SND_PCM_STATE_RUNNING)
+        return;
+    recovery = now_ns() - out->xrun_start_ns;
+    out->recovery_ns_total += recovery;
+    if (recovery > out->recovery_ns_max)
+        out->recovery_ns_max = recovery;
+    out->xrun_start_ns = 0;
+}
+
+/* the device wakes the writer at avail_min (one period) free, everything beyond that accumulated while it was late */
+static void record_wakeup(pcm_output *out, snd_pcm_sframes_t avail)
+{
+    snd_pcm_uframes_t late = (snd_pcm_uframes_t)avail > out->period_size ? (snd_pcm_uframes_t)avail - out->period_size : 0;
+    rt_histogram_add(out->wakeup_hist, (uint64_t)late * 1000000000ULL / out->rate);
+}
+
+/* rw with a wake-up histogram: wait here instead of inside snd_pcm_writei */
+static void wait_writable(pcm_output *out)
+{
+    snd_pcm_sframes_t avail;
+    if (snd_pcm_state(out->pcm) != SND_PCM_STATE_RUNNING)
+        return;
+    avail = snd_pcm_avail_update(out->pcm);
+    if (avail >= 0 && (snd_pcm_uframes_t)avail >= out->period_size)
+        return;     /* no wait, nothing to measure */
+    if (snd_pcm_wait(out->pcm, PCM_OUTPUT_WAIT_MS) > 0 && (avail = snd_pcm_avail_update(out->pcm)) >= 0)
+        record_wakeup(out, avail);
+}
+
+/* snd_pcm_writei, timed if write_hist is set */
+static snd_pcm_sframes_t timed_writei(pcm_output *out, const int16_t *frames, snd_pcm_uframes_t num_frames)
+{
+    uint64_t start;
+    snd_pcm_sframes_t result;
+
+    if (out->wakeup_hist)
+        wait_writable(out);
+    if (!out->write_hist)
+        return snd_pcm_writei(out->pcm, frames, num_frames);
+    start = now_ns();
+    result = snd_pcm_writei(out->pcm, frames, num_frames);
+    rt_histogram_add(out->write_hist, now_ns() - start);
+    return result;
+}
+
+int pcm_output_open(pcm_output *out, const char *device, unsigned int rate, unsigned int channels,
+                    snd_pcm_uframes_t period_size, unsigned int periods, int access)
+{
+    int err;
+    unsigned int try_rate = rate, try_periods = periods;
+    snd_pcm_uframes_t try_period = period_size;
+    snd_pcm_sw_params_t *sw_params;
+
+    memset(out, 0, sizeof(*out));
+    out->channels = channels;
+    if ((err = snd_pcm_open(&out->pcm, device, SND_PCM_STREAM_PLAYBACK, 0)) < 0)
+        return err;
+
+    err = -EINVAL;
+    if (access != PCM_ACCESS_RW)
+        err = set_hw_params(out, SND_PCM_ACCESS_MMAP_INTERLEAVED, &try_rate, &try_period, &try_periods);
+    if (err < 0 && access != PCM_ACCESS_MMAP)
+    {   /* no mmap on this device (e.g. some plugins), copy with snd_pcm_writei */
+        try_rate = rate;
+        try_periods = periods;
+        try_period = period_size;
+        err = set_hw_params(out, SND_PCM_ACCESS_RW_INTERLEAVED, &try_rate, &try_period, &try_periods);
+    }
+    if (err < 0)
+    {
+        snd_pcm_close(out->pcm);
+        out->pcm = NULL;
+        return err;
+    }
+
+    /* start once the buffer is full (rw: by snd_pcm_writei, mmap: by pcm_output_begin) */
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(out->pcm, sw_params);
+    snd_pcm_sw_params_set_start_threshold(out->pcm, sw_params, out->buffer_size);
+    snd_pcm_sw_params_set_avail_min(out->pcm, sw_params, out->period_size);
+    if ((err = snd_pcm_sw_params(out->pcm, sw_params)) < 0)
+    {
+        snd_pcm_close(out->pcm);
+        out->pcm = NULL;
+        return err;
+    }
+
+    if (!out->mmap)
+    {
+        out->staging = (int16_t *)malloc(out->period_size * out->channels * sizeof(int16_t));
+        if (!out->staging)
+        {
+            snd_pcm_close(out->pcm);
+            out->pcm = NULL;
+            return -ENOMEM;
+        }
+    }
+    return 0;
+}
+
+int pcm_output_begin(pcm_output *out, int16_t **frames, snd_pcm_uframes_t *num_frames)
+{
+    int err, waited = 0;
+    snd_pcm_sframes_t avail;
+    snd_pcm_uframes_t offset, wanted = *num_frames;
+    snd_pcm_uframes_t need = wanted < out->period_size ? wanted : out->period_size;
+    const snd_pcm_channel_area_t *areas;
+
+    *num_frames = 0;
+    if (!out->mmap)
+    {   /* staging period, snd_pcm_writei blocks in commit */
+        *frames = out->staging;
+        *num_frames = need;
+        return 0;
+    }
+    if (wanted == 0)
+        return 0;
+
+    for (;;)
+    {
+        avail = snd_pcm_avail_update(out->pcm);
+        if (avail < 0)
+        {
+            waited = 0;
+            if ((err = recover(out, (int)avail)) < 0)
+                return err;
+            continue;
+        }
+        if ((snd_pcm_uframes_t)avail < need)
+        {
+            if (snd_pcm_state(out->pcm) == SND_PCM_STATE_PREPARED)
+            {   /* buffer full and not running yet */
+                if ((err = snd_pcm_start(out->pcm)) < 0)
+                    return err;
+                check_recovered(out);
+                continue;
+            }
+            err = snd_pcm_wait(out->pcm, PCM_OUTPUT_WAIT_MS);
+            if (err == 0)
+                return 0;   /* timeout, nothing granted */
+            if (err < 0 && (err = recover(out, err)) < 0)
+                return err;
+            waited = err > 0;
+            continue;
+        }
+        if (waited && out->wakeup_hist)
+            record_wakeup(out, avail);
+
+        *num_frames = wanted;
+        if ((err = snd_pcm_mmap_begin(out->pcm, &areas, &offset, num_frames)) < 0)
+        {
+            *num_frames = 0;
+            if ((err = recover(out, err)) < 0)
+                return err;
+            continue;
+        }
+        /* interleaved: all channels share areas[0], first and step are in bits */
+        *frames = (int16_t *)((char *)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8);
+        out->mmap_offset = offset;
+        return 0;
+    }
+}
+
+int pcm_output_commit(pcm_output *out, snd_pcm_uframes_t num_frames)
+{
+    int err;
+    uint64_t start = 0;
+    snd_pcm_sframes_t result;
+    snd_pcm_uframes_t done = 0;
+
+    if (out->mmap)
+    {
+        if (out->write_hist)
+            start = now_ns();
+        result = snd_pcm_mmap_commit(out->pcm, out->mmap_offset, num_frames);
+        if (out->write_hist)
+            rt_histogram_add(out->write_hist, now_ns() - start);
+        if (result >= 0 && (snd_pcm_uframes_t)result == num_frames)
+        {
+            check_recovered(out);
+            return 0;
+        }
+        err = recover(out, result < 0 ? (int)result : -EPIPE);     /* the region is lost, as on any xrun */
+        return err < 0 ? err : 0;
+    }
+
+    while (done < num_frames)
+    {
+        result = timed_writei(out, out->staging + done * out->channels, num_frames - done);
+        if (result == -EAGAIN)
+            continue;
+        if (result < 0)
+        {
+            if ((err = recover(out, (int)result)) < 0)
+                return err;
+            continue;
+        }
+        done += (snd_pcm_uframes_t)result;
+    }
+    check_recovered(out);
+    return 0;
+}
+
+snd_pcm_sframes_t pcm_output_write(pcm_output *out, const int16_t *frames, snd_pcm_uframes_t num_frames)
+{
+    int err;
+    int16_t *region = NULL;
+    snd_pcm_uframes_t count, done = 0;
+    snd_pcm_sframes_t result;
+
+    while (done < num_frames)
+    {
+        if (out->mmap)
+        {
+            count = num_frames - done;
+            if ((err = pcm_output_begin(out, &region, &count)) < 0)
+                return err;
+            if (count == 0)
+                continue;   /* timeout, wait again */
+            memcpy(region, frames + done * out->channels, count * out->channels * sizeof(int16_t));
+            if ((err = pcm_output_commit(out, count)) < 0)
+                return err;
+            done += count;
+        }
+        else
+        {   /* straight from the caller buffer, no staging copy */
+            result = timed_writei(out, frames + done * out->channels, num_frames - done);
+            if (result == -EAGAIN)
+                continue;
+            if (result < 0)
+            {
+                if ((err = recover(out, (int)result)) < 0)
+                    return err;
+                continue;
+            }
+            done += (snd_pcm_uframes_t)result;
+            check_recovered(out);
+        }
+    }
+    return (snd_pcm_sframes_t)done;
+}
+
+void pcm_output_close(pcm_output *out, int drain)
+{
+    if (!out->pcm)
+        return;
+    if (drain)
+    {
+        if (snd_pcm_state(out->pcm) == SND_PCM_STATE_PREPARED &&
+            snd_pcm_avail_update(out->pcm) < (snd_pcm_sframes_t)out->buffer_size)
+            snd_pcm_start(out->pcm);    /* less than a buffer was queued */
+        snd_pcm_drain(out->pcm);
+    }
+    else
+        snd_pcm_drop(out->pcm);
+    snd_pcm_close(out->pcm);
+    free(out->staging);
+    out->pcm = NULL;
+    out->staging = NULL;
+}
+
+const char *pcm_output_access_name(const pcm_output *out)
+{
+    return out->mmap ? "mmap" : "rw";
+}
+
+int pcm_output_parse_access(const char *name)
+{
+    if (strcmp(name, "auto") == 0)
+        return PCM_ACCESS_AUTO;
+    if (strcmp(name, "mmap") == 0)
+        return PCM_ACCESS_MMAP;
+    if (strcmp(name, "rw") == 0)
+        return PCM_ACCESS_RW;
+    return -1;
+}
+
+void pcm_output_report(const pcm_output *out, FILE *stream)
+{
+    fprintf(stream, "xruns: %lu", out->xruns);
+    if (out->xruns)
+        fprintf(stream, ", recovery avg %.2f ms, max %.2f ms", out->recovery_ns_total / 1e6 / out->xruns,
+                out->recovery_ns_max / 1e6);
+    fprintf(stream, "\n");
+}
+
+int pcm_output_poll_descriptors(pcm_output *out, struct pollfd *pfds, int space)
+{
+    int count = snd_pcm_poll_descriptors_count(out->pcm);
+    if (count < 0)
+        return count;
+    if (count > space)
+        return -ENOSPC;
+    return snd_pcm_poll_descriptors(out->pcm, pfds, (unsigned int)space);
+}
+
+int pcm_output_poll_ready(pcm_output *out, struct pollfd *pfds, int count)
+{
+    int err;
+    unsigned short revents;
+    snd_pcm_sframes_t avail;
+
+    if (snd_pcm_state(out->pcm) != SND_PCM_STATE_RUNNING)
+        return 1;       /* begin/commit fill, start or recover it */
+    if ((err = snd_pcm_poll_descriptors_revents(out->pcm, pfds, (unsigned int)count, &revents)) < 0)
+        return err;
+    if (revents & POLLERR)
+        return 1;
+    if (!(revents & POLLOUT))
+        return 0;
+    if (out->wakeup_hist && (avail = snd_pcm_avail_update(out->pcm)) >= 0)
+        record_wakeup(out, avail);
+    return 1;
+}
+
+int pcm_output_probe(const char *device, unsigned int rate, unsigned int channels, pcm_caps *caps)
+{
+    int err, dir = 0;
+    snd_pcm_t *pcm;
+    snd_pcm_hw_params_t *params;
+
+    memset(caps, 0, sizeof(*caps));
+    if ((err = snd_pcm_open(&pcm, device, SND_PCM_STREAM_PLAYBACK, 0)) < 0)
+        return err;
+    snd_pcm_hw_params_alloca(&params);
+    caps->rate = rate;
+    if ((err = snd_pcm_hw_params_any(pcm, params)) < 0 ||
+        (err = snd_pcm_hw_params_set_format(pcm, params, SND_PCM_FORMAT_S16_LE)) < 0 ||
+        (err = snd_pcm_hw_params_set_channels(pcm, params, channels)) < 0 ||
+        (err = snd_pcm_hw_params_set_rate_near(pcm, params, &caps->rate, 0)) < 0)
+    {
+        snd_pcm_close(pcm);
+        return err;
+    }
+    caps->mmap = snd_pcm_hw_params_test_access(pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+    snd_pcm_hw_params_get_period_size_min(params, &caps->period_min, &dir);
+    snd_pcm_hw_params_get_period_size_max(params, &caps->period_max, &dir);
+    snd_pcm_hw_params_get_buffer_size_min(params, &caps->buffer_min);
+    snd_pcm_hw_params_get_buffer_size_max(params, &caps->buffer_max);
+    snd_pcm_close(pcm);
+    return 0;
+}
+
+typedef struct tune_candidate{
+    snd_pcm_uframes_t period_size;
+    unsigned int periods;
+} tune_candidate;
+
+/* lower buffer latency first, at the same latency more (smaller) periods first */
+static int compare_candidates(const void *a, const void *b)
+{
+    const tune_candidate *ca = (const tune_candidate *)a, *cb = (const tune_candidate *)b;
+    snd_pcm_uframes_t la = ca->period_size * ca->periods, lb = cb->period_size * cb->periods;
+    if (la != lb)
+        return la < lb ? -1 : 1;
+    return ca->periods > cb->periods ? -1 : ca->periods < cb->periods;
+}
+
+static void burn_cpu(uint64_t ns)
+{
+    uint64_t end = now_ns() + ns;
+    while (now_ns() < end)
+        ;
+}
+
+/* plays test_ms of silence with load * period time of busy cpu per period, *out keeps the accepted config */
+static int run_load_test(const char *device, unsigned int rate, unsigned int channels, const tune_candidate *candidate,
+                         double load, unsigned int test_ms, pcm_output *result)
+{
+    int err;
+    int16_t *frames;
+    snd_pcm_uframes_t count;
+    uint64_t played = 0, total;
+    pcm_output out;
+
+    if ((err = pcm_output_open(&out, device, rate, channels, candidate->period_size, candidate->periods, PCM_ACCESS_AUTO)) < 0)
+        return err;
+    total = (uint64_t)out.rate * test_ms / 1000;
+    while (played < total)
+    {
+        count = out.period_size;
+        if ((err = pcm_output_begin(&out, &frames, &count)) < 0)
+            break;
+        if (count == 0)
+            continue;
+        memset(frames, 0, count * out.channels * sizeof(int16_t));
+        burn_cpu((uint64_t)(load * 1e9 * count / out.rate));
+        if ((err = pcm_output_commit(&out, count)) < 0)
+            break;
+        played += count;
+    }
+    pcm_output_close(&out, 0);
+    *result = out;
+    return err < 0 ? err : 0;
+}
+
+int pcm_output_autotune(const char *device, unsigned int rate, unsigned int channels, double load,
+                        unsigned int test_ms, pcm_profile *profile, FILE *log)
+{
+    int err, found = 0;
+    unsigned int periods;
+    size_t i, num_candidates = 0;
+    unsigned long best_xruns = (unsigned long)-1;
+    snd_pcm_uframes_t period, first_period, max_period;
+    tune_candidate candidates[AUTOTUNE_MAX_CANDIDATES];
+    pcm_caps caps;
+    pcm_output result;
+
+    if ((err = pcm_output_probe(device, rate, channels, &caps)) < 0)
+        return err;
+    max_period = caps.rate / 10 < caps.period_max ? caps.rate / 10 : caps.period_max;     /* 100 ms */
+    first_period = AUTOTUNE_MIN_PERIOD;
+    while (first_period < caps.period_min)
+        first_period <<= 1;
+    for (period = first_period; period <= max_period; period <<= 1)
+        for (periods = 2; periods <= 4 && num_candidates < AUTOTUNE_MAX_CANDIDATES; periods++)
+            if (period * periods >= caps.buffer_min && period * periods <= caps.buffer_max)
+            {
+                candidates[num_candidates].period_size = period;
+                candidates[num_candidates].periods = periods;
+                num_candidates++;
+            }
+    qsort(candidates, num_candidates, sizeof(tune_candidate), compare_candidates);
+
+    for (i = 0; i < num_candidates; i++)
+    {
+        err = run_load_test(device, caps.rate, channels, &candidates[i], load, test_ms, &result);
+        if (log)
+        {
+            fprintf(log, "period %5lu x %u (%6.2f ms): ", (unsigned long)candidates[i].period_size,
+                    candidates[i].periods, candidates[i].period_size * candidates[i].periods * 1000.0 / caps.rate);
+            if (err < 0)
+                fprintf(log, "%s\n", snd_strerror(err));
+            else
+                pcm_output_report(&result, log);
+        }
+        if (err < 0 || result.xruns >= best_xruns)
+            continue;
+        best_xruns = result.xruns;
+        found = 1;
+        memset(profile, 0, sizeof(*profile));
+        snprintf(profile->device, PCM_PROFILE_DEVICE_LEN, "%s", device);
+        profile->rate = result.rate;
+        profile->channels = channels;
+        profile->period_size = result.period_size;
+        profile->periods = (unsigned int)(result.buffer_size / result.period_size);
+        profile->access = result.mmap ? PCM_ACCESS_MMAP : PCM_ACCESS_RW;
+        if (result.xruns == 0)
+            break;
+    }
+    return found ? 0 : -EINVAL;
+}
+
+static const char *access_names[] = {"auto", "mmap", "rw"};
+
+/* one profile line, 0 if it parsed */
+static int parse_profile_line(const char *line, pcm_profile *profile)
+{
+    char access[16];
+    unsigned long period_size;
+    memset(profile, 0, sizeof(*profile));
+    if (strncmp(line, "//", 2) == 0 ||
+        sscanf(line, "%63[^|]|%u|%u|%lu|%u|%15s", profile->device, &profile->rate, &profile->channels,
+               &period_size, &profile->periods, access) != 6 ||
+        (profile->access = pcm_output_parse_access(access)) < 0)
+        return -1;
+    profile->period_size = period_size;
+    return 0;
+}
+
+int pcm_profile_load(const char *file, const char *device, unsigned int rate, unsigned int channels,
+                     pcm_profile *profile)
+{
+    char line[256];
+    pcm_profile entry;
+    FILE *in = fopen(file, "r");
+    if (!in)
+        return -ENOENT;
+    while (fgets(line, sizeof(line), in))
+    {
+        if (parse_profile_line(line, &entry) == 0 && strcmp(entry.device, device) == 0 &&
+            entry.rate == rate && entry.channels == channels)
+        {
+            *profile = entry;
+            fclose(in);
+            return 0;
+        }
+    }
+    fclose(in);
+    return -ENOENT;
+}
+
+int pcm_profile_save(const char *file, const pcm_profile *profile)
+{
+    char line[256], tmp_file[512];
+    pcm_profile entry;
+    FILE *in, *out;
+
+    snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", file);
+    if (!(out = fopen(tmp_file, "w")))
+        return -errno;
+    if ((in = fopen(file, "r")))
+    {   /* keep every other line, comments included */
+        while (fgets(line, sizeof(line), in))
+            if (parse_profile_line(line, &entry) != 0 || strcmp(entry.device, profile->device) != 0 ||
+                entry.rate != profile->rate || entry.channels != profile->channels)
+                fputs(line, out);
+        fclose(in);
+    }
+    else
+        fprintf(out, "// ALSA profiles, tuned by alsa_tune, see pcm_output.h for the format\n");
+    fprintf(out, "%s|%u|%u|%lu|%u|%s\n", profile->device, profile->rate, profile->channels,
+            (unsigned long)profile->period_size, profile->periods, access_names[profile->access]);
+    if (fclose(out) != 0 || rename(tmp_file, file) != 0)
+        return -errno;
+    return 0;
+}
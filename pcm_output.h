@@ -0,0 +1,165 @@
+/*H**********************************************************************
+* FILENAME :        pcm_output.h
+*
+* DESCRIPTION :
+*       ALSA playback output shared by the players. Opens an interleaved S16_LE pcm with
+*       SND_PCM_ACCESS_MMAP_INTERLEAVED so the caller renders or reads straight into the hardware buffer, and
+*       falls back to SND_PCM_ACCESS_RW_INTERLEAVED (snd_pcm_writei from a one period staging buffer) where the
+*       device or plugin has no mmap. The caller sees the same begin/commit interface in both modes.
+*       Also the setup side: probe the period/buffer ranges of a device, autotune the lowest latency
+*       configuration that plays without xruns under a synthetic load, keep it per device in a profile file,
+*       and count xruns and their recovery time while playing. Optionally records the wake-up latency and the
+*       duration of every write in histograms (rt_profile.h).
+*
+* PUBLIC FUNCTIONS :
+*   int pcm_output_open(pcm_output *out, const char *device, unsigned int rate, unsigned int channels,
+*                       snd_pcm_uframes_t period_size, unsigned int periods, int access)
+*   int pcm_output_begin(pcm_output *out, int16_t **frames, snd_pcm_uframes_t *num_frames)
+*   int pcm_output_commit(pcm_output *out, snd_pcm_uframes_t num_frames)
+*   snd_pcm_sframes_t pcm_output_write(pcm_output *out, const int16_t *frames, snd_pcm_uframes_t num_frames)
+*   void pcm_output_close(pcm_output *out, int drain)
+*   const char *pcm_output_access_name(const pcm_output *out)
+*   int pcm_output_parse_access(const char *name)
+*   void pcm_output_report(const pcm_output *out, FILE *stream)
+*   int pcm_output_poll_descriptors(pcm_output *out, struct pollfd *pfds, int space)
+*   int pcm_output_poll_ready(pcm_output *out, struct pollfd *pfds, int count)
+*   int pcm_output_probe(const char *device, unsigned int rate, unsigned int channels, pcm_caps *caps)
+*   int pcm_output_autotune(const char *device, unsigned int rate, unsigned int channels, double load,
+*                           unsigned int test_ms, pcm_profile *profile, FILE *log)
+*   int pcm_profile_load(const char *file, const char *device, unsigned int rate, unsigned int channels,
+*                        pcm_profile *profile)
+*   int pcm_profile_save(const char *file, const pcm_profile *profile)
+*
+How to use:
+    pcm_output out;
+    pcm_output_open(&out, "hw:0,0", 48000, 2, 1024, 4, PCM_ACCESS_AUTO);   // mmap if possible, else rw
+    for (;;) {
+        int16_t *frames;  snd_pcm_uframes_t n = out.period_size;            // in: wanted, out: granted
+        pcm_output_begin(&out, &frames, &n);                                // hardware buffer (mmap) or staging (rw)
+        render(frames, n);                                                  // n interleaved frames
+        pcm_output_commit(&out, n);
+    }
+    pcm_output_close(&out, 1);                                              // 1 = drain, 0 = drop
+
+    pcm_profile profile;                                                    // tuned with ./alsa_tune
+    if (pcm_profile_load(PCM_PROFILE_FILE, "hw:0,0", 48000, 2, &profile) == 0)
+        pcm_output_open(&out, "hw:0,0", 48000, 2, profile.period_size, profile.periods, profile.access);
+
+Profile file (PCM_PROFILE_FILE, written by pcm_profile_save, one line per device, rate and channels):
+    // comment lines
+    <device>|<rate>|<channels>|<period_size>|<periods>|<auto|mmap|rw>
+    e.g.  hw:0,0|48000|2|256|3|mmap
+
+Note:
+    -- rate, period_size and periods are "near" values, the ones the device accepted are in out.rate,
+       out.period_size and out.buffer_size after pcm_output_open
+    -- begin waits until at least min(wanted, period_size) frames are free, at most PCM_OUTPUT_WAIT_MS. On a
+       timeout it returns 0 with *num_frames = 0 so the caller can check its stop flag
+    -- xruns are recovered inside begin/commit (snd_pcm_recover) and counted in out.xruns. The recovery time is
+       from the failing call until the stream runs again (prepared, buffer refilled, started)
+    -- autotune tries period sizes (powers of 2 from the device minimum up to 100 ms) times 2..4 periods in order of
+       buffer latency. Each candidate plays silence for test_ms while the writer burns load * period time of cpu per
+       period (the synthesis cost). The first candidate without xruns wins, if none is clean the one with the
+       fewest xruns. Repeat with a longer test_ms or with other load on the machine for more confidence
+    -- the stream is started explicitly once the hardware buffer is full (mmap commits do not start it)
+    -- begin/commit/write return 0 (write: frames written) or a negative ALSA error (snd_strerror)
+    -- histograms, off while the pointers are NULL (set them after pcm_output_open):
+       wakeup_hist: how late the writer runs after the device woke it, measured in frames past avail_min
+       (one period) when the wait returns, so it is hardware time, not the clock of the writer. In rw mode the
+       writer then waits in snd_pcm_wait before snd_pcm_writei so the wake-up can be seen at all
+       write_hist: duration of snd_pcm_writei (rw) or snd_pcm_mmap_commit (mmap)
+    -- own event loop: pcm_output_poll_descriptors puts the ALSA descriptors (snd_pcm_poll_descriptors) into the
+       caller's pollfd array next to its other descriptors. After poll(), pcm_output_poll_ready says whether a
+       period can be written (snd_pcm_poll_descriptors_revents, also on an error so begin/commit recover it), then
+       begin finds the space free and does not wait. Not running (prepared, xrun) counts as ready, poll with
+       timeout 0 then. A ready wake-up goes into wakeup_hist like the wait inside begin
+
+How to build: add pcm_output.c to the compile line, e.g. gcc -O2 player.c pcm_output.c -o player -lasound
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef PCM_OUTPUT_H
+#define PCM_OUTPUT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <alsa/asoundlib.h>
+#include "rt_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* access modes */
+#define PCM_ACCESS_AUTO 0       /* mmap, rw if the device has no mmap */
+#define PCM_ACCESS_MMAP 1       /* mmap only, open fails without it */
+#define PCM_ACCESS_RW 2         /* snd_pcm_writei */
+
+#define PCM_OUTPUT_WAIT_MS 100  /* longest wait for free space in pcm_output_begin */
+#define PCM_PROFILE_FILE "alsa.profile"     /* default profile file, machine specific, not in the repository */
+#define PCM_PROFILE_DEVICE_LEN 64
+
+typedef struct pcm_output{
+    snd_pcm_t *pcm;
+    int mmap;                           /* 1 = MMAP_INTERLEAVED, 0 = RW_INTERLEAVED */
+    unsigned int rate;
+    unsigned int channels;
+    snd_pcm_uframes_t period_size;
+    snd_pcm_uframes_t buffer_size;
+    /* telemetry */
+    unsigned long xruns;
+    uint64_t recovery_ns_total;         /* summed over all xruns */
+    uint64_t recovery_ns_max;
+    uint64_t xrun_start_ns;             /* != 0 while recovering */
+    rt_histogram *wakeup_hist;          /* NULL = not recorded */
+    rt_histogram *write_hist;
+    /* open region of begin */
+    snd_pcm_uframes_t mmap_offset;
+    int16_t *staging;                   /* rw: one period */
+} pcm_output;
+
+/* what a device supports for S16_LE, the given channels and the nearest rate */
+typedef struct pcm_caps{
+    unsigned int rate;
+    snd_pcm_uframes_t period_min, period_max;
+    snd_pcm_uframes_t buffer_min, buffer_max;
+    int mmap;                           /* MMAP_INTERLEAVED supported */
+} pcm_caps;
+
+/* tuned configuration of one device */
+typedef struct pcm_profile{
+    char device[PCM_PROFILE_DEVICE_LEN];
+    unsigned int rate;
+    unsigned int channels;
+    snd_pcm_uframes_t period_size;
+    unsigned int periods;
+    int access;                         /* PCM_ACCESS_* */
+} pcm_profile;
+
+int pcm_output_open(pcm_output *out, const char *device, unsigned int rate, unsigned int channels,
+                    snd_pcm_uframes_t period_size, unsigned int periods, int access);
+int pcm_output_begin(pcm_output *out, int16_t **frames, snd_pcm_uframes_t *num_frames);
+int pcm_output_commit(pcm_output *out, snd_pcm_uframes_t num_frames);
+snd_pcm_sframes_t pcm_output_write(pcm_output *out, const int16_t *frames, snd_pcm_uframes_t num_frames);
+void pcm_output_close(pcm_output *out, int drain);
+const char *pcm_output_access_name(const pcm_output *out);
+int pcm_output_parse_access(const char *name);     /* "auto", "mmap", "rw", -1 otherwise */
+void pcm_output_report(const pcm_output *out, FILE *stream);
+int pcm_output_poll_descriptors(pcm_output *out, struct pollfd *pfds, int space);     /* count or negative error */
+int pcm_output_poll_ready(pcm_output *out, struct pollfd *pfds, int count);           /* 1 ready, 0 not, negative error */
+
+int pcm_output_probe(const char *device, unsigned int rate, unsigned int channels, pcm_caps *caps);
+int pcm_output_autotune(const char *device, unsigned int rate, unsigned int channels, double load,
+                        unsigned int test_ms, pcm_profile *profile, FILE *log);
+/* 0 and *profile filled if the file has a line for device/rate/channels, -ENOENT otherwise */
+int pcm_profile_load(const char *file, const char *device, unsigned int rate, unsigned int channels,
+                     pcm_profile *profile);
+/* replaces the line of the same device/rate/channels, keeps the others */
+int pcm_profile_save(const char *file, const pcm_profile *profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,146 @@
+/*H**********************************************************************
+* FILENAME :        rt_profile.c
+*
+* DESCRIPTION :
+*       Real time mode of the players, see rt_profile.h. C, compiles as C++ too.
+*
+How to build:
+    gcc -O2 -c rt_profile.c -o rt_profile.o         (or list rt_profile.c in the player compile line)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /* pthread_setaffinity_np, CPU_SET */
+#endif
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "rt_profile.h"
+
+#define ISOLATED_CPUS_FILE "/sys/devices/system/cpu/isolated"
+
+int rt_lock_memory(FILE *log)
+{
+    /* freed memory stays in the process, a later malloc does not fault in new pages */
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#ifdef MCL_ONFAULT
+    /* lock pages as they are touched (hence the prefaulting), a mapped file is not read in as a whole */
+    if (mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) != 0)
+#else
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+#endif
+    {
+        int err = errno;
+        if (log)
+            fprintf(log, "Note: no mlockall (%s), pages can still be swapped out\n", strerror(err));
+        return -err;
+    }
+    return 0;
+}
+
+void rt_prefault(void *buffer, size_t size)
+{
+    volatile char *bytes = (volatile char *)buffer;
+    size_t i, page = (size_t)sysconf(_SC_PAGESIZE);
+
+    /* read and write back: the contents stay, every page is mapped and dirty */
+    for (i = 0; i < size; i += page)
+        bytes[i] = bytes[i];
+    if (size)
+        bytes[size - 1] = bytes[size - 1];
+}
+
+void rt_prefault_stack(void)
+{
+    volatile char stack[RT_STACK_PREFAULT];
+    size_t i, page = (size_t)sysconf(_SC_PAGESIZE);
+    for (i = 0; i < sizeof(stack); i += page)
+        stack[i] = 0;
+}
+
+int rt_default_cpu(void)
+{
+    char line[256];
+    FILE *file = fopen(ISOLATED_CPUS_FILE, "r");
+    int cpu = -1;
+
+    if (!file)
+        return -1;
+    /* "2-3", "1,3" or empty: the first cpu listed */
+    if (fgets(line, sizeof(line), file) && line[0] >= '0' && line[0] <= '9')
+        cpu = atoi(line);
+    fclose(file);
+    return cpu;
+}
+
+int rt_enter_thread(int priority, int cpu, FILE *log)
+{
+    int err, result = 0;
+    struct sched_param param;
+    cpu_set_t cpus;
+
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    if ((err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) == 0)
+        result |= RT_SCHED_FIFO;
+    else if (log)
+        fprintf(log, "Note: no SCHED_FIFO for the output thread (%s), running with normal priority\n", strerror(err));
+
+    if (cpu < 0)
+        return result;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if ((err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) == 0)
+        result |= RT_PINNED;
+    else if (log)
+        fprintf(log, "Note: output thread not pinned to cpu %d (%s)\n", cpu, strerror(err));
+    return result;
+}
+
+/* upper edge of a bin in microseconds */
+static uint64_t bin_limit_us(int bin)
+{
+    return bin == 0 ? 1 : (uint64_t)1 << bin;
+}
+
+void rt_histogram_print(const rt_histogram *hist, const char *name, FILE *stream)
+{
+    int i;
+    uint64_t seen = 0, p99 = 0;
+
+    if (hist->count == 0)
+    {
+        fprintf(stream, "%s: no samples\n", name);
+        return;
+    }
+    for (i = 0; i < RT_HISTOGRAM_BINS; i++)
+    {
+        seen += hist->bins[i];
+        if (seen * 100 >= hist->count * 99)
+        {
+            p99 = bin_limit_us(i);
+            break;
+        }
+    }
+    fprintf(stream, "%s: %llu samples, avg %.1f us, p99 < %llu us, max %.1f us\n", name,
+            (unsigned long long)hist->count, hist->total_ns / 1e3 / hist->count, (unsigned long long)p99,
+            hist->max_ns / 1e3);
+    for (i = 0; i < RT_HISTOGRAM_BINS; i++)
+    {
+        if (hist->bins[i] == 0)
+            continue;
+        if (i == RT_HISTOGRAM_BINS - 1)
+            fprintf(stream, "    >= %8llu us: %llu\n", (unsigned long long)bin_limit_us(i - 1),
+                    (unsigned long long)hist->bins[i]);
+        else
+            fprintf(stream, "    < %9llu us: %llu\n", (unsigned long long)bin_limit_us(i),
+                    (unsigned long long)hist->bins[i]);
+    }
+}
@@ -0,0 +1,106 @@
+/*H**********************************************************************
+* FILENAME :        rt_profile.h
+*
+* DESCRIPTION :
+*       Opt-in real time mode of the players: lock the memory of the process (mlockall, no malloc trimming),
+*       prefault buffers and the stack of the audio thread, give the audio thread SCHED_FIFO and pin it to one
+*       (isolated) cpu. Every step that is not allowed is reported and skipped, the player keeps playing.
+*       Also the latency histograms the output records while playing (wake-up latency, write duration).
+*
+* PUBLIC FUNCTIONS :
+*   int rt_lock_memory(FILE *log)
+*   void rt_prefault(void *buffer, size_t size)
+*   void rt_prefault_stack(void)
+*   int rt_default_cpu(void)
+*   int rt_enter_thread(int priority, int cpu, FILE *log)
+*   void rt_histogram_add(rt_histogram *hist, uint64_t ns)
+*   void rt_histogram_print(const rt_histogram *hist, const char *name, FILE *stream)
+*
+How to use:
+    rt_lock_memory(stdout);                                 // once, before the buffers are allocated
+    rt_prefault(buffer, size);                              // every buffer the audio thread touches
+    ...in the audio thread:
+    rt_enter_thread(RT_DEFAULT_PRIORITY, rt_default_cpu(), stdout);
+    rt_prefault_stack();
+
+    rt_histogram wakeup = RT_HISTOGRAM_INIT;                // recorded by pcm_output when attached
+    out.wakeup_hist = &wakeup;
+    ...
+    rt_histogram_print(&wakeup, "wake-up", stdout);
+
+Note:
+    -- the rights: root, or for a user "@audio - rtprio 95" and "@audio - memlock unlimited" in
+       /etc/security/limits.conf. Without them every step prints a Note and the player runs as before
+    -- memory is locked with MCL_ONFAULT where the kernel has it (Linux 4.4): a page is locked once it is touched,
+       so the buffers of the audio path are prefaulted and a memory mapped WAV file is not read in at once.
+       wav_open unlocks its mapping again, the played pages of a long file stay reclaimable (wav_reader.h)
+    -- priority: threaded irq handlers run SCHED_FIFO 50, the one of the sound card wakes the audio thread. Above
+       it the audio thread could starve its own irq, so the default is 49 and still above every normal thread
+    -- isolated cpu: boot with isolcpus=3 (Raspberry Pi: append to /boot/cmdline.txt), rt_default_cpu picks the
+       first cpu of /sys/devices/system/cpu/isolated, -1 (no pinning) if none is isolated
+    -- histogram bins are powers of 2 in microseconds, bin 0 is below 1 us, the last bin takes everything above.
+       One writer thread, read after it is joined
+    -- rt_histogram_add is inline so pcm_output.c records without linking rt_profile.c
+
+How to build: add rt_profile.c to the compile line and -pthread
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef RT_PROFILE_H
+#define RT_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RT_DEFAULT_PRIORITY 49          /* SCHED_FIFO priority of the audio thread, below the kernel irq threads (50) */
+#define RT_STACK_PREFAULT (256 * 1024)  /* bytes of stack touched by rt_prefault_stack */
+#define RT_HISTOGRAM_BINS 24            /* up to 2^22 us = 4 s */
+
+typedef struct rt_histogram{
+    uint64_t bins[RT_HISTOGRAM_BINS];   /* bin i: [2^(i-1), 2^i) us, bin 0: < 1 us */
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} rt_histogram;
+
+#define RT_HISTOGRAM_INIT {{0}, 0, 0, 0}
+
+/* what rt_enter_thread got */
+#define RT_SCHED_FIFO 1
+#define RT_PINNED 2
+
+int rt_lock_memory(FILE *log);          /* 0 or -errno of mlockall */
+void rt_prefault(void *buffer, size_t size);
+void rt_prefault_stack(void);
+int rt_default_cpu(void);
+/* cpu < 0: no pinning. Returns RT_SCHED_FIFO | RT_PINNED for the steps that worked */
+int rt_enter_thread(int priority, int cpu, FILE *log);
+void rt_histogram_print(const rt_histogram *hist, const char *name, FILE *stream);
+
+static inline void rt_histogram_add(rt_histogram *hist, uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    int bin = 0;
+    while (us && bin < RT_HISTOGRAM_BINS - 1)
+    {
+        us >>= 1;
+        bin++;
+    }
+    hist->bins[bin]++;
+    hist->count++;
+    hist->total_ns += ns;
+    if (ns > hist->max_ns)
+        hist->max_ns = ns;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+/*H**********************************************************************
+* FILENAME :        shm_ring.c
+*
+* DESCRIPTION :
+*       Shared memory frame ring between a generator and a player process, see shm_ring.h.
+*       C, compiles as C++ too.
+*
+How to build:
+    gcc -O2 -c shm_ring.c -o shm_ring.o         (or list shm_ring.c in the compile line)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shm_ring.h"
+
+static int set_name(shm_ring *ring, const char *name)
+{
+    int length = snprintf(ring->name, sizeof(ring->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    if (length < 2 || length >= (int)sizeof(ring->name) || strchr(ring->name + 1, '/'))
+        return -EINVAL;
+    return 0;
+}
+
+static void set_view(shm_ring *ring, void *map, size_t map_size)
+{
+    ring->header = (shm_ring_header *)map;
+    ring->frames = (int16_t *)((char *)map + ring->header->data_offset);
+    ring->map_size = map_size;
+    ring->mask = ring->header->capacity - 1;
+    ring->channels = ring->header->channels;
+}
+
+int shm_ring_create(shm_ring *ring, const char *name, unsigned int rate, unsigned int channels, uint64_t min_frames)
+{
+    int fd, err;
+    void *map;
+    uint64_t capacity = 1;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), data_offset, map_size;
+    shm_ring_header *header;
+
+    memset(ring, 0, sizeof(*ring));
+    if (rate == 0 || channels == 0 || min_frames == 0)
+        return -EINVAL;
+    if (!__atomic_always_lock_free(sizeof(uint64_t), 0))
+        return -ENOTSUP;
+    if ((err = set_name(ring, name)) < 0)
+        return err;
+    while (capacity < min_frames)
+        capacity <<= 1;
+    data_offset = (sizeof(shm_ring_header) + page - 1) / page * page;
+    map_size = data_offset + (size_t)capacity * channels * sizeof(int16_t);
+
+    shm_unlink(ring->name);     /* stale ring of a producer that did not exit cleanly */
+    if ((fd = shm_open(ring->name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600)) < 0)
+        return -errno;
+    if (ftruncate(fd, (off_t)map_size) != 0 ||
+        (map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        err = -errno;
+        close(fd);
+        shm_unlink(ring->name);
+        return err;
+    }
+    close(fd);
+
+    /* fresh pages are zero, the magic goes in last so a consumer never sees half a header */
+    header = (shm_ring_header *)map;
+    header->version = SHM_RING_VERSION;
+    header->rate = rate;
+    header->channels = channels;
+    header->sample_bytes = sizeof(int16_t);
+    header->capacity = capacity;
+    header->data_offset = data_offset;
+    header->producer_pid = (int32_t)getpid();
+    __atomic_store_n(&header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    set_view(ring, map, map_size);
+    ring->creator = 1;
+    return 0;
+}
+
+int shm_ring_attach(shm_ring *ring, const char *name)
+{
+    int fd, err;
+    void *map;
+    struct stat st;
+    shm_ring_header *header;
+
+    memset(ring, 0, sizeof(*ring));
+    if ((err = set_name(ring, name)) < 0)
+        return err;
+    if ((fd = shm_open(ring->name, O_RDWR | O_CLOEXEC, 0)) < 0)
+        return -errno;
+    if (fstat(fd, &st) != 0)
+    {
+        err = -errno;
+        close(fd);
+        return err;
+    }
+    if ((size_t)st.st_size < sizeof(shm_ring_header))
+    {
+        close(fd);
+        return -EPROTO;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    err = -errno;
+    close(fd);
+    if (map == MAP_FAILED)
+        return err;
+
+    header = (shm_ring_header *)map;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC || header->version != SHM_RING_VERSION ||
+        header->sample_bytes != sizeof(int16_t) || header->channels == 0 || header->capacity == 0 ||
+        (header->capacity & (header->capacity - 1)) != 0 ||
+        header->data_offset + header->capacity * header->channels * sizeof(int16_t) > (uint64_t)st.st_size)
+    {
+        munmap(map, (size_t)st.st_size);
+        return -EPROTO;
+    }
+    set_view(ring, map, (size_t)st.st_size);
+    header->consumer_pid = (int32_t)getpid();
+    shm_ring_set_flags(ring, SHM_RING_CONSUMER);
+    return 0;
+}
+
+void shm_ring_close(shm_ring *ring)
+{
+    if (!ring->header)
+        return;
+    munmap(ring->header, ring->map_size);
+    if (ring->creator)
+        shm_unlink(ring->name);     /* an attached consumer keeps its mapping */
+    ring->header = NULL;
+    ring->frames = NULL;
+}
+
+static uint64_t split(const shm_ring *ring, uint64_t counter, uint64_t frames, shm_regions *regions)
+{
+    uint64_t index = counter & ring->mask;
+    uint64_t to_end = ring->header->capacity - index;
+    regions->first = ring->frames + index * ring->channels;
+    regions->first_frames = frames < to_end ? frames : to_end;
+    regions->second = ring->frames;
+    regions->second_frames = frames - regions->first_frames;
+    return frames;
+}
+
+uint64_t shm_ring_write_regions(shm_ring *ring, shm_regions *regions)
+{
+    uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_RELAXED);     /* only the producer stores head */
+    uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+    return split(ring, head, ring->header->capacity - (head - tail), regions);
+}
+
+void shm_ring_commit_write(shm_ring *ring, uint64_t frames)
+{
+    uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->header->head, head + frames, __ATOMIC_RELEASE);
+}
+
+uint64_t shm_ring_read_regions(shm_ring *ring, shm_regions *regions)
+{
+    uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_RELAXED);     /* only the consumer stores tail */
+    uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+    return split(ring, tail, head - tail, regions);
+}
+
+void shm_ring_commit_read(shm_ring *ring, uint64_t frames)
+{
+    uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->header->tail, tail + frames, __ATOMIC_RELEASE);
+}
+
+uint64_t shm_ring_read_available(const shm_ring *ring)
+{
+    return __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+}
+
+void shm_ring_set_flags(shm_ring *ring, uint32_t flags)
+{
+    __atomic_fetch_or(&ring->header->flags, flags, __ATOMIC_RELEASE);
+}
+
+uint32_t shm_ring_flags(const shm_ring *ring)
+{
+    return __atomic_load_n(&ring->header->flags, __ATOMIC_ACQUIRE);
+}
+
+int shm_ring_producer_alive(const shm_ring *ring)
+{
+    if (shm_ring_flags(ring) & SHM_RING_DONE)
+        return 0;
+    return !(kill((pid_t)ring->header->producer_pid, 0) != 0 && errno == ESRCH);
+}
+
+void shm_ring_count_underrun(shm_ring *ring)
+{
+    __atomic_fetch_add(&ring->header->underruns, 1, __ATOMIC_RELAXED);
+}
+
+uint64_t shm_ring_underruns(const shm_ring *ring)
+{
+    return __atomic_load_n(&ring->header->underruns, __ATOMIC_RELAXED);
+}
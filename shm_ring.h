@@ -0,0 +1,133 @@
+/*H**********************************************************************
+* FILENAME :        shm_ring.h
+*
+* DESCRIPTION :
+*       Lock-free single producer / single consumer ring of interleaved S16_LE frames in POSIX shared memory,
+*       so generation and playback can run in separate processes without a pipe or a file between them. The
+*       producer renders straight into the shared pages (write regions), the consumer copies from them straight
+*       into the ALSA buffer (read regions): no copy into or out of the kernel, no intermediate buffer.
+*       The header in front of the frames carries the format, the producer/consumer counters and the status flags.
+*
+* PUBLIC FUNCTIONS :
+*   int shm_ring_create(shm_ring *ring, const char *name, unsigned int rate, unsigned int channels, uint64_t min_frames)
+*   int shm_ring_attach(shm_ring *ring, const char *name)
+*   void shm_ring_close(shm_ring *ring)
+*   uint64_t shm_ring_write_regions(shm_ring *ring, shm_regions *regions)
+*   void shm_ring_commit_write(shm_ring *ring, uint64_t frames)
+*   uint64_t shm_ring_read_regions(shm_ring *ring, shm_regions *regions)
+*   void shm_ring_commit_read(shm_ring *ring, uint64_t frames)
+*   uint64_t shm_ring_read_available(const shm_ring *ring)
+*   void shm_ring_set_flags(shm_ring *ring, uint32_t flags)
+*   uint32_t shm_ring_flags(const shm_ring *ring)
+*   int shm_ring_producer_alive(const shm_ring *ring)
+*   void shm_ring_count_underrun(shm_ring *ring)
+*   uint64_t shm_ring_underruns(const shm_ring *ring)
+*
+How to use:
+    producer (generator process):                           consumer (player process):
+    shm_ring ring;                                          shm_ring ring;
+    shm_ring_create(&ring, "laser", 48000, 2, 9600);        shm_ring_attach(&ring, "laser");    // rate, channels from the header
+    for (;;) {                                              for (;;) {
+        shm_regions r;                                          shm_regions r;
+        shm_ring_write_regions(&ring, &r);                      shm_ring_read_regions(&ring, &r);
+        render(r.first, r.first_frames);                        memcpy(alsa_buffer, r.first, ...);
+        render(r.second, r.second_frames);                      ...
+        shm_ring_commit_write(&ring, frames);                   shm_ring_commit_read(&ring, frames);
+    }                                                       }
+    shm_ring_set_flags(&ring, SHM_RING_DONE);               shm_ring_close(&ring);
+    shm_ring_close(&ring);                                  // the name is removed by the creator
+
+Note:
+    -- head (frames written, only the producer stores it) and tail (frames read, only the consumer) are free running
+       64 bit counters on their own cache lines, index = counter & mask. Release store of head after the frames,
+       acquire load on the other side, the same for tail and free space (as spsc_ring.hpp, across processes).
+       The 64 bit atomics must be lock free (x86-64, aarch64, armv7 with ldrexd/strexd: Raspberry Pi 2 and newer)
+    -- the frames start on a page boundary after the header, capacity is a power of 2 frames
+    -- the name is a POSIX shm name (/dev/shm/<name>), a leading / is added. create replaces a stale ring of the
+       same name (a crashed producer), a consumer still attached to the old one sees it as ended
+    -- no blocking wait in the ring: a full producer and an empty consumer sleep and look again (the consumer is
+       paced by the ALSA device anyway). The consumer counts every stretch of empty ring while the producer runs in
+       the header (shm_ring_count_underrun), so the producer can report it
+    -- attach fails with -ENOENT before the producer created the ring, with -EPROTO for a ring of another layout
+    -- every int returning function gives 0 or -errno
+
+How to build: add shm_ring.c to the compile line (and -lrt on glibc older than 2.17)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHM_RING_MAGIC 0x4C535231u      /* "LSR1" */
+#define SHM_RING_VERSION 1
+#define SHM_RING_NAME_MAX 64
+#define SHM_RING_CACHE_LINE 64
+
+/* status flags */
+#define SHM_RING_DONE 1                 /* producer finished, nothing comes after the frames in the ring */
+#define SHM_RING_CONSUMER 2             /* a consumer attached */
+
+/* the shared header, the frames follow at data_offset */
+typedef struct shm_ring_header{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rate;
+    uint32_t channels;
+    uint32_t sample_bytes;              /* 2, S16_LE */
+    uint32_t flags;                     /* SHM_RING_*, atomic */
+    uint64_t capacity;                  /* frames, power of 2 */
+    uint64_t data_offset;               /* bytes from the header, page aligned */
+    int32_t producer_pid;
+    int32_t consumer_pid;
+    uint64_t underruns;                 /* counted by the consumer, atomic */
+    uint64_t head __attribute__((aligned(SHM_RING_CACHE_LINE)));   /* frames written */
+    uint64_t tail __attribute__((aligned(SHM_RING_CACHE_LINE)));   /* frames read */
+} shm_ring_header;
+
+/* process local view of a ring */
+typedef struct shm_ring{
+    shm_ring_header *header;
+    int16_t *frames;                    /* first frame in this process */
+    size_t map_size;
+    uint64_t mask;
+    unsigned int channels;
+    int creator;
+    char name[SHM_RING_NAME_MAX];
+} shm_ring;
+
+/* up to two contiguous parts of the ring, first then second */
+typedef struct shm_regions{
+    int16_t *first;
+    uint64_t first_frames;
+    int16_t *second;
+    uint64_t second_frames;
+} shm_regions;
+
+int shm_ring_create(shm_ring *ring, const char *name, unsigned int rate, unsigned int channels, uint64_t min_frames);
+int shm_ring_attach(shm_ring *ring, const char *name);
+void shm_ring_close(shm_ring *ring);
+uint64_t shm_ring_write_regions(shm_ring *ring, shm_regions *regions);    /* free frames */
+void shm_ring_commit_write(shm_ring *ring, uint64_t frames);
+uint64_t shm_ring_read_regions(shm_ring *ring, shm_regions *regions);     /* filled frames */
+void shm_ring_commit_read(shm_ring *ring, uint64_t frames);
+uint64_t shm_ring_read_available(const shm_ring *ring);
+void shm_ring_set_flags(shm_ring *ring, uint32_t flags);                 /* ORed into the flags */
+uint32_t shm_ring_flags(const shm_ring *ring);
+int shm_ring_producer_alive(const shm_ring *ring);                        /* 0 after SHM_RING_DONE or when it died */
+void shm_ring_count_underrun(shm_ring *ring);
+uint64_t shm_ring_underruns(const shm_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
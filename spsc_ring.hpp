@@ -0,0 +1,124 @@
+/*H**********************************************************************
+* FILENAME :        spsc_ring.hpp
+*
+* DESCRIPTION :
+*       Lock-free single producer / single consumer ring buffer. One thread writes (synthesis), one thread
+*       reads (ALSA output), no locks and no allocation after construction, so the reading thread never
+*       blocks on the writing one.
+*
+* PUBLIC FUNCTIONS :
+*   spsc_ring<T>(std::size_t min_capacity)                  capacity is rounded up to a power of 2
+*   std::size_t write(const T* data, std::size_t count)     copy in, returns the number of elements written
+*   std::size_t read(T* data, std::size_t count)            copy out, returns the number of elements read
+*   std::size_t write_regions(ring_regions<T> &regions)     free space as max two contiguous regions (zero copy)
+*   void commit_write(std::size_t count)                    publish count elements of the write regions
+*   std::size_t read_regions(ring_regions<T> &regions)      filled space as max two contiguous regions
+*   void commit_read(std::size_t count)                     release count elements of the read regions
+*   std::size_t read_available() / write_available() / capacity()
+*
+Note:
+    -- head (written by the producer) and tail (written by the consumer) are free running counters on their own
+       cache lines, index = counter & mask. The producer publishes data with a release store of head, the consumer
+       sees it with an acquire load, the same the other way round for free space
+    -- write/commit_write must only be called by the producer thread, read/commit_read only by the consumer thread
+    -- T must be trivially copyable (frames of samples)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+const std::size_t RING_CACHE_LINE = 64;
+
+// up to two contiguous parts of the ring, first then second
+template <typename T>
+struct ring_regions{
+    T* first;
+    std::size_t first_count;
+    T* second;
+    std::size_t second_count;
+};
+
+template <typename T>
+class spsc_ring{
+    static_assert(std::is_trivially_copyable<T>::value, "spsc_ring elements are copied with memcpy");
+    public:
+        explicit spsc_ring(std::size_t min_capacity){
+            std::size_t size = 1;
+            while (size < min_capacity)
+                size <<= 1;
+            buffer.resize(size);
+            mask = size - 1;
+        }
+
+        std::size_t capacity() const { return mask + 1; }
+        std::size_t read_available() const {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+        std::size_t write_available() const { return capacity() - read_available(); }
+
+        std::size_t write_regions(ring_regions<T> &regions){
+            std::size_t h = head.load(std::memory_order_relaxed);      // only the producer changes head
+            std::size_t free = capacity() - (h - tail.load(std::memory_order_acquire));
+            return split(h, free, regions);
+        }
+        void commit_write(std::size_t count){
+            head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        std::size_t read_regions(ring_regions<T> &regions){
+            std::size_t t = tail.load(std::memory_order_relaxed);      // only the consumer changes tail
+            std::size_t filled = head.load(std::memory_order_acquire) - t;
+            return split(t, filled, regions);
+        }
+        void commit_read(std::size_t count){
+            tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        std::size_t write(const T* data, std::size_t count){
+            ring_regions<T> regions;
+            count = std::min(count, write_regions(regions));
+            copy_in(regions, data, count);
+            commit_write(count);
+            return count;
+        }
+        std::size_t read(T* data, std::size_t count){
+            ring_regions<T> regions;
+            count = std::min(count, read_regions(regions));
+            std::size_t first = std::min(count, regions.first_count);
+            std::memcpy(data, regions.first, first * sizeof(T));
+            std::memcpy(data + first, regions.second, (count - first) * sizeof(T));
+            commit_read(count);
+            return count;
+        }
+
+    private:
+        std::size_t split(std::size_t counter, std::size_t count, ring_regions<T> &regions){
+            std::size_t index = counter & mask;
+            regions.first = buffer.data() + index;
+            regions.first_count = std::min(count, capacity() - index);
+            regions.second = buffer.data();
+            regions.second_count = count - regions.first_count;
+            return count;
+        }
+        void copy_in(ring_regions<T> &regions, const T* data, std::size_t count){
+            std::size_t first = std::min(count, regions.first_count);
+            std::memcpy(regions.first, data, first * sizeof(T));
+            std::memcpy(regions.second, data + first, (count - first) * sizeof(T));
+        }
+
+        std::vector<T> buffer;
+        std::size_t mask;
+        alignas(RING_CACHE_LINE) std::atomic<std::size_t> head{0};     // written by the producer
+        alignas(RING_CACHE_LINE) std::atomic<std::size_t> tail{0};     // written by the consumer
+};
+
+#endif
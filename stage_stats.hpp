@@ -0,0 +1,129 @@
+/*H**********************************************************************
+* FILENAME :        stage_stats.hpp
+*
+* DESCRIPTION :
+*       Per-stage instrumentation: wall time of each pipeline stage (monotonic clock), peak resident memory
+*       after each stage and named counters (bytes written, lut bytes, samples/sec ...), written as json
+*
+* PUBLIC FUNCTIONS :
+*   void stage_stats::enable()
+*   void stage_stats::counter(std::string name, double value)
+*   void stage_stats::write_json(std::ostream & out, std::string program)
+*   stage_timer(stage_stats & stats, const char* stage)      times the enclosing scope as one stage
+*   long stage_stats::peak_rss_kb()
+*
+Note:
+    -- nothing is measured until enable() is called, a disabled stage_timer costs one branch
+    -- compiled with -DLASER_NO_STATS every member is an empty inline function, the instrumentation is removed
+       completely by the compiler and write_json only reports that stats are not compiled in
+    -- peak_rss_kb is getrusage ru_maxrss (kilobytes on Linux), i.e. the high water mark of the process up to the
+       end of the stage, not the memory used by the stage alone
+
+Json output:
+    {"program": "svg_to_wav", "total_ns": 183000000, "peak_rss_kb": 14212,
+     "stages": [{"stage": "load_image_params", "ns": 5230000, "peak_rss_kb": 4100}, ...],
+     "counters": {"points": 3411, "lut_bytes": 2880000, ...}}
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef STAGE_STATS_HPP
+#define STAGE_STATS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef LASER_NO_STATS
+
+#include <chrono>
+#include <iomanip>
+#include <sys/resource.h>
+
+class stage_stats{
+    public:
+        void enable(){ enabled = true; start = std::chrono::steady_clock::now(); }
+        bool is_enabled() const { return enabled; }
+        void add_stage(const char* stage, std::int64_t ns){
+            stages.push_back({stage, ns, peak_rss_kb()});
+        }
+        void counter(std::string name, double value){
+            if (enabled)
+                counters.push_back(std::make_pair(name, value));
+        }
+        // sum of all spans of a stage in ns, 0 if it did not run
+        std::int64_t stage_ns(std::string stage) const {
+            std::int64_t ns = 0;
+            for (const span &s: stages)
+                if (stage.compare(s.stage) == 0)
+                    ns += s.ns;
+            return ns;
+        }
+        static long peak_rss_kb(){
+            struct rusage usage;
+            return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+        }
+        void write_json(std::ostream & out, std::string program) const {
+            std::int64_t total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            out << "{\"program\": \"" << program << "\", \"total_ns\": " << total_ns << ", \"peak_rss_kb\": " << peak_rss_kb()
+                << ",\n \"stages\": [";
+            for (std::size_t i = 0; i < stages.size(); i++)
+                out << (i ? ",\n  " : "\n  ") << "{\"stage\": \"" << stages[i].stage << "\", \"ns\": " << stages[i].ns
+                    << ", \"peak_rss_kb\": " << stages[i].peak_rss_kb << "}";
+            out << "],\n \"counters\": {";
+            for (std::size_t i = 0; i < counters.size(); i++)
+                out << (i ? ", " : "") << "\"" << counters[i].first << "\": " << std::setprecision(15) << counters[i].second;
+            out << "}}" << std::endl;
+        }
+    private:
+        struct span{
+            const char* stage;
+            std::int64_t ns;
+            long peak_rss_kb;
+        };
+        bool enabled = false;
+        std::chrono::steady_clock::time_point start;
+        std::vector<span> stages;
+        std::vector<std::pair<std::string, double>> counters;
+};
+
+class stage_timer{
+    public:
+        stage_timer(stage_stats & stats, const char* stage) : stats(stats), stage(stage){
+            if (stats.is_enabled())
+                start = std::chrono::steady_clock::now();
+        }
+        ~stage_timer(){
+            if (stats.is_enabled())
+                stats.add_stage(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+    private:
+        stage_stats & stats;
+        const char* stage;
+        std::chrono::steady_clock::time_point start;
+};
+
+#else   // LASER_NO_STATS, same interface without any code
+
+class stage_stats{
+    public:
+        void enable(){}
+        bool is_enabled() const { return false; }
+        void add_stage(const char*, std::int64_t){}
+        void counter(std::string, double){}
+        std::int64_t stage_ns(std::string) const { return 0; }
+        static long peak_rss_kb(){ return 0; }
+        void write_json(std::ostream & out, std::string program) const {
+            out << "{\"program\": \"" << program << "\", \"error\": \"stats not compiled in (LASER_NO_STATS)\"}" << std::endl;
+        }
+};
+
+class stage_timer{
+    public:
+        stage_timer(stage_stats &, const char*){}
+};
+
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+/*H**********************************************************************
+* FILENAME :        stroke_order.hpp
+*
+* DESCRIPTION :
+*       Reorders and reverses the strokes of a point list so that the galvo spends less of each cycle
+*       jumping between disjoint strokes (fonts and complex svg files from PathToPoints come out as many
+*       strokes in document order)
+*
+* PUBLIC FUNCTIONS :
+*   stroke_report optimize_stroke_order(std::vector<PointT> &points, double break_factor)
+*
+Note:
+    A stroke break is a jump between two consecutive points that is longer than break_factor times the median
+    distance of consecutive points. PathToPoints samples a path with a fixed step, so real jumps stand out clearly.
+
+    The order is solved as an open path over the strokes, each stroke may be drawn in either direction:
+    -- greedy nearest neighbour starting from the first stroke of the file, nearest unvisited stroke endpoint
+       is found with a k-d tree over all stroke endpoints (kd_tree.hpp)
+    -- 2-opt over the stroke sequence using the STROKE_NEIGHBOURS nearest endpoints as candidate moves. Reversing
+       a run of strokes also flips the direction of each stroke in the run. Runs longer than STROKE_MAX_SPAN
+       are not reversed, so a pass stays linear in the strokes, the k-d tree searches add a log factor.
+       laser_bench optimize_stroke_short measures it on dashes of 2 to 4 points: about 0.4 s for 33k strokes and
+       8 s for 333k on one desktop core, up to STROKE_MAX_PASSES passes and cache misses make up the difference
+    The first stroke of the file stays first and keeps its direction.
+
+    Travel is the summed length of all jumps between strokes, measured in the unit of the point coordinates.
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef STROKE_ORDER_HPP
+#define STROKE_ORDER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "kd_tree.hpp"
+
+const int STROKE_NEIGHBOURS = 8;        // candidate endpoints per endpoint in 2-opt
+const int STROKE_MAX_SPAN = 50000;      // longest run of strokes 2-opt may reverse
+const int STROKE_MAX_PASSES = 16;       // 2-opt passes over the sequence
+
+struct stroke_report{
+    int strokes = 0;                    // number of strokes found
+    double travel_before = 0.0;         // jump length between strokes in input order
+    double travel_after = 0.0;          // jump length after reordering
+};
+
+// splits the point list into strokes, stroke s covers points [first[s], last[s]]
+template <typename PointT>
+void find_strokes(std::vector<PointT> &points, double break_factor, std::vector<int> &first, std::vector<int> &last)
+{
+    int n = (int)points.size();
+    first.clear();
+    last.clear();
+    if (n == 0)
+        return;
+
+    std::vector<double> steps(n - 1);
+    for (int i = 0; i < n - 1; i++)
+        steps[i] = std::hypot(points[i + 1].get_x() - points[i].get_x(), points[i + 1].get_y() - points[i].get_y());
+
+    double threshold = 0.0;
+    if (!steps.empty())
+    {
+        std::vector<double> sorted_steps(steps);
+        std::nth_element(sorted_steps.begin(), sorted_steps.begin() + sorted_steps.size() / 2, sorted_steps.end());
+        threshold = break_factor * sorted_steps[sorted_steps.size() / 2];
+    }
+
+    first.push_back(0);
+    for (int i = 0; i < n - 1; i++)
+    {
+        if (steps[i] > threshold && threshold > 0.0)
+        {
+            last.push_back(i);
+            first.push_back(i + 1);
+        }
+    }
+    last.push_back(n - 1);
+}
+
+template <typename PointT>
+stroke_report optimize_stroke_order(std::vector<PointT> &points, double break_factor = 4.0)
+{
+    stroke_report report;
+    std::vector<int> first, last;
+    find_strokes(points, break_factor, first, last);
+
+    int num_strokes = (int)first.size();
+    report.strokes = num_strokes;
+    if (num_strokes < 2)
+        return report;
+
+    // endpoint 2*s is the first point of stroke s, 2*s+1 its last point
+    std::vector<double> ex(2 * num_strokes), ey(2 * num_strokes);
+    for (int s = 0; s < num_strokes; s++)
+    {
+        ex[2 * s] = points[first[s]].get_x();
+        ey[2 * s] = points[first[s]].get_y();
+        ex[2 * s + 1] = points[last[s]].get_x();
+        ey[2 * s + 1] = points[last[s]].get_y();
+    }
+    auto dist = [&ex, &ey](int a, int b){ return std::hypot(ex[a] - ex[b], ey[a] - ey[b]); };
+
+    for (int s = 0; s + 1 < num_strokes; s++)
+        report.travel_before += dist(2 * s + 1, 2 * (s + 1));
+
+    // sequence of strokes, flip[p] == 1 means the stroke at position p is drawn last point -> first point
+    std::vector<int> seq, flip, pos_of(num_strokes);
+    seq.reserve(num_strokes);
+    flip.reserve(num_strokes);
+
+    // ------------- greedy nearest neighbour -------------
+    kd_tree tree(ex, ey);
+    seq.push_back(0);
+    flip.push_back(0);
+    tree.remove(0);
+    tree.remove(1);
+    int current = 1;    // endpoint the beam stands on
+    for (int step = 1; step < num_strokes; step++)
+    {
+        int q = tree.nearest(ex[current], ey[current]);
+        int s = q / 2;
+        seq.push_back(s);
+        flip.push_back(q & 1);      // entered at its last point -> draw reversed
+        tree.remove(2 * s);
+        tree.remove(2 * s + 1);
+        current = q ^ 1;            // leave at the other end
+    }
+    for (int p = 0; p < num_strokes; p++)
+        pos_of[seq[p]] = p;
+
+    // ------------- 2-opt with neighbour lists -------------
+    std::vector<int> neighbours(2 * num_strokes * STROKE_NEIGHBOURS, -1), found;
+    for (int e = 0; e < 2 * num_strokes; e++)
+    {
+        tree.k_nearest(ex[e], ey[e], STROKE_NEIGHBOURS + 1, found);  // +1, the endpoint finds itself
+        int k = 0;
+        for (int q: found)
+            if (q != e && k < STROKE_NEIGHBOURS)
+                neighbours[e * STROKE_NEIGHBOURS + k++] = q;
+    }
+
+    auto entry_of = [&seq, &flip](int p){ return 2 * seq[p] + flip[p]; };
+    auto exit_of = [&seq, &flip](int p){ return 2 * seq[p] + 1 - flip[p]; };
+    auto reverse_run = [&](int lo, int hi){    // reverse positions [lo, hi] and flip every stroke in it
+        std::reverse(seq.begin() + lo, seq.begin() + hi + 1);
+        std::reverse(flip.begin() + lo, flip.begin() + hi + 1);
+        for (int p = lo; p <= hi; p++)
+        {
+            flip[p] ^= 1;
+            pos_of[seq[p]] = p;
+        }
+    };
+
+    for (int pass = 0; pass < STROKE_MAX_PASSES; pass++)
+    {
+        bool improved = false;
+        for (int i = 0; i + 1 < num_strokes; i++)
+        {
+            // edge i is the jump exit_of(i) -> entry_of(i+1); try to replace it with a shorter one
+            bool moved = true;
+            while (moved)
+            {
+                moved = false;
+                int a = exit_of(i), b = entry_of(i + 1);
+                double d_ab = dist(a, b);
+
+                // new jump a -> exit_of(j), run [i+1, j] reversed
+                for (int k = 0; k < STROKE_NEIGHBOURS && !moved; k++)
+                {
+                    int q = neighbours[a * STROKE_NEIGHBOURS + k];
+                    if (q < 0 || dist(a, q) >= d_ab)
+                        break;
+                    int j = pos_of[q / 2];
+                    if (j <= i || q != exit_of(j) || j - i > STROKE_MAX_SPAN)
+                        continue;
+                    double gain = d_ab - dist(a, q);
+                    if (j + 1 < num_strokes)
+                        gain += dist(exit_of(j), entry_of(j + 1)) - dist(b, entry_of(j + 1));
+                    if (gain > 1e-9)
+                    {
+                        reverse_run(i + 1, j);
+                        moved = improved = true;
+                    }
+                }
+
+                // new jump b -> entry_of(j+1), run [i+1, j] reversed
+                for (int k = 0; k < STROKE_NEIGHBOURS && !moved; k++)
+                {
+                    int q = neighbours[b * STROKE_NEIGHBOURS + k];
+                    if (q < 0 || dist(b, q) >= d_ab)
+                        break;
+                    int j = pos_of[q / 2] - 1;
+                    if (j <= i || q != entry_of(j + 1) || j - i > STROKE_MAX_SPAN)
+                        continue;
+                    double gain = d_ab + dist(exit_of(j), q) - dist(a, exit_of(j)) - dist(b, q);
+                    if (gain > 1e-9)
+                    {
+                        reverse_run(i + 1, j);
+                        moved = improved = true;
+                    }
+                }
+            }
+        }
+        if (!improved)
+            break;
+    }
+
+    for (int p = 0; p + 1 < num_strokes; p++)
+        report.travel_after += dist(exit_of(p), entry_of(p + 1));
+
+    // rebuild the point list in the new order
+    std::vector<PointT> reordered;
+    reordered.reserve(points.size());
+    for (int p = 0; p < num_strokes; p++)
+    {
+        int s = seq[p];
+        if (flip[p])
+            for (int i = last[s]; i >= first[s]; i--)
+                reordered.push_back(points[i]);
+        else
+            for (int i = first[s]; i <= last[s]; i++)
+                reordered.push_back(points[i]);
+    }
+    points.swap(reordered);
+    return report;
+}
+
+#endif
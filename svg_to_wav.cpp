@@ -9,7 +9,15 @@
 *   void create_sample_buffer(int16_t x_buff[], int16_t y_buff[], 
                           int freq, int Fs, int num_samples, int wave_typ,
                         std::vector<Point> &scaled_points, int interpolation_factor)
+*   void create_lut(std::int16_t lut[], std::int16_t lut_x[], std::int16_t lut_y[], int wave_typ,
+                    std::vector<Point> &scaled_points, int interpolation_factor, float* phase_y)
+*   void synthesize_samples(int16_t x_buff[], int16_t y_buff[], float freq, int Fs, int num_samples, int wave_typ,
+                            std::int16_t lut[], std::int16_t lut_x[], std::int16_t lut_y[], float phase_y)
+*   int set_lut_size(int input_points_count)
+*   void write_wav_header(std::ostream & file_wav, int sampling_rate, int num_samples)
+*   void write_wav_samples(std::ostream & file_wav, int16_t x_buff[], int16_t y_buff[], int num_samples)
 *   bool load_image_params(std::string file, std::vector<Point> &points, int* canvas_height, int* canvas_width)
+*   int set_optional_args(int* argc, char* argv[], stage_options & options)
 
 * Some helpful links
     // wav format: http://soundfile.sapp.org/doc/WaveFormat/
@@ -32,6 +40,22 @@ How to call:
     2  ./svg_to_wav filename.txt<string> seconds<int> freq<float> signal_name("sine", "rectangle") <string> sampling_rate<int>
     3. all parameters in 2 are optional and sequential
     4. signal_name parameter should be passed only if rectangle or sine wave is wanted e.g. input text file will be overridden
+    5. optional stages are enabled with --options, they can be placed anywhere in the argument list:
+        --optimize-strokes          reorder/reverse disjoint strokes to minimize galvo travel between them (stroke_order.hpp)
+        --decimate-tol=<units>      drop points that lie within <units> (output sample units) of the trace (decimate.hpp)
+        --point-budget=<N|lut>      keep only the N most significant points, "lut" keeps lut_size/2 points so that
+                                    the lookup table (and the cycle) does not grow
+        --lut-size=<N>              lookup table size to start with (default 480000), it still grows when the points
+                                    do not fit. laser_fidelity --sweep prints the smallest one for an error limit
+        --corner-dwell[=<factor>]   give corners dwell samples taken from straight runs, cycle length unchanged,
+                                    a full reversal dwells as long as <factor> (default 4) average segments (trajectory.hpp)
+        --corner-angle=<degrees>    turning angle above which a point is a corner (default 30)
+        --galvo-filter=<file>       pre-emphasis filter on the synthesized x/y samples, inverse galvo model per axis
+                                    from a calibration file (see galvo.cal and galvo_filter.hpp)
+        --stats[=<file>]            time every stage, peak memory, bytes written, samples/sec and lut bytes as json,
+                                    printed at the end or written to <file> (stage_stats.hpp, removed completely
+                                    when compiled with -DLASER_NO_STATS). Printed, it is all that goes to stdout,
+                                    the progress lines go to stderr: ./svg_to_wav ... --stats | jq
 
 <filename>.txt (input text file) consists of the following (see /svg/svg_to_text.txt file for instructions):
 -- Create an new text file
@@ -57,6 +81,16 @@ REF NO  VERSION DATE    WHO     DETAIL
 * 06    19MAR2021       SK      Bug fix: g++ compiler compatibility
 * 07    24MAR2021       SK      Bug Fix: dynamic memory allocation issue
 * 08    29MAR2021       SK      Arguments and default parameters readjustment
+* 09    18OCT2026       AG      Optional stroke reordering stage (--optimize-strokes)
+* 10    18OCT2026       AG      Optional point decimation stage (--decimate-tol, --point-budget)
+* 11    18OCT2026       AG      Optional corner dwell / velocity aware sample allocation (--corner-dwell)
+* 12    18OCT2026       AG      Optional galvo pre-emphasis filter after synthesis (--galvo-filter)
+* 13    18OCT2026       AG      create_sample_buffer split into lut build and synthesis, wav writing in functions (laser_bench.cpp)
+* 14    18OCT2026       AG      Per-stage timing and memory instrumentation (--stats)
+* 15    18OCT2026       AG      Parsing, lut, synthesis and wav writing moved to laser_core.hpp (shared with liblaser,
+                                wav_write), chunked wav sample writing
+* 16    18OCT2026       AG      Lookup table size as an option (--lut-size)
+* 17    18OCT2026       AG      Missing or empty points file is an error (exit -6), wav created after synthesis
 
 ***** Coding tip: try to avoid unsigned int and use fixed width ints, also use std:: with fixed width ints like std::uint32_t  *****
 ** dynamic: https://stackoverflow.com/questions/216259/is-there-a-max-array-length-limit-in-c
@@ -70,17 +104,39 @@ REF NO  VERSION DATE    WHO     DETAIL
 #include <vector>
 #include <sstream>
 #include <climits>
+#include "stroke_order.hpp"
+#include "decimate.hpp"
+#include "trajectory.hpp"
+#include "galvo_filter.hpp"
+#include "stage_stats.hpp"
+#include "laser_core.hpp"
 //#include "util.hpp"
 
 //#include <string>
-std::uint16_t TRIGGER_THRESHOLD = 32500;
 enum wave_type {rectangle = 0, sine = 1, input = 3};
 int canvas_h = 400, canvas_w = 400;    // input from user, or parse from svg file
 std::uint32_t lut_size = 480000;  // lookup table initial size
+const long MAX_LUT_SIZE = 1L << 26;     // --lut-size limit, 3 tables of int16 = 384 MiB
 
 // multiplier for 16 bit signal, the range of points [-0.5, +0.5], so after multiplication, range: [-20000, 20000]
 std::uint32_t amp_multiplyer = 60000;
 
+stage_stats stats;     // per-stage instrumentation, enabled with --stats
+
+// optional processing stages between load_image_params and lut construction, all disabled by default
+struct stage_options{
+    bool optimize_strokes = false;      // --optimize-strokes
+    double stroke_break_factor = 4.0;   // --stroke-break=<factor>, jump > factor * median point distance starts a new stroke
+    double decimate_tolerance = 0.0;    // --decimate-tol=<units>, 0 = off
+    std::size_t point_budget = 0;       // --point-budget=<N|lut>, 0 = off
+    bool point_budget_lut = false;      // --point-budget=lut, lut_size/2 once --lut-size is known
+    double corner_dwell = 0.0;          // --corner-dwell[=<factor>], 0 = off
+    double corner_angle = 30.0;         // --corner-angle=<degrees>
+    std::string galvo_calibration_file = "";    // --galvo-filter=<file>, empty = off
+    bool stats = false;                 // --stats[=<file>]
+    std::string stats_file = "";        // empty = print to stdout
+};
+
 template <typename T>
 std::string to_string_with_precision(const T a_value, const int n = 2)
 {
@@ -90,33 +146,6 @@ std::string to_string_with_precision(const T a_value, const int n = 2)
     return out.str();
 }
 
-namespace little_endian_io
-{
-  template <typename Word>  //template used here to make function write_word operate with a generic type: Word
-  std::ostream& write_word( std::ostream& outs, Word value, unsigned size = sizeof( Word ))    // ostrem is output stream object, used for output operation
-  {
-    for (; size; --size)
-    {
-        switch (size)
-        {
-        case 2:
-            value =  static_cast <uint16_t> (value);
-            break;
-        case 4:
-            value =  static_cast <uint32_t> (value);
-            break;
-        default:
-            value =  static_cast <uint32_t> (value);
-            break;
-        }
-        
-        outs.put( static_cast <char> (value & 0xFF) );    // convert to char to to eliminate leading zeros before writing
-        value >>= 8;    // shift one byte
-    }
-    return outs;
-  }
-}
-
 class Point{
     public:
         Point();
@@ -125,8 +154,8 @@ class Point{
         void set_y(double my);
         void print_point(void);
         void rescale_point(Point* point_element);    // obj pass by ref
-        double get_x();
-        double get_y();
+        double get_x() const;
+        double get_y() const;
         ~Point();
     private:
         double x, y;
@@ -155,21 +184,16 @@ void Point::print_point(void){
     std:: cout << "x: " << x << ", y: " << y << std::endl;
 }
 
-double Point::get_x(){
+double Point::get_x() const{
     return this->x;
 }
 
-double Point::get_y(){
+double Point::get_y() const{
     return this->y;
 }
 
 void Point::rescale_point(Point* point_element){
-    point_element->x = (point_element->x - 0.0) / ((double)canvas_w - 0.0);   // normalization between 0 and 1
-    point_element->y = (point_element->y - 0.0) / ((double)canvas_h - 0.0);
-    point_element->x -= 0.5;   // scale in [-0.5, 0.5] range
-    point_element->y -= 0.5;
-    point_element->x *= (double)amp_multiplyer;   // multiply to reflect in signal
-    point_element->y *= (double)amp_multiplyer;
+    laser_core::rescale(point_element->x, point_element->y, canvas_h, canvas_w, (double)amp_multiplyer);
 }
 
 Point::~Point()
@@ -217,290 +241,190 @@ int set_validate_input_args(int argc, char* argv[], int* seconds, float* freq, s
     return 0;   // no error
 }
 
-void create_sample_buffer(int16_t x_buff[], int16_t y_buff[], float freq, int Fs, int num_samples, int wave_typ, std::vector<Point> &scaled_points, int interpolation_factor)
-{
-    std::int16_t * lut = new std::int16_t [lut_size];      // lookup table used if wave is sine/rectangle
-    std::int16_t * lut_x = new std::int16_t [lut_size];      // lookup table for x values for input svg points
-    std::int16_t * lut_y = new std::int16_t [lut_size];      // lookup table for y values for input svg points
-    const float phase_increment = (freq/(float)Fs) * (float)lut_size;
-    float phase_x = 0.0f, phase_y = 0.0f;   // phase accumulator for sine and rectangular wave
-    float phase = 0.0f;    // phase for custom input svg points
-
-    switch (wave_typ)
-    {
-    case wave_type::rectangle:
-        // fill table with rectangle wave, first half zero, rest 1
-        for (int i = 0; i < lut_size; ++i)
-        {
-            if (i < (int)(lut_size/2))
-                lut[i] = 0;  // first half fill with zero
-            else
-                lut[i] = 30000;
+// picks --options out of argv and removes them, so that the positional arguments keep their position
+int set_optional_args(int* argc, char* argv[], stage_options & options){
+    int kept = 1;   // argv[0] always file name
+    for (int i = 1; i < *argc; i++){
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0){
+            argv[kept++] = argv[i];     // positional argument
+            continue;
         }
-        phase_y = phase_x + (lut_size/2) ;   // phase accumulator initial for rectangle wave right channel
-        break;
 
-    case wave_type::sine:
+        std::string name = arg, value = "";
+        std::size_t pos = arg.find("=");
+        if (pos != std::string::npos){
+            name = arg.substr(0, pos);
+            value = arg.substr(pos + 1);
+        }
 
-        // fill table with sin vals
-        for (int i = 0; i < lut_size; ++i)
-        {
-            // convert sin vals between (-1,1) to int_16 by multiplying 0x FF FF (SHRT_MAX)
-            lut[i] = (int16_t)roundf(SHRT_MAX * sinf(2.0f * M_PI * (float)i / (float)lut_size));       // sinf takes float arg
+        if (name.compare("--optimize-strokes") == 0){
+            options.optimize_strokes = true;
         }
-        phase_y = phase_x + (lut_size/4) ;   // phase accumulator for cosine wave
-        break;
-    
-    case wave_type::input:        
-        if (interpolation_factor == 0)  // no interpolation
-        {
-            int i, reverse_counter;
-            for (i = 0; i < scaled_points.size(); i++){ 
-                lut_x[i] = (int16_t)scaled_points.at(i).get_x();    //forward points i.e. start->end
-                lut_y[i] = (int16_t)scaled_points.at(i).get_y();
+        else if (name.compare("--stroke-break") == 0){
+            options.stroke_break_factor = std::strtod(value.c_str(), NULL);
+            if (options.stroke_break_factor <= 1.0){
+                std::cout << "Invalid argument: --stroke-break must be a number larger than 1" << std::endl;
+                return -5;
             }
-            reverse_counter = i - 1;   // counter for reversing half filled lut -> points to the last element of half filled array
-            while (i < lut_size){
-                lut_x[i] = lut_x[reverse_counter];    //backward points i.e. end->start
-                lut_y[i] = lut_y[reverse_counter];
-                i++;
-                reverse_counter--;
+        }
+        else if (name.compare("--decimate-tol") == 0){
+            options.decimate_tolerance = std::strtod(value.c_str(), NULL);
+            if (options.decimate_tolerance <= 0.0){
+                std::cout << "Invalid argument: --decimate-tol must be a positive number" << std::endl;
+                return -5;
             }
-            // print lut
-            for (i = 0; i < lut_size; i++){ 
-                std::cout <<"i=" << i << ",  x: " << lut_x[i] << ", y: " << lut_y[i] << std::endl;
+        }
+        else if (name.compare("--point-budget") == 0){
+            options.point_budget_lut = value.compare("lut") == 0;
+            long budget = options.point_budget_lut ? 2 : std::strtol(value.c_str(), NULL, 10);
+            if (budget < 2){
+                std::cout << "Invalid argument: --point-budget must be \"lut\" or an int of at least 2" << std::endl;
+                return -5;
             }
+            options.point_budget = (std::size_t)budget;
         }
-        else    // interpolation necessary
-        {
-            enum interpolation_type {increment = 1, decreament = -1, same = 0};
-            interpolation_type interpolation_type_x, interpolation_type_y;
-            int i, interpolation_counter, lut_counter = 0;
-            double current_x, current_y, next_x, next_y, inc_x, inc_y, interpolated_x, interpolated_y;
-
-            // Fill lut with forward points
-            for (i = 0; i < scaled_points.size() -1; i++){  // last point excluded to avoid overrun
-                current_x = scaled_points.at(i).get_x();    // save current point
-                current_y = scaled_points.at(i).get_y();
-
-                next_x = scaled_points.at(i+1).get_x();
-                next_y = scaled_points.at(i+1).get_y();
-
-                inc_x = std::abs(current_x - next_x) / (interpolation_factor + 1);  // distance / factor+1
-                inc_y = std::abs(current_y - next_y) / (interpolation_factor + 1);
-
-                if( (next_x - current_x) > 0){
-                    interpolation_type_x = interpolation_type::increment;
-                }
-                else if( (next_x - current_x) < 0)
-                {
-                    interpolation_type_x = interpolation_type::decreament;
-                }
-                else if( (next_x - current_x) == 0 ) 
-                {
-                    interpolation_type_x = interpolation_type::same;
-                }
-
-                if( (next_y - current_y) > 0){
-                    interpolation_type_y = interpolation_type::increment;
-                }
-                else if( (next_y - current_y) < 0)
-                {
-                    interpolation_type_y = interpolation_type::decreament;
-                }
-                else if( (next_y - current_y) == 0 )
-                {
-                    interpolation_type_y = interpolation_type::same;
-                }
- 
-                interpolation_counter = 0;
-                while (interpolation_counter < interpolation_factor + 1)    // +1 for the original point
-                {   // fill lut with original point(first one) and interpolated points
-
-                    if ( (lut_counter % (interpolation_factor + 1)) == 0 )  // first point fill with original
-                    {
-                        interpolated_x = current_x;
-                        interpolated_y = current_y;
-                    }
-                    else    // these are interpolated points
-                    {
-                        switch (interpolation_type_x)
-                        {
-                        case interpolation_type::increment:
-                            interpolated_x += inc_x;
-                            break;
-
-                        case interpolation_type::decreament:
-                            interpolated_x -= inc_x;
-                            break;
-
-                        case interpolation_type::same:
-                            interpolated_x = current_x;
-                            break;
-                        
-                        default:
-                            break;
-                        }
-
-                        switch (interpolation_type_y)
-                        {
-                        case interpolation_type::increment:
-                            interpolated_y += inc_y;
-                            break;
-
-                        case interpolation_type::decreament:
-                            interpolated_y -= inc_y;
-                            break;
-
-                        case interpolation_type::same:
-                            interpolated_y = current_y;
-                            break;
-                        
-                        default:
-                            break;
-                        }
-                    }
-                    
-                    // Fill lut with interpolated points
-                    lut_x[lut_counter] = (int16_t)interpolated_x;
-                    lut_y[lut_counter] = (int16_t)interpolated_y;
-
-                    lut_counter++;
-                    interpolation_counter++;
-                }
+        else if (name.compare("--lut-size") == 0){
+            long size = std::strtol(value.c_str(), NULL, 10);
+            if (size < 4 || size > MAX_LUT_SIZE){
+                std::cout << "Invalid argument: --lut-size must be an int from 4 to " << MAX_LUT_SIZE << std::endl;
+                return -5;
             }
-
-            // fill out lut with last Point, no interpolation
-            lut_x[lut_counter] = scaled_points.at(i).get_x();
-            lut_y[lut_counter] = scaled_points.at(i).get_y();
-
-            //-----------------  forward lut insertion done  ----------------------
-
-            // fill out rest half of lut with reverse values i.e. end -> start
-            int reverse_counter = lut_counter; // point to the last index of the half filled lut
-            lut_counter = lut_counter + 1;  // point to the next index
-            while (lut_counter < lut_size){
-                lut_x[lut_counter] = lut_x[reverse_counter];    //backward points i.e. end->start
-                lut_y[lut_counter] = lut_y[reverse_counter];
-                lut_counter++;
-                reverse_counter--;
+            lut_size = (std::uint32_t)size;
+        }
+        else if (name.compare("--corner-dwell") == 0){
+            options.corner_dwell = value.length() ? std::strtod(value.c_str(), NULL) : 4.0;
+            if (options.corner_dwell <= 0.0){
+                std::cout << "Invalid argument: --corner-dwell must be a positive number" << std::endl;
+                return -5;
             }
-
-            // print lut, debug purpose
-            //for (i = 0; i < lut_size; i++){ 
-            //    std::cout <<"i=" << i << ",  x: " << lut_x[i] << ", y: " << lut_y[i] << std::endl;
-            // }
-            
-        }        
-
-    default:
-        break;
-    }
-
-    // generate buffer for left and right channel
-    if(wave_typ == wave_type::rectangle || wave_typ == wave_type::sine){
-        for (int i = 0; i < num_samples; ++i)
-        {
-            int phase_i = (int)phase_x;        // get integer part of our phase
-            x_buff[i] = lut[phase_i];          // get sample value from LUT
-            phase_x += phase_increment;        // increment phase
-            if (phase_x >= (float)lut_size)    // handle wraparound
-            {
-                phase_x -= (float)lut_size;
+        }
+        else if (name.compare("--corner-angle") == 0){
+            options.corner_angle = std::strtod(value.c_str(), NULL);
+            if (options.corner_angle <= 0.0 || options.corner_angle >= 180.0){
+                std::cout << "Invalid argument: --corner-angle must be between 0 and 180 degrees" << std::endl;
+                return -5;
             }
-
-            // write to right buffer, same as before
-            int phase_j = (int)phase_y;
-            y_buff[i] = lut[phase_j];
-            phase_y += phase_increment;
-            if (phase_y >= (float)lut_size)    // handle wraparound
-            {
-                phase_y -= (float)lut_size;
+        }
+        else if (name.compare("--galvo-filter") == 0){
+            options.galvo_calibration_file = value;
+            if (!value.length()){
+                std::cout << "Invalid argument: --galvo-filter needs a calibration file, --galvo-filter=<file>" << std::endl;
+                return -5;
             }
         }
+        else if (name.compare("--stats") == 0){
+            options.stats = true;
+            options.stats_file = value;
+        }
+        else{
+            std::cout << "Invalid argument: unknown option " << arg << std::endl;
+            return -5;  // invalid option
+        }
     }
-    else if (wave_typ == wave_type::input){ // fill the entire buffer with lut values
-        for (int i = 0; i < num_samples; ++i){
-            int int_phase = (int)phase;            
-            x_buff[i] = lut_x[int_phase];
-            y_buff[i] = lut_y[int_phase];
-            phase += phase_increment;
-            if (phase >= (float)lut_size)    // handle wraparound
-            {
-                phase -= (float)lut_size;
-            }
+    if (options.point_budget_lut)
+        options.point_budget = lut_size / 2;
+    *argc = kept;
+    return 0;
+}
 
-            // handle trigger, fill first 190 values with 32500 and then 10 vals with -32500
-            if (i < 100){
-                x_buff[i] = TRIGGER_THRESHOLD;
-                y_buff[i] = TRIGGER_THRESHOLD;
-
-                // last 10 vals -31000 in the end (trigger it with falling edge with 31000 (volt equivalent) threshold)
-                if (i >= 90)
-                {
-                    x_buff[i] = -32500;
-                    y_buff[i] = -32500;
-                }
-            }
-            
-            //if (x_buff[i] > 30000 || y_buff[i] > 30000){
-            //    std::cout << x_buff[i] << ", " << y_buff[i] << std::endl;
-            //}
-            
-        }
+// fills the lookup tables, each lut_size long: lut for sine/rectangle wave, lut_x and lut_y for input svg points
+// phase_y returns the initial phase of the right channel for sine/rectangle wave
+void create_lut(std::int16_t lut[], std::int16_t lut_x[], std::int16_t lut_y[], int wave_typ, std::vector<Point> &scaled_points, int interpolation_factor, float* phase_y)
+{
+    if (wave_typ == wave_type::rectangle || wave_typ == wave_type::sine)
+        *phase_y = laser_core::build_wave_lut(lut, lut_size, wave_typ);
+    else if (wave_typ == wave_type::input)
+        laser_core::build_input_lut(lut_x, lut_y, lut_size, scaled_points, interpolation_factor);
+}
+
+// fills x_buff and y_buff with num_samples samples read from the lookup tables of create_lut
+void synthesize_samples(int16_t x_buff[], int16_t y_buff[], float freq, int Fs, int num_samples, int wave_typ,
+                        std::int16_t lut[], std::int16_t lut_x[], std::int16_t lut_y[], float phase_y)
+{
+    laser_core::render_tables tables;
+    laser_core::phase_state state;
+    bool input = wave_typ == wave_type::input;
+    tables.table_x = input ? lut_x : lut;   // sine/rectangle: both channels from lut, y ahead by phase_y
+    tables.table_y = input ? lut_y : lut;
+    tables.lut_size = lut_size;
+    tables.trigger = input;     // first 100 samples are the oscilloscope trigger
+    state.phase_y = input ? 0.0f : phase_y;
+    laser_core::render(tables, laser_core::phase_increment(freq, Fs, lut_size), state, x_buff, y_buff, 1, num_samples);
+}
+
+void create_sample_buffer(int16_t x_buff[], int16_t y_buff[], float freq, int Fs, int num_samples, int wave_typ, std::vector<Point> &scaled_points, int interpolation_factor)
+{
+    std::int16_t * lut = new std::int16_t [lut_size];      // lookup table used if wave is sine/rectangle
+    std::int16_t * lut_x = new std::int16_t [lut_size];      // lookup table for x values for input svg points
+    std::int16_t * lut_y = new std::int16_t [lut_size];      // lookup table for y values for input svg points
+    float phase_y = 0.0f;
+    stats.counter("lut_size", lut_size);
+    stats.counter("lut_bytes", 3.0 * lut_size * sizeof(std::int16_t));
+
+    {
+        stage_timer timer(stats, "create_lut");
+        create_lut(lut, lut_x, lut_y, wave_typ, scaled_points, interpolation_factor, &phase_y);
     }
-    
+    {
+        stage_timer timer(stats, "synthesize_samples");
+        synthesize_samples(x_buff, y_buff, freq, Fs, num_samples, wave_typ, lut, lut_x, lut_y, phase_y);
+    }
+
     // free dynamically allocated memory
     delete [] lut;
     delete [] lut_x;
     delete [] lut_y;
 }
 
+/*
+    -- Set lookup table size according to need. LUT must contain at least 2x points for drawing signal as
+    start point -> (...optional interpolated points in middle...) -> end point + 
+    end point -> (...optional interpolated points in middle...) -> start point)
+    -- returns the interpolation factor i.e. num of points between 2 adjacent points
+*/
+int set_lut_size(int input_points_count)
+{
+    // lut_size is always even number because it contains forward and reverse points e.g. start->end + end->start
+    int interpolation_factor;
+    lut_size = laser_core::size_lut(lut_size, input_points_count, &interpolation_factor);
+    return interpolation_factor;
+}
+
+// writes the 44 byte wav header (RIFF, fmt and data chunk header) for 16 bit stereo pcm
+void write_wav_header(std::ostream & file_wav, int sampling_rate, int num_samples)
+{
+    laser_core::write_wav_header(file_wav, sampling_rate, num_samples);
+}
+
+// writes samples to wav file, x to left channel and y to right channel
+void write_wav_samples(std::ostream & file_wav, int16_t x_buff[], int16_t y_buff[], int num_samples)
+{
+    laser_core::write_pcm(file_wav, x_buff, y_buff, 1, num_samples);
+}
+
 bool load_image_params(std::string file, std::vector<Point> &points, int* canvas_height, int* canvas_width)
 {
-    std::ifstream file_points(file);
-    std::string line, x, y;
-    int pos;
-    Point current_point;
-    std::size_t offset = 0; //offset will be set to the length of characters of the "value" - 1.
-    std::string::size_type sz;   // alias of size_t
-
-    if (file_points.is_open())
+    int error = laser_core::load_points(file, points, canvas_height, canvas_width);
+    if (error == LASER_ERR_FORMAT)
     {
-        while (std::getline(file_points, line))
-        {
-            pos = line.find(",");
-            if (pos != std::string::npos)    // npos means not found
-            {
-                x = line.substr(0, pos);   // x coordinate
-                y = line.substr(pos + 1, line.length());   // y cordinate
-                current_point.set_x(std::stod (x, &offset));
-                current_point.set_y(std::stod (y, &offset));
-                points.push_back(current_point); // convert string to double and push
-            }
-            else if (line.compare("#") == 0)    // end of file
-            {
-                break; //exit from while loop
-            }
-            else    // check for dimensions that are delimited as height|width 
-            {
-                pos = line.find("|");
-                if (pos != std::string::npos){
-                    *canvas_height = std::stoi(line.substr(0, pos), &sz);
-                    *canvas_width = std::stoi(line.substr(pos + 1, line.length()), &sz);
-                }else
-                {
-                    std::cout << "Input Error: invalid input file. The file contains unexpected characters. Please check source file (svg_to_wav.cpp) header comment to arrange input text file." << std::endl;
-                    return false;
-                }
-                
-            }            
-        }
-        file_points.close();
+        std::cout << "Input Error: invalid input file. The file contains unexpected characters. Please check source file (svg_to_wav.cpp) header comment to arrange input text file." << std::endl;
+        return false;
+    }
+    if (error == LASER_ERR_OPEN)
+    {
+        std::cout << "Input Error: points file " << file << " can not be opened." << std::endl;
+        return false;
+    }
+    if (points.empty())
+    {
+        std::cout << "Input Error: points file " << file << " contains no points, at least one x,y line is needed." << std::endl;
+        return false;
     }
     return true;
 }
 
+#ifndef SVG_TO_WAV_NO_MAIN   // defined by programs that include this file for its functions (laser_bench.cpp)
 int main(int argc, char* argv[])
 {
     // init default values for the signal
@@ -508,6 +432,16 @@ int main(int argc, char* argv[])
     float freq = 0.1;
     int signal = -1;
     std::string signal_name = "", points_file = "";
+    stage_options options;
+
+    if ((retval=set_optional_args(&argc, argv, options)) != 0){
+        exit(retval);
+    }
+    if (options.stats)
+        stats.enable();
+    std::ostream json_out(std::cout.rdbuf());   // stdout, also when std::cout is moved to stderr
+    if (options.stats && options.stats_file.empty())
+        std::cout.rdbuf(std::cerr.rdbuf());     // the json stays parseable
 
     if ((retval=set_validate_input_args(argc, argv, &seconds, &freq, signal_name, &sampling_rate, points_file)) != 0){  // all passed by ref
         exit(retval);   // error occured, exit main with error value (retval will be useful in bash testing)
@@ -520,29 +454,6 @@ int main(int argc, char* argv[])
         signal_name = points_file.substr(0, points_file.length()-4);  // input picture name from file name, remove the last 4 chars (.txt)
     }
 
-    // code for setting wav file header
-    const int BITS_PER_SAMPLE = 16;
-    const int NUM_CHANNELS = 2;
-    int block_align = (int)(NUM_CHANNELS * BITS_PER_SAMPLE/8);
-    int subchunk2_size = num_samples * block_align;
-    int byte_rate = sampling_rate * block_align;
-    
-    // ios is base class for streams
-    // ofstream = stream class to write on files, ios::binary is static constant, ios is under std namespace
-    std::ofstream file_wav(signal_name + "," + std::to_string(seconds) + "sec," + to_string_with_precision(freq) + "Hz,SR"+ to_string_with_precision(sampling_rate) + ".wav", std::ios::binary); 
-    // Write the file headers
-    file_wav << "RIFF";     // 4bytes, each char is 1 byte
-    little_endian_io::write_word(file_wav, 36 + subchunk2_size, 4);
-    file_wav << "WAVEfmt "; 
-    little_endian_io::write_word(file_wav, 16, 4);  // no extension data, (16=size of rest subchunk for PCM)
-    little_endian_io::write_word(file_wav, 1, 2);  // 1=PCM - integer samples (e.g. linear quantization means no compression)
-    little_endian_io::write_word(file_wav, NUM_CHANNELS, 2 );  // two channels (stereo file)
-    little_endian_io::write_word(file_wav, sampling_rate, 4);  // sampling rate (Hz)
-    little_endian_io::write_word(file_wav, byte_rate, 4);  // 176400=ByteRate (Sample Rate=44100 * BitsPerSample=16 * Channels=2) / 8
-    little_endian_io::write_word(file_wav, block_align, 2);  // data block size=number of bytes for one sample (NumChannels=2 * BitsPerSample=16/8)
-    little_endian_io::write_word(file_wav, BITS_PER_SAMPLE, 2);  // bits per sample=16 (use a multiple of 8)
-
-
     {   // print input params
         std::cout << "freq: " << freq << std::endl;
         std::cout << "sampling_rate: " << sampling_rate << std::endl;
@@ -551,36 +462,68 @@ int main(int argc, char* argv[])
     }
  
     std::vector<Point> points;
-    if(!load_image_params(points_file, points, &canvas_h, &canvas_w)){    // load points and canvus dimensions, all passed by ref
-        return 0;   // error occured, exit main
+    bool loaded;
+    {
+        stage_timer timer(stats, "load_image_params");
+        loaded = load_image_params(points_file, points, &canvas_h, &canvas_w);    // load points and canvus dimensions, all passed by ref
     }
+    if(!loaded){
+        exit(-6);   // points file missing, empty or invalid: no wav is written
+    }
+    stats.counter("input_points", points.size());
 
     std::cout << "# of points in input file (vect size): " << points.size() << ", Canvas dimension: " << canvas_h << " * " << canvas_w << std::endl;
-    for (Point &element: points)    // rescale points, pass each element by ref
-        element.rescale_point(&element);
+    {
+        stage_timer timer(stats, "rescale_point");
+        for (Point &element: points)    // rescale points, pass each element by ref
+            element.rescale_point(&element);
+    }
+
+    if (options.optimize_strokes && signal == -1)
+    {   // travel is measured on the rescaled points i.e. in output sample units
+        stage_timer timer(stats, "optimize_stroke_order");
+        stroke_report report = optimize_stroke_order(points, options.stroke_break_factor);
+        std::cout << "# of strokes: " << report.strokes << ", travel between strokes before: " << (long)report.travel_before
+                  << ", after: " << (long)report.travel_after << std::endl;
+    }
+
+    if ((options.decimate_tolerance > 0.0 || options.point_budget > 0) && signal == -1)
+    {
+        stage_timer timer(stats, "decimate");
+        decimation_report report;
+        if (options.decimate_tolerance > 0.0)
+        {
+            report = decimate_tolerance(points, options.decimate_tolerance);
+            std::cout << "Decimation (tolerance " << options.decimate_tolerance << "): " << report.points_before << " -> "
+                      << report.points_after << " points, max deviation: " << report.max_deviation << std::endl;
+        }
+        if (options.point_budget > 0)
+        {
+            report = decimate_budget(points, options.point_budget);
+            std::cout << "Decimation (budget " << options.point_budget << "): " << report.points_before << " -> "
+                      << report.points_after << " points, max deviation: " << report.max_deviation << std::endl;
+        }
+    }
 
 /*
     for (Point element: points) // print to see the scaled points vector vals
         element.print_point();
 */
-    /*
-        -- Set lookup table size according to need. LUT must contain at least 2x points for drawing signal as
-        start point -> (...optional interpolated points in middle...) -> end point + 
-        end point -> (...optional interpolated points in middle...) -> start point)
-    */
-    // lut_size is always even number because it contains forward and reverse points e.g. start->end + end->start
-    int interpolation_factor = 0, input_points_count = points.size();
-    if (lut_size <= input_points_count * 2)   // number of points more than default lut_size, resize lut
-    {
-        lut_size = input_points_count * 2;  // no interpolated points
+    int interpolation_factor = set_lut_size(points.size());
+    if (lut_size == 0){
+        std::cout << "ERROR: no points left for the lookup table." << std::endl;
+        exit(-6);
     }
-    else
-    {   // lut_size is bigger ie. can hold more points than available -> interpolation needed
-        // interpolation_factor is num of points between 2 adjacent points
-        interpolation_factor = floor( ( (lut_size/2) - input_points_count ) / (input_points_count-1) );
 
-        // redefine lut_size so that it only contains signal forward + backward 
-        lut_size = 2 * ( input_points_count + interpolation_factor * (input_points_count - 1) );
+    if (options.corner_dwell > 0.0 && signal == -1)
+    {   // trajectory holds every forward sample of the lut, so no further interpolation
+        stage_timer timer(stats, "build_trajectory");
+        std::vector<Point> trajectory;
+        trajectory_report report = build_trajectory(points, lut_size / 2, options.corner_dwell, options.corner_angle, trajectory);
+        points.swap(trajectory);
+        interpolation_factor = 0;
+        std::cout << "Corner dwell: " << report.corners << " corners, " << report.dwell_samples << " dwell samples, "
+                  << report.interpolated_samples << " interpolated samples" << std::endl;
     }
 
 /*
@@ -589,11 +532,6 @@ int main(int argc, char* argv[])
         return 0;
     }    
 */
-    // Write the data chunk header
-    size_t data_chunk_pos = file_wav.tellp();
-    file_wav << "data";
-    little_endian_io::write_word(file_wav, subchunk2_size, 4);
-
     // Prepare sample data for left and right channels
     wave_type wave;
     if (signal == 0)
@@ -613,25 +551,64 @@ int main(int argc, char* argv[])
     std::cout << "#interpolated points: " << interpolation_factor << ", Lookup table size: " << lut_size << std::endl;
     //test(x_buff, y_buff, freq, sampling_rate, num_samples, wave);
     create_sample_buffer(x_buff, y_buff, freq, sampling_rate, num_samples, wave, points, interpolation_factor);
-    
 
-    // write samples to wav file
-    for(int i = 0; i < num_samples; ++i)
+    if (options.galvo_calibration_file.length())
     {
-        little_endian_io::write_word(file_wav, x_buff[i], 2); // write sample to left channel
-        little_endian_io::write_word(file_wav, y_buff[i], 2); // write sample to right channel
+        stage_timer timer(stats, "galvo_filter");
+        galvo_calibration calibration;
+        if (!load_galvo_calibration(options.galvo_calibration_file, calibration, sampling_rate)){
+            return 0;   // error occured, exit main
+        }
+        // trigger samples at the beginning are left as they are, filter starts settled on the first shape sample
+        int first = wave == wave_type::input ? std::min((int)laser_core::TRIGGER_FRAMES, num_samples) : 0;
+        galvo_filter filter(calibration);
+        if (first < num_samples)
+            filter.reset(x_buff[first], y_buff[first]);
+        filter.process(x_buff + first, y_buff + first, num_samples - first);
+        std::cout << "Galvo filter: " << calibration.x.size() << " x sections, " << calibration.y.size() << " y sections" << std::endl;
+    }
+    
 
-        // std::cout << "i: " << i << std::endl; // left buff vals
-        // std::cout << "left buff: " << x_buff[i] << std::endl; // left buff vals
-        // std::cout << "right: " << y_buff[i] << std::endl; // left buff vals
+    // ios is base class for streams, the wav is created only once the samples are there
+    // ofstream = stream class to write on files, ios::binary is static constant, ios is under std namespace
+    std::ofstream file_wav(signal_name + "," + std::to_string(seconds) + "sec," + to_string_with_precision(freq) + "Hz,SR"+ to_string_with_precision(sampling_rate) + ".wav", std::ios::binary); 
+    write_wav_header(file_wav, sampling_rate, num_samples);
 
+    // write samples to wav file
+    {
+        stage_timer timer(stats, "write_wav");
+        write_wav_samples(file_wav, x_buff, y_buff, num_samples);
+        file_wav.flush();
     }
 
     // free dynamically allocated memory
     delete[] x_buff;
     delete[] y_buff;
 
+    if (options.stats)
+    {
+        std::int64_t synthesize_ns = stats.stage_ns("synthesize_samples"), write_ns = stats.stage_ns("write_wav");
+        double bytes_written = (double)file_wav.tellp();
+        stats.counter("points", points.size());
+        stats.counter("num_samples", num_samples);
+        stats.counter("samples_per_sec", synthesize_ns > 0 ? num_samples * 1e9 / synthesize_ns : 0.0);
+        stats.counter("bytes_written", bytes_written);
+        stats.counter("write_bytes_per_sec", write_ns > 0 ? bytes_written * 1e9 / write_ns : 0.0);
+    }
     file_wav.close();
 
+    if (options.stats)
+    {
+        if (options.stats_file.length())
+        {
+            std::ofstream file_stats(options.stats_file);
+            stats.write_json(file_stats, "svg_to_wav");
+        }
+        else
+            stats.write_json(json_out, "svg_to_wav");
+    }
+    std::cout.rdbuf(json_out.rdbuf());
+
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -4,12 +4,20 @@
 # FILENAME :        test.sh
 #
 # DESCRIPTION :
-#       Batch testing: generates test cases and calls execution of input text files (containing points 
-#                       of an image) to wav signal of desired frequency
+#       Regression testing: builds svg_to_wav and laser_regress, then laser_regress renders every points file
+#                       in svg/ at several sampling rates and compares the audio with the stored goldens
+#                       (svg/regress.golden) and the run time with the perf baseline of this machine.
+#                       Runs without any input, exit code is 0 only when every case passed.
 #
 # PUBLIC FUNCTIONS :
-#   create_wav_with_SRs: takes four arguments, takes a single file as input and calls svg_towav execution for it 
+#   detect_OS_and_build: builds svg_to_wav, laser_regress and laser_compare if the source is newer than the executable
 #   write_screen_log: printf to both terminal and log
+#   check_bad_input: svg_to_wav must exit with -6 (250) and write no wav for a missing or an empty points file
+#
+# How to call:
+#   ./test.sh                       run all cases
+#   ./test.sh --update              accept the current output as new goldens (after an intended change)
+#   all arguments are passed on to laser_regress, see laser_regress.cpp for its options
 #
 
 AUTHOR :    A K M Sharif Kaiser(SK)        START DATE : 27 Feb 2021
@@ -21,6 +29,10 @@ REF NO  VERSION DATE    WHO     DETAIL
 * 04    25Mar2021       SK      Dimension addition to existing points file
 * 05    29MAR2021       SK      Added test cases with different sampling rates
 * 06    31MAR2021       SK      Warning message addition
+* 07    18OCT2026       AG      Headless golden-output and perf regression test (laser_regress.cpp) replaces
+                                the interactive batch run, input file checks moved to laser_regress
+* 08    18OCT2026       AG      Missing and empty (canvas line only) points file cases
+* 09    18OCT2026       AG      laser_compare built for the synthetic dropout case of laser_regress
 
 #H-#
 COMMENT
@@ -38,10 +50,6 @@ COMMENT
     In bash, there must not be any space around = sign while assigning a val
 COMMENT
 
-re='^[+-]?[0-9]+([.][0-9]+)?$'                          # regular expression for a signed number
-sampling_rate=48000
-max_freq=$((sampling_rate / 2)) # nyquist theorem, (bash arithmetic:no space after brackets)
-duration=10 # in seconds
 OS_name=""
 
 # begin: log file related code
@@ -77,258 +85,75 @@ detect_OS_and_build () {
     write_screen_log "OS: $OS_name ($OSTYPE)\n"
 
     if [[ "$OS_name" = "windows" ]]; then
-        EXEC_add_dim="add_dim_to_points.exe"
         EXEC_to_wav="svg_to_wav.exe"       # windows executable file
+        EXEC_regress="laser_regress.exe"
+        EXEC_compare="laser_compare.exe"
     else
-        EXEC_add_dim="add_dim_to_points"
         EXEC_to_wav="svg_to_wav"           # for linux and macOS
+        EXEC_regress="laser_regress"
+        EXEC_compare="laser_compare"
     fi
 
     SRC_to_wav="svg_to_wav.cpp"
-    SRC_add_dim="add_dim_to_points.cpp"
-
-    if [[ "$SRC_add_dim" -nt "$EXEC_add_dim" ]]; then                     # if source newer than executable file, then build
-        write_screen_log "Rebuilding $SRC_add_dim...\n"
+    SRC_regress="laser_regress.cpp"
+    SRC_compare="laser_compare.cpp"
 
-        if [[ "$OS_name" = "macOS" ]]; then
-            CC=/usr/bin/clang++         # clang++ is default compiler for macOS
-            $CC -std=c++17 -stdlib=libc++ -g $SRC_add_dim -o $EXEC_add_dim   # build, see tasks.json file for build details in vscode
-            write_screen_log "$CC -std=c++17 -stdlib=libc++ -g $SRC_add_dim -o $EXEC_add_dim\n"
-        elif [[ "$OS_name" = "linux" ]]; then
-            CC=/usr/bin/g++         # g++ compiler for ubuntu
-            $CC -g --std=c++17 $SRC_add_dim -o $EXEC_add_dim
-            write_screen_log "$CC -g --std=c++17 $SRC_add_dim -o $EXEC_add_dim\n"
-        elif [[ "$OS_name" = "windows" ]]; then
-            CC=g++         # msys mingw64 compiler for windows (assuming environment path added to windows)
-            $CC -g --std=c++17 $SRC_add_dim -o $EXEC_add_dim
-            write_screen_log "$CC -g --std=c++17 $SRC_add_dim -o $EXEC_add_dim\n"
-        fi
-    fi
+    build_if_newer $SRC_to_wav $EXEC_to_wav
+    build_if_newer $SRC_regress $EXEC_regress liblaser.cpp     # the liblaser cases render through laser.h
+    build_if_newer $SRC_compare $EXEC_compare wav_reader.c     # the dropout case of laser_regress
+}
 
-    if [[ "$SRC_to_wav" -nt "$EXEC_to_wav" ]]; then                     # if source newer than executable file, then build
-        write_screen_log "Rebuilding $SRC_to_wav...\n"
+build_if_newer () {
+    local src=$1 exec=$2 extra=$3   # args: source file, executable file, further sources linked in (optional)
+    # no fused multiply-add contraction, the goldens are the same on x86-64 and aarch64
+    # svg_to_wav includes the stage headers, rebuild when any of them changed too
+    if [[ "$src" -nt "$exec" || ( -n "$extra" && "$extra" -nt "$exec" ) || -n $(find . -maxdepth 1 -name "*.hpp" -newer "$exec" 2>/dev/null) || ! -f "$exec" ]]; then
+        write_screen_log "Rebuilding $src...\n"
 
         if [[ "$OS_name" = "macOS" ]]; then
             CC=/usr/bin/clang++         # clang++ is default compiler for macOS
-            $CC -std=c++17 -stdlib=libc++ -g $SRC_to_wav -o $EXEC_to_wav   # build, see tasks.json file for build details in vscode
-            write_screen_log "$CC -std=c++17 -stdlib=libc++ -g $SRC_to_wav -o $EXEC_to_wav\n"
+            $CC -std=c++17 -stdlib=libc++ -ffp-contract=off -g $src $extra -o $exec   # build, see tasks.json file for build details in vscode
+            write_screen_log "$CC -std=c++17 -stdlib=libc++ -ffp-contract=off -g $src $extra -o $exec\n"
         elif [[ "$OS_name" = "linux" ]]; then
             CC=/usr/bin/g++         # g++ compiler for ubuntu
-            $CC -g --std=c++17 $SRC_to_wav -o $EXEC_to_wav
-            write_screen_log "$CC -g --std=c++17 $SRC_to_wav -o $EXEC_to_wav\n"
+            $CC -g --std=c++17 -ffp-contract=off $src $extra -o $exec
+            write_screen_log "$CC -g --std=c++17 -ffp-contract=off $src $extra -o $exec\n"
         elif [[ "$OS_name" = "windows" ]]; then
             CC=g++         # msys mingw64 compiler for windows (assuming environment path added to windows)
-            $CC -g --std=c++17 $SRC_to_wav -o $EXEC_to_wav
-            write_screen_log "$CC -g --std=c++17 $SRC_to_wav -o $EXEC_to_wav\n"
+            $CC -g --std=c++17 -ffp-contract=off $src $extra -o $exec
+            write_screen_log "$CC -g --std=c++17 -ffp-contract=off $src $extra -o $exec\n"
         fi
     fi
 }
 
 # end: detect_OS_and_build
 
-
-# start: validate_input_file -> check errors in an input text file
-validate_input_file(){
-    local file_name=$1 #arg: $1=filename
-
-    # for windows OS, remove the crlf from text file, make txt as unix
-    dos2unix $file_name
-    #write_screen_log "Converting $file_name to unix format...\n"
-
-    is_valid=true    # initialize as valid, e.g. no error found 
-    if [[ -s "$file_name" ]]; then                             # check whether file exist and not empty
-        if [[ -r "$file_name" ]]; then                         # check if file readable
-            # read each line of the input text file
-            # -r prevents backslash escapes from being interpreted
-            # [ -n "$line" ] to include the last line if the last char of file is not newline 
-            i=1
-            while read -r line || [ -n "$line" ]; do                
-                # test whether first has dimensions in h|w format
-                if [[ "$i" = 1 ]] ; then
-                    IFS="|"                             # set | as a delimiter, used to check height|width
-                    read -a strarr <<< "$line"          # Read the split words into an array
-
-                    if ! [[ ${#strarr[@]} = 2 ]]; then  # validation for only 2 values h and w
-                        write_screen_log "FAIL($file_name): First line of file must contain dimensions in height|width format, where height and width are both rational numbers.\n" 
-                        is_valid=false    # eror occured, file not valid anymore
-                    fi
-
-                    # check if height and width both are numbers
-                    if ! [[ "${strarr[0]}" =~ $re && "${strarr[1]}" =~ $re ]]; then # =~ for comparing with regex 
-                        write_screen_log "FAIL($file_name): First line of file must contain dimensions in height|width format, where height and width are both rational numbers.\n"
-                        is_valid=false
-                    fi
-                
-                else
-                    # test all other lines
-                    if [[ "$line" = "#" ]]; then    # encountered end of file
-                        if [[ $i -lt 4 ]]; then    # check if at least 2 points exist
-                            write_screen_log "FAIL($file_name): There are not enough points in file. Please provide at least two points for this file.\n"
-                                is_valid=false
-                        fi
-                    
-                    else
-                        # did not find #, it must be a point
-                        # test point coordinates x,y
-                        IFS=","                             # set | as a delimiter, used to check height|width
-                        read -a strarr <<< "$line"          # Read the split words into an array
-
-                        if ! [[ ${#strarr[@]} = 2 ]]; then  # delimiter found invalid string
-                                write_screen_log "FAIL($file_name): Invalid point in line $i of file. Input point format is x,y where x and y are coordinates of the point (rational numbers).\n" 
-                                is_valid=false
-                        else
-                            # 2 items found by delimited, now check if height and width both are numbers
-                            if ! [[ "${strarr[0]}" =~ $re && "${strarr[1]}" =~ $re ]]; then # =~ for comparing with regex 
-                                write_screen_log "FAIL($file_name): Invalid point in line $i of file. Input point format is x,y where x and y are coordinates of the point (rational numbers).\n"
-                                is_valid=false
-                            fi
-                        fi
-                    fi
-                fi
-
-                i=$((i+1))
-                #printf "$i\n"
-            done < "$file_name"      # file-> each line reading end
-
-            # check end of file exists in last line
-            if ! [[ $( tail -n 1 "$file_name" ) = "#" ]]; then
-                write_screen_log "FAIL($file_name): The last line must contain # to denote end of file. Please create a new line and append #\n"
-                is_valid=false
-            fi
-
-        else
-            write_screen_log "FAIL($file_name): file not readable.\n";
-            is_valid=false
-        fi
-
-    else
-        write_screen_log "FAIL($file_name): file does not exist or is empty. Please check your input file.\n"
-        is_valid=false
-    fi
-    
-    # return
-    if [[ $is_valid = true ]]; then return 0; else return 10;  fi # 0 means true=valid input file, 10=false e.g. invalid
-}
-# end: validate_input_file function
-
-create_wav_with_SRs () {                               # function for executing code with different sampling rates
-    local file_name=$1  # assign arg to a meaningful name file_name, it is a local var
-    if [[ $file_name =~ ^./ ]]; then    # check if file name starts with ./ (same dir for mac)
-        file_name=${file_name:2};   # removes first 2 characters ./ from file name
-    fi
-    
-    duration=10
-    freq=0.1
-
-    write_screen_log "Executing: ./$EXEC_to_wav $file_name $duration $freq with different sampling rates ...\n"
-    ./$EXEC_to_wav $file_name $duration $freq 480                             # calls main function, args: filename seconds freq sampling_rate 
-    ./$EXEC_to_wav $file_name $duration $freq 4800
-    ./$EXEC_to_wav $file_name $duration $freq 8000
-    ./$EXEC_to_wav $file_name $duration $freq 11025
-    ./$EXEC_to_wav $file_name $duration $freq 12000
-    ./$EXEC_to_wav $file_name $duration $freq 22050
-    ./$EXEC_to_wav $file_name $duration $freq 32000
-    ./$EXEC_to_wav $file_name $duration $freq 44100
-    ./$EXEC_to_wav $file_name $duration $freq 48000
-    ./$EXEC_to_wav $file_name $duration $freq 196000
-    ./$EXEC_to_wav $file_name $duration $freq 392000
-
-    # error checking with arguments
-    if [[ "$?" != 0 ]]; then    # if main function returned non-zero
-        write_screen_log "Processing FAIL: Points of $file_name was not processed. Please provide valid arguments for execution.\n\n"
-    else
-        write_screen_log "Processing SUCCESS: Points of $file_name has been processed successfully.\n\n"
-    fi
-}
-# end: create_wav_with_SRs function
-
-execute(){
-    # check if bash has at least 1 arg (filename), having argument means it will process a single file
-    if [[ "$#" -ge 1 ]]; then
-        
-        if [ "$1" == "-h" ] ; then
-            # begin: check if arg is help and add help text
-            printf "Help: `basename $0` -h\n\n"
-            printf "Batch Test: `basename $0`\n"
-            printf "  This command takes all text files (containing image point) in the same directory and converts them to wav files with different frequencies.\n\n"
-            printf "Single Input Test: `basename $0` <input file name> [duration frequency sampling_rate]\n"
-            printf "  duration        : positive int \n  frequency       : positive number 0<frequency<=(sampling_rate/2)\n  sampling_rate   : 48000 (preferred) or 44100\n"
-            exit 0
-            #end: help text
+check_bad_input () {
+    local exec=$(pwd)/$EXEC_to_wav dir status failed=0
+    dir=$(mktemp -d)     # the cases run there, a wav written by mistake does not land in svg/
+    printf "400|400\n#\n" > "$dir/empty.txt"
+    for points_file in "$dir/nonexistent.txt" "$dir/empty.txt"; do
+        (cd "$dir" && "$exec" "$points_file" 1 100 48000 > /dev/null 2>&1)
+        status=$?
+        if [[ $status -ne 250 || -n $(find "$dir" -name "*.wav") ]]; then
+            write_screen_log "FAIL  $(basename $points_file): exit $status, expected 250 and no wav\n"
+            failed=1
         else
-            # begin: single file test
-            create_log_file
-            detect_OS_and_build
-            write_screen_log "Single file test starting...\n"
-            
-            # Add dimension to file
-            write_screen_log "Executing: ./$EXEC_add_dim $1 ...\n"
-            ./$EXEC_add_dim $1
-
-            validate_input_file $1
-            is_file_valid=$?            # catch return val
-
-            if [[ $is_file_valid -eq 10 ]]; then  # false=not valid, skip processing this file
-                write_screen_log "FAIL: $1 will not be processed due to errors.\n\n"
-            else
-                create_wav_with_SRs $1         # execute with arguments
-            fi
-            # end: single file test
+            write_screen_log "PASS  $(basename $points_file): exit $status\n"
         fi
-
-    else
-
-        # bash has no args, means batch testing
-        create_log_file
-        detect_OS_and_build
-        write_screen_log "Batch test starting...\n"
-
-        # Add dimension to all files in the current dir
-        write_screen_log "Executing: ./$EXEC_add_dim ...\n"
-        ./$EXEC_add_dim
-
-        for file in $(find . -type f -maxdepth 1 -name "*.txt")
-        do
-            validate_input_file $file
-            is_file_valid=$?    # catch return val
-
-            # file error check
-            if [[ $is_file_valid -eq 10 ]]; then  # false=not valid, skip processing this file
-                write_screen_log "FAIL: $file will not be processed due to errors.\n\n"
-                continue
-            
-            else    # input file is correct, call main function and run tests
-                write_screen_log "SUCCESS: $file is a valid input file. It will now be processed.\n"
-
-                # calculate first frequency test case, to fit 1 full cycle of the signal in the entire 10 sec 
-                # bc for floating op arithmetic, this must be echo'ed or expr returns string
-                #freq=$(expr "scale=1;1/$duration" | bc)    #freq is a string, scale=1 means keep 1 places after decimal
-                
-                # the calculated freq is a string, call main function once while loop to avoid calculation problems due to string
-                create_wav_with_SRs $file        # function call for exec e.g. calls cpp main function (only input file arg is mandatory)
-
-                # calculate second frequency
-                #freq=$(expr $freq*10 | bc)  # freq=freq*10
-                #freq=${freq%.*} # as freq contains a string with a decimal, get rid of decimal part from freq
-
-                #while [ $freq -le $max_freq ]; do       # -le means less or equal
-                #    create_wav_with_SRs $file $duration $freq $sampling_rate    # function call for exec e.g. calls cpp main function (only input file arg is mandatory)
-                #    freq=$((freq*10))
-                #done
-
-            fi
-
-        done    #each file processing loop end
-    fi
+    done
+    rm -rf "$dir"
+    return $failed
 }
 
-# Warning and execute
-echo "This script might change contents of all the text files in the current directory. Please save any important text documents to another directory first. Do you want to continue? (type 1 or 2 and enter)"
-select yn in "Yes" "No"; do
-    case $yn in
-        Yes ) execute; break;;
-        No ) exit;;
-    esac
-done
-
-
+create_log_file
+detect_OS_and_build
+write_screen_log "Regression test starting...\n"
+check_bad_input
+bad_input=$?
+./$EXEC_regress --exec=./$EXEC_to_wav --compare-exec=./$EXEC_compare "$@" | tee -a $log_file
+regress=${PIPESTATUS[0]}
+if [[ $regress -ne 0 ]]; then
+    exit $regress
+fi
+exit $bad_input
@@ -0,0 +1,144 @@
+/*H**********************************************************************
+* FILENAME :        trajectory.hpp
+*
+* DESCRIPTION :
+*       Velocity aware sample allocation for the forward half of the lookup table. The galvo cannot follow
+*       an instant change of direction, so corners are given dwell samples (the beam waits on the corner)
+*       and the samples for that are taken away from straight runs. The number of samples (cycle length)
+*       stays the same.
+*
+* PUBLIC FUNCTIONS :
+*   trajectory_report build_trajectory(std::vector<PointT> &points, std::size_t samples, double dwell_factor,
+*                                      double corner_angle, std::vector<PointT> &trajectory)
+*
+Note:
+    -- turning angle at point i is the angle between p(i-1)->p(i) and p(i)->p(i+1), 0 for a straight run and
+       180 degrees for a full reversal. The first and the last point count as full reversals because the
+       lookup table is played start->end->start.
+    -- a point turning more than corner_angle (degrees) is a corner. Its dwell is
+            dwell_factor * (angle - corner_angle) / (180 - corner_angle) * (spare samples / segments)
+       i.e. a full reversal waits as long as dwell_factor average segments take to draw. Dwell uses at most
+       half of the spare samples, it is scaled down otherwise.
+    -- the remaining spare samples are interpolated along the segments proportional to segment length, the
+       beam moves with constant velocity along the trace (largest remainder rounding)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+struct trajectory_report{
+    std::size_t corners = 0;            // points that got dwell samples, including both ends
+    std::size_t dwell_samples = 0;      // samples spent waiting on corners
+    std::size_t interpolated_samples = 0;
+};
+
+// distributes total over weights (sum > 0) as integers, largest remainder method
+inline void allocate_proportional(const std::vector<double> &weights, std::size_t total, std::vector<std::size_t> &result)
+{
+    double sum = 0.0;
+    for (double w: weights)
+        sum += w;
+    result.assign(weights.size(), 0);
+    if (sum <= 0.0 || total == 0)
+        return;
+
+    std::vector<std::pair<double, std::size_t>> remainders(weights.size());
+    std::size_t given = 0;
+    for (std::size_t i = 0; i < weights.size(); i++)
+    {
+        double exact = (double)total * weights[i] / sum;
+        result[i] = (std::size_t)exact;
+        given += result[i];
+        remainders[i] = std::make_pair(exact - (double)result[i], i);
+    }
+    std::size_t left = total - given;
+    if (left > 0)
+    {
+        std::nth_element(remainders.begin(), remainders.begin() + (left - 1), remainders.end(),
+                         [](const std::pair<double, std::size_t> &a, const std::pair<double, std::size_t> &b){ return a.first > b.first; });
+        for (std::size_t i = 0; i < left; i++)
+            result[remainders[i].second]++;
+    }
+}
+
+template <typename PointT>
+trajectory_report build_trajectory(std::vector<PointT> &points, std::size_t samples, double dwell_factor,
+                                   double corner_angle, std::vector<PointT> &trajectory)
+{
+    trajectory_report report;
+    std::size_t n = points.size();
+    trajectory.clear();
+    if (n < 2 || samples <= n)  // no spare samples, nothing to allocate
+    {
+        trajectory = points;
+        return report;
+    }
+
+    std::size_t segments = n - 1, spare = samples - n;
+    const double threshold = corner_angle * M_PI / 180.0;
+
+    // turning angle weight of every point, 0 = no corner, 1 = full reversal
+    std::vector<double> corner_weight(n, 0.0), length(segments);
+    for (std::size_t i = 0; i < segments; i++)
+        length[i] = std::hypot(points[i + 1].get_x() - points[i].get_x(), points[i + 1].get_y() - points[i].get_y());
+    corner_weight[0] = corner_weight[n - 1] = 1.0;
+    for (std::size_t i = 1; i + 1 < n; i++)
+    {
+        double ax = points[i].get_x() - points[i - 1].get_x(), ay = points[i].get_y() - points[i - 1].get_y();
+        double bx = points[i + 1].get_x() - points[i].get_x(), by = points[i + 1].get_y() - points[i].get_y();
+        if (length[i - 1] == 0.0 || length[i] == 0.0)
+            continue;
+        double angle = std::abs(std::atan2(ax * by - ay * bx, ax * bx + ay * by));     // 0 ... pi
+        if (angle > threshold)
+            corner_weight[i] = (angle - threshold) / (M_PI - threshold);
+    }
+
+    // dwell samples per corner, at most half of the spare samples
+    double dwell_total = 0.0, mean_segment = (double)spare / (double)segments;
+    for (double w: corner_weight)
+        dwell_total += dwell_factor * w * mean_segment;
+    std::size_t dwell_budget = (std::size_t)std::min(dwell_total, (double)(spare / 2));
+    std::vector<std::size_t> dwell, interpolated;
+    allocate_proportional(corner_weight, dwell_budget, dwell);
+    allocate_proportional(length, spare - dwell_budget, interpolated);
+    if (std::all_of(length.begin(), length.end(), [](double l){ return l == 0.0; }))
+    {   // all points on top of each other, spend everything as dwell on the first point
+        interpolated.assign(segments, 0);
+        dwell.assign(n, 0);
+        dwell[0] = spare;
+    }
+
+    trajectory.reserve(samples);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        trajectory.push_back(points[i]);
+        for (std::size_t k = 0; k < dwell[i]; k++)
+            trajectory.push_back(points[i]);
+        if (dwell[i] > 0)
+        {
+            report.corners++;
+            report.dwell_samples += dwell[i];
+        }
+        if (i == segments)
+            break;
+
+        double x0 = points[i].get_x(), y0 = points[i].get_y();
+        double dx = points[i + 1].get_x() - x0, dy = points[i + 1].get_y() - y0;
+        for (std::size_t k = 1; k <= interpolated[i]; k++)
+        {
+            double t = (double)k / (double)(interpolated[i] + 1);
+            trajectory.push_back(PointT(x0 + t * dx, y0 + t * dy));
+        }
+        report.interpolated_samples += interpolated[i];
+    }
+    return report;
+}
+
+#endif
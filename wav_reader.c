@@ -0,0 +1,223 @@
+/*H**********************************************************************
+* FILENAME :        wav_reader.c
+*
+* DESCRIPTION :
+*       Memory mapped WAV header parser, see wav_reader.h. C, compiles as C++ too.
+*
+How to build:
+    gcc -O2 -c wav_reader.c -o wav_reader.o         (or list wav_reader.c in the player compile line)
+
+START DATE : 18 Oct 2026
+
+*H*/
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "wav_reader.h"
+
+#define RIFF_HEADER 12          /* "RIFF"/"RF64", size, "WAVE" */
+#define CHUNK_HEADER 8          /* id, size */
+#define FMT_MIN 16
+#define FMT_EXTENSIBLE_MIN 40
+#define DS64_MIN 24             /* riff size, data size, sample count (64 bit each) */
+#define SMPL_MIN 36
+#define SMPL_LOOP 24
+#define SIZE_FROM_DS64 0xFFFFFFFFu
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+static int parse_fmt(wav_file *wav, const uint8_t *chunk, uint64_t size)
+{
+    if (size < FMT_MIN)
+        return WAV_ERR_FORMAT;
+    wav->format = get16(chunk);
+    wav->channels = get16(chunk + 2);
+    wav->rate = get32(chunk + 4);
+    wav->block_align = get16(chunk + 12);
+    wav->bits_per_sample = get16(chunk + 14);
+    if (wav->format == WAV_FORMAT_EXTENSIBLE)
+    {
+        if (size < FMT_EXTENSIBLE_MIN)
+            return WAV_ERR_FORMAT;
+        /* cbSize, valid bits, channel mask, sub format GUID whose first 2 bytes are the format code */
+        wav->extensible = 1;
+        wav->channel_mask = get32(chunk + 20);
+        wav->format = get16(chunk + 24);
+    }
+    if (wav->channels == 0 || wav->rate == 0 || wav->block_align == 0)
+        return WAV_ERR_FORMAT;
+    return WAV_OK;
+}
+
+static void parse_smpl(wav_file *wav, const uint8_t *chunk, uint64_t size)
+{
+    uint32_t i, count;
+    if (size < SMPL_MIN)
+        return;
+    count = get32(chunk + 28);
+    for (i = 0; i < count && wav->num_loops < WAV_MAX_LOOPS && SMPL_MIN + (uint64_t)(i + 1) * SMPL_LOOP <= size; i++)
+    {
+        const uint8_t *loop = chunk + SMPL_MIN + i * SMPL_LOOP;     /* cue id, type, start, end, fraction, count */
+        wav_loop *dest = &wav->loops[wav->num_loops];
+        dest->type = get32(loop + 4);
+        dest->start = get32(loop + 8);
+        dest->end = get32(loop + 12);
+        dest->play_count = get32(loop + 20);
+        if (dest->start <= dest->end)
+            wav->num_loops++;
+    }
+}
+
+static int parse(wav_file *wav)
+{
+    int err, have_fmt = 0;
+    const uint8_t *p = wav->map, *end = wav->map + wav->map_size;
+    uint64_t size, ds64_data = 0, data_bytes = 0;
+
+    if (wav->map_size < RIFF_HEADER || memcmp(p + 8, "WAVE", 4) != 0)
+        return WAV_ERR_FORMAT;
+    if (memcmp(p, "RF64", 4) == 0)
+        wav->rf64 = 1;
+    else if (memcmp(p, "RIFF", 4) != 0)
+        return WAV_ERR_FORMAT;
+
+    p += RIFF_HEADER;
+    while ((uint64_t)(end - p) >= CHUNK_HEADER)
+    {
+        const uint8_t *chunk = p + CHUNK_HEADER;
+        uint64_t left = (uint64_t)(end - chunk);
+        size = get32(p + 4);
+
+        if (memcmp(p, "data", 4) == 0)
+        {
+            if (!have_fmt)
+                return WAV_ERR_NO_FMT;
+            if (wav->rf64 && size == SIZE_FROM_DS64)
+                size = ds64_data;
+            if (size == 0 || size == SIZE_FROM_DS64 || size > left)
+                size = left;    /* streamed or cut: what the file has */
+            data_bytes = size;
+            wav->data = chunk;
+        }
+        else if (size > left)
+        {
+            if (wav->data)
+                break;          /* a broken chunk after the data, the samples are complete */
+            return WAV_ERR_TRUNCATED;
+        }
+        else if (memcmp(p, "ds64", 4) == 0 && size >= DS64_MIN)
+            ds64_data = get64(chunk + 8);
+        else if (memcmp(p, "fmt ", 4) == 0)
+        {
+            if ((err = parse_fmt(wav, chunk, size)) != WAV_OK)
+                return err;
+            have_fmt = 1;
+        }
+        else if (memcmp(p, "smpl", 4) == 0)
+            parse_smpl(wav, chunk, size);
+
+        /* chunks are padded to an even size */
+        size += size & 1;
+        if (size >= (uint64_t)(end - chunk))
+            break;
+        p = chunk + size;
+    }
+    if (!wav->data)
+        return WAV_ERR_NO_DATA;
+    wav->num_frames = data_bytes / wav->block_align;
+    return WAV_OK;
+}
+
+int wav_open(wav_file *wav, const char *path)
+{
+    int fd, err;
+    struct stat st;
+    void *map;
+
+    memset(wav, 0, sizeof(*wav));
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return WAV_ERR_OPEN;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return WAV_ERR_OPEN;
+    }
+    if (st.st_size < RIFF_HEADER)
+    {
+        close(fd);
+        return WAV_ERR_FORMAT;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  /* the mapping keeps the file */
+    if (map == MAP_FAILED)
+        return errno == EAGAIN ? WAV_ERR_LOCKED : WAV_ERR_OPEN;
+    wav->map = (const uint8_t *)map;
+    wav->map_size = (size_t)st.st_size;
+    /* after mlockall(MCL_FUTURE) every page played would stay locked until wav_close: the file stays pageable */
+    munlock(map, wav->map_size);
+    madvise(map, wav->map_size, MADV_SEQUENTIAL);
+
+    if ((err = parse(wav)) != WAV_OK)
+        wav_close(wav);
+    return err;
+}
+
+void wav_close(wav_file *wav)
+{
+    if (wav->map)
+        munmap((void *)wav->map, wav->map_size);
+    memset(wav, 0, sizeof(*wav));
+}
+
+void wav_prefetch(const wav_file *wav, uint64_t frame, uint64_t num_frames)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t first = (size_t)(wav->data - wav->map) + (size_t)(frame * wav->block_align);
+    size_t last = first + (size_t)(num_frames * wav->block_align);
+
+    if (!wav->map || first >= wav->map_size)
+        return;
+    if (last > wav->map_size)
+        last = wav->map_size;
+    first -= first % page;  /* madvise wants a page aligned start */
+    madvise((void *)(wav->map + first), last - first, MADV_WILLNEED);
+}
+
+const char *wav_strerror(int error)
+{
+    switch (error)
+    {
+    case WAV_OK:
+        return "no error";
+    case WAV_ERR_OPEN:
+        return "file can not be opened";
+    case WAV_ERR_FORMAT:
+        return "not a RIFF/RF64 WAVE file";
+    case WAV_ERR_TRUNCATED:
+        return "file is truncated";
+    case WAV_ERR_NO_FMT:
+        return "no fmt chunk before the data";
+    case WAV_ERR_NO_DATA:
+        return "no data chunk";
+    case WAV_ERR_LOCKED:
+        return "file is larger than the locked memory limit (mlockall MCL_FUTURE, ulimit -l)";
+    default:
+        return "unknown error";
+    }
+}
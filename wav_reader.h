@@ -0,0 +1,102 @@
+/*H**********************************************************************
+* FILENAME :        wav_reader.h
+*
+* DESCRIPTION :
+*       Reads the header of a WAV file so a player configures itself from the file instead of the command line.
+*       The file is memory mapped, the chunks are walked in place: RIFF or RF64 (ds64 sizes above 4 GB), fmt
+*       (PCM, IEEE float and WAVE_FORMAT_EXTENSIBLE with its sub format), data and smpl (sampler loops).
+*       Other chunks are skipped. The samples are not copied, data points into the mapping at the first sample.
+*
+* PUBLIC FUNCTIONS :
+*   int wav_open(wav_file *wav, const char *path)
+*   void wav_close(wav_file *wav)
+*   void wav_prefetch(const wav_file *wav, uint64_t frame, uint64_t num_frames)
+*   const char *wav_strerror(int error)
+*
+How to use:
+    wav_file wav;
+    if (wav_open(&wav, "batman.wav") == WAV_OK && wav.format == WAV_FORMAT_PCM && wav.bits_per_sample == 16)
+        play(wav.data, wav.num_frames, wav.rate, wav.channels);     // interleaved frames of wav.block_align bytes
+    wav_close(&wav);
+
+Note:
+    -- every int returning function gives WAV_OK (0) or a negative WAV_ERR_* code, see wav_strerror
+    -- the length is in frames (data size / block_align), a trailing partial frame is ignored. A data size that
+       is 0 or 0xFFFFFFFF (streamed, never patched) or runs past the end of the file is cut to the file
+    -- smpl loop end is inclusive like in the file, a loop plays start..end and jumps back to start
+    -- wav_prefetch asks the kernel to read frames in the background (MADV_WILLNEED), e.g. the start of the next
+       file of a playlist while the current one plays
+    -- the mapping is unlocked right after mmap: under mlockall(MCL_CURRENT | MCL_FUTURE) a long file or a
+       playlist would otherwise keep every played page locked in RAM. The mmap itself is still counted against
+       RLIMIT_MEMLOCK there, a file above the limit gives WAV_ERR_LOCKED
+    -- little endian files on any host, the fields are assembled byte by byte
+
+How to build: add wav_reader.c to the compile line
+
+START DATE : 18 Oct 2026
+
+*H*/
+#ifndef WAV_READER_H
+#define WAV_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WAV_OK 0
+#define WAV_ERR_OPEN -1         /* file can not be opened or mapped */
+#define WAV_ERR_FORMAT -2       /* not a RIFF/RF64 WAVE file */
+#define WAV_ERR_TRUNCATED -3    /* a chunk runs past the end of the file */
+#define WAV_ERR_NO_FMT -4       /* no fmt chunk before the data chunk */
+#define WAV_ERR_NO_DATA -5      /* no data chunk */
+#define WAV_ERR_LOCKED -6       /* mmap refused (EAGAIN): the mapping would exceed RLIMIT_MEMLOCK under mlockall */
+
+/* fmt format codes (the sub format for WAVE_FORMAT_EXTENSIBLE) */
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_FLOAT 0x0003
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+#define WAV_MAX_LOOPS 8
+
+/* one smpl loop, sample frames */
+typedef struct wav_loop{
+    uint32_t type;                      /* 0 forward, 1 ping-pong, 2 backward */
+    uint32_t start;
+    uint32_t end;                       /* inclusive */
+    uint32_t play_count;                /* 0 = forever */
+} wav_loop;
+
+typedef struct wav_file{
+    /* mapping */
+    const uint8_t *map;
+    size_t map_size;
+    /* fmt */
+    uint16_t format;                    /* WAV_FORMAT_PCM / WAV_FORMAT_FLOAT / other, extensible is resolved */
+    int extensible;                     /* the fmt chunk was WAVE_FORMAT_EXTENSIBLE */
+    unsigned int channels;
+    unsigned int rate;
+    unsigned int bits_per_sample;
+    unsigned int block_align;           /* bytes per frame */
+    uint32_t channel_mask;              /* extensible only, 0 otherwise */
+    int rf64;
+    /* data */
+    const uint8_t *data;                /* first sample */
+    uint64_t num_frames;
+    /* smpl */
+    unsigned int num_loops;
+    wav_loop loops[WAV_MAX_LOOPS];
+} wav_file;
+
+int wav_open(wav_file *wav, const char *path);
+void wav_close(wav_file *wav);
+void wav_prefetch(const wav_file *wav, uint64_t frame, uint64_t num_frames);
+const char *wav_strerror(int error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
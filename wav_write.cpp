@@ -21,6 +21,8 @@ how to call:
 #include <fstream>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
+#include "laser_core.hpp"   // lut, phase accumulator and wav writing shared with svg_to_wav
 //#include <string>
 enum wave_type {rectangle = 0, sine = 1};
 /*
@@ -58,33 +60,6 @@ uint32_t swap32(uint32_t in)  // swaps bytes of 4 byte uint, used for little/big
 }
 */
 
-namespace little_endian_io
-{
-  template <typename Word>  //template used here to make function write_word operate with a generic type: Word
-  std::ostream& write_word( std::ostream& outs, Word value, unsigned size = sizeof( Word ))    // ostrem is output stream object, used for output operation
-  {
-    for (; size; --size)
-    {
-        switch (size)
-        {
-        case 2:
-            value =  static_cast <u_int16_t> (value);
-            break;
-        case 4:
-            value =  static_cast <u_int32_t> (value);
-            break;
-        default:
-            value =  static_cast <u_int32_t> (value);
-            break;
-        }
-        
-        outs.put( static_cast <char> (value & 0xFF) );    // convert to char to to eliminate leading zeros before writing
-        value >>= 8;    // shift one byte
-    }
-    return outs;
-  }
-}
-
 class wav_write
 {
 private:
@@ -110,66 +85,14 @@ void create_sample_buffer(int16_t left_buff[], int16_t right_buff[],
   // const uint16_t Fs = 48000;       // sample rate (Hz)
   // const uint16_t LUT_SIZE = 128;  // lookup table size
   const uint16_t LUT_SIZE = 4096;
-  int16_t lut[LUT_SIZE];      // lookup table
+  std::int16_t lut[LUT_SIZE];      // lookup table
 
-  const float phase_increment = (float)(freq * LUT_SIZE) / (float) Fs;
-  float phase_left = 0.0f;          // phase accumulator for left channel, initially always zero
-  float phase_right = 0.0f;
-
-  switch (signal)
-  {
-    case wave_type::rectangle:
-      // fill table with rectangle wave, first half zero, rest 1
-      for (int i = 0; i < LUT_SIZE; ++i)
-      {
-        if (i < (int)(LUT_SIZE/2))
-          lut[i] = 0;  // first half fill with zero
-        else
-          // std::cout<< "writing1, ival: "<< i << std::endl;
-          lut[i] = 30000;
-      }
-      phase_right = phase_left + (LUT_SIZE/2) ;   // phase accumulator initial for rectangle wave right channel
-      break;
-    
-    case wave_type::sine:
-      // std::cout << "sine wave" << std::endl;
-
-      // fill table with sin vals
-      for (int i = 0; i < LUT_SIZE; ++i)
-      {
-        // convert sin vals between (-1,1) to int_16 by multiplying 0x FF FF (SHRT_MAX)
-        lut[i] = (int16_t)roundf(SHRT_MAX * sinf(2.0f * M_PI * (float)i / (float)LUT_SIZE));       // sinf takes float arg
-      }
-      phase_right = phase_left + (LUT_SIZE/4) ;   // phase accumulator for cosine wave
-      break;
-
-    default:
-      // should never happen, fill with all zeros
-      for (int i = 0; i < LUT_SIZE; ++i)
-        lut[i] = 0;
-      break;
-  }
+  laser_core::render_tables tables = {lut, lut, LUT_SIZE, false};
+  laser_core::phase_state state;    // phase accumulators, left channel initially always zero
+  state.phase_y = laser_core::build_wave_lut(lut, LUT_SIZE, signal == wave_type::sine ? LASER_WAVE_SINE : LASER_WAVE_RECTANGLE);
 
   // generate buffer for left and right channel
-  for (int i = 0; i < buff_size; ++i)
-  {
-    int phase_i = (int)phase_left;        // get integer part of our phase
-    left_buff[i] = lut[phase_i];          // get sample value from LUT
-    phase_left += phase_increment;        // increment phase
-    if (phase_left >= (float)LUT_SIZE)    // handle wraparound
-    {
-      phase_left -= (float)LUT_SIZE;
-    }
-    
-    // write to right buffer, same as before
-    int phase_j = (int)phase_right;
-    right_buff[i] = lut[phase_j];
-    phase_right += phase_increment;
-    if (phase_right >= (float)LUT_SIZE)    // handle wraparound
-    {
-      phase_right -= (float)LUT_SIZE;
-    }
-  }
+  laser_core::render(tables, laser_core::phase_increment(freq, Fs, LUT_SIZE), state, left_buff, right_buff, 1, buff_size);
 }
 
 int main(int argc, char* argv[])
@@ -192,13 +115,6 @@ int main(int argc, char* argv[])
   signal = (signal_name.compare("sine") == 0) ? wave_type::sine : (signal_name.compare("rect") == 0) ? wave_type::rectangle : signal;
   num_samples = seconds * sampling_rate;
 
-  const int BITS_PER_SAMPLE = 16;
-  const int NUM_CHANNELS = 2;
-
-  int block_align = (int)(NUM_CHANNELS * BITS_PER_SAMPLE/8);
-  int subchunk2_size = num_samples * block_align;
-  int byte_rate = sampling_rate * block_align;
-
   std::cout << "freq: " << freq << std::endl;
   std::cout << "sampling_rate: " << sampling_rate << std::endl;
   std::cout << "num_samples: " << num_samples << std::endl;
@@ -211,22 +127,7 @@ int main(int argc, char* argv[])
   // ofstream = stream class to write on files, ios::binary is static constant, ios is under std namespace
   // ios is base class for streams
   std::ofstream file_wav(std::to_string(seconds) + "sec," + std::to_string(freq) + "Hz," + signal_name + ".wav", std::ios::binary); 
-  // Write the file headers
-  file_wav << "RIFF";     // 4bytes, each char is 1 byte
-  little_endian_io::write_word(file_wav, 36 + subchunk2_size, 4);
-  file_wav << "WAVEfmt "; 
-  little_endian_io::write_word(file_wav, 16, 4);  // no extension data, (16=size of rest subchunk for PCM)
-  little_endian_io::write_word(file_wav, 1, 2);  // 1=PCM - integer samples (e.g. linear quantization means no compression)
-  little_endian_io::write_word(file_wav, NUM_CHANNELS, 2 );  // two channels (stereo file)
-  little_endian_io::write_word(file_wav, sampling_rate, 4);  // sampling rate (Hz)
-  little_endian_io::write_word(file_wav, byte_rate, 4);  // 176400=ByteRate (Sample Rate=44100 * BitsPerSample=16 * Channels=2) / 8
-  little_endian_io::write_word(file_wav, block_align, 2);  // data block size=number of bytes for one sample (NumChannels=2 * BitsPerSample=16/8)
-  little_endian_io::write_word(file_wav, BITS_PER_SAMPLE, 2);  // bits per sample=16 (use a multiple of 8)
-
-  // Write the data chunk header
-  size_t data_chunk_pos = file_wav.tellp();
-  file_wav << "data";
-  little_endian_io::write_word(file_wav, subchunk2_size, 4);
+  laser_core::write_wav_header(file_wav, sampling_rate, num_samples);
 
   // Prepare sample data for left and right channels
   wave_type wave;
@@ -239,21 +140,11 @@ int main(int argc, char* argv[])
     wave = wave_type::rectangle; // default
   }
   
-  int16_t left_buff[num_samples];
-  int16_t right_buff[num_samples];
-  create_sample_buffer(left_buff, right_buff, freq, sampling_rate, num_samples, wave);
+  std::vector<int16_t> left_buff(num_samples), right_buff(num_samples);
+  create_sample_buffer(left_buff.data(), right_buff.data(), freq, sampling_rate, num_samples, wave);
 
-  // write samples to wav file
-  for(int i = 0; i < num_samples; ++i)
-  {
-    little_endian_io::write_word(file_wav, left_buff[i], 2); // write sample to left channel
-    little_endian_io::write_word(file_wav, right_buff[i], 2); // write sample to right channel
-
-    std::cout << "i: " << i << std::endl; // left buff vals
-    std::cout << "left buff: " << left_buff[i] << std::endl; // left buff vals
-    std::cout << "right: " << right_buff[i] << std::endl; // left buff vals
-
-  }
+  // write samples to wav file, left buff to left channel and right buff to right channel
+  laser_core::write_pcm(file_wav, left_buff.data(), right_buff.data(), 1, num_samples);
 
   file_wav.close();
 